@@ -311,7 +311,7 @@ void SoldierDiaryPerformanceState::init()
 	{
 		for (std::vector<SoldierCommendations*>::const_iterator i = _soldier->getDiary()->getSoldierCommendations()->begin(); i != _soldier->getDiary()->getSoldierCommendations()->end(); ++i)
 		{
-		RuleCommendations* commendation = _game->getMod()->getCommendation()[(*i)->getType()];
+		RuleCommendations* commendation = _game->getMod()->getCommendation().at((*i)->getType());
 		if ((*i)->getNoun() != "noNoun")
 		{
 			_lstCommendations->addRow(2, tr((*i)->getType()).arg(tr((*i)->getNoun())).c_str(), tr((*i)->getDecorationDescription()).c_str());
@@ -352,7 +352,7 @@ void SoldierDiaryPerformanceState::drawSprites()
 
 	for (std::vector<SoldierCommendations*>::const_iterator i = _list->at(_soldierId)->getDiary()->getSoldierCommendations()->begin() ; i != _list->at(_soldierId)->getDiary()->getSoldierCommendations()->end() ; ++i)
 	{
-		RuleCommendations* commendation = _game->getMod()->getCommendation()[(*i)->getType()];
+		RuleCommendations* commendation = _game->getMod()->getCommendation().at((*i)->getType());
 		// Skip commendations that are not visible in the textlist
 		if ( vectorIterator < scrollDepth || vectorIterator - scrollDepth >= (int)_commendations.size())
 		{
@@ -2032,25 +2032,27 @@ void BattlescapeGame::findItem(BattleAction *action)
  */
 BattleItem *BattlescapeGame::surveyItems(BattleAction *action)
 {
-	std::vector<BattleItem*> droppedItems;
-
-	// first fill a vector with items on the ground that were dropped on the alien turn, and have an attraction value.
-	for (std::vector<BattleItem*>::iterator i = _save->getItems()->begin(); i != _save->getItems()->end(); ++i)
-	{
-		if ((*i)->getSlot() && (*i)->getSlot()->getId() == "STR_GROUND" && (*i)->getTile() && (*i)->getTurnFlag() && (*i)->getRules()->getAttraction())
-		{
-			droppedItems.push_back(*i);
-		}
-	}
-
+	const RuleInventory *ground = getMod()->getInventory("STR_GROUND", true);
+	const Position &origin = action->actor->getPosition();
 	BattleItem *targetItem = 0;
 	int maxWorth = 0;
 
-	// now select the most suitable candidate depending on attractiveness and distance
+	// look for items on the ground that were dropped on the alien turn, and have an attraction value,
+	// then select the most suitable candidate depending on attractiveness and distance
 	// (are we still talking about items?)
-	for (std::vector<BattleItem*>::iterator i = droppedItems.begin(); i != droppedItems.end(); ++i)
+	for (std::vector<BattleItem*>::iterator i = _save->getItems()->begin(); i != _save->getItems()->end(); ++i)
 	{
-		int currentWorth = (*i)->getRules()->getAttraction() / ((_save->getTileEngine()->distance(action->actor->getPosition(), (*i)->getTile()->getPosition()) * 2)+1);
+		if (!(*i)->getTurnFlag() || !(*i)->getTile() || (*i)->getSlot() != ground)
+		{
+			continue;
+		}
+		const int attraction = (*i)->getRules()->getAttraction();
+		// worth can't be bigger than attraction, no need to check distance
+		if (attraction <= maxWorth)
+		{
+			continue;
+		}
+		int currentWorth = attraction / ((_save->getTileEngine()->distance(origin, (*i)->getTile()->getPosition()) * 2)+1);
 		if (currentWorth > maxWorth)
 		{
 			maxWorth = currentWorth;
@@ -2451,8 +2453,9 @@ bool BattlescapeGame::checkForProximityGrenades(BattleUnit *unit)
 		for (int ty = -1; ty < size; ty++)
 		{
 			Tile *t = _save->getTile(unit->getPosition() + Position(tx,ty,0));
-			if (t)
+			if (t && t->hasProximityItems())
 			{
+				t->updateProximityItems();
 				for (std::vector<BattleItem*>::iterator i = t->getInventory()->begin(); i != t->getInventory()->end(); ++i)
 				{
 					if ((*i)->getRules()->getBattleType() == BT_PROXIMITYGRENADE && (*i)->getFuseTimer() >= 0 && RNG::percent((*i)->getRules()->getSpecialChance()))
@@ -42,6 +42,7 @@
 #include "../Engine/Game.h"
 #include "../Engine/Options.h"
 #include "../Engine/LocalizedText.h"
+#include "../Engine/Language.h"
 #include "../Engine/Palette.h"
 #include "../Engine/Surface.h"
 #include "../Engine/SurfaceSet.h"
@@ -500,6 +501,9 @@ BattlescapeState::BattlescapeState() : _reserve(0), _firstInit(true), _isMouseSc
 	_txtDebug->setColor(Palette::blockOffset(8));
 	_txtDebug->setHighContrast(true);
 
+	// script statistics are collected per battle
+	_game->getMod()->getScriptGlobal()->resetProfiles();
+
 	_txtTooltip->setHighContrast(true);
 
 	_btnReserveNone->setGroup(&_reserve);
@@ -1931,6 +1935,25 @@ inline void BattlescapeState::handle(Action *action)
 						_save->getBattleGame()->checkForCasualties(nullptr, nullptr, nullptr, true, false);
 						_save->getBattleGame()->handleState();
 					}
+					// "ctrl-p" - show scripts that used most time
+					else if (action->getDetails()->key.keysym.sym == SDLK_p && (SDL_GetModState() & KMOD_CTRL) != 0)
+					{
+						if (Options::scriptProfiling)
+						{
+							_game->pushState(new InfoboxState(Language::utf8ToWstr(_game->getMod()->getScriptGlobal()->getProfileReport(8))));
+						}
+						else
+						{
+							_game->pushState(new InfoboxState(L"Script profiling is disabled"));
+						}
+					}
+					// "ctrl-h" - check that threaded lighting and FOV match the serial results
+					else if (action->getDetails()->key.keysym.sym == SDLK_h && (SDL_GetModState() & KMOD_CTRL) != 0)
+					{
+						std::wostringstream ss;
+						ss << L"Threaded lighting and FOV differences: " << _save->getTileEngine()->checkParallelResults();
+						_game->pushState(new InfoboxState(ss.str()));
+					}
 					// f11 - voxel map dump
 					else if (action->getDetails()->key.keysym.sym == SDLK_F11)
 					{
@@ -2310,6 +2333,10 @@ void BattlescapeState::finishBattle(bool abort, int inExitArea)
 		_game->popState();
 	}
 	_game->getCursor()->setVisible(true);
+	if (Options::scriptProfiling)
+	{
+		_game->getMod()->getScriptGlobal()->logProfiles();
+	}
 	if (_save->getAmbientSound() != -1)
 	{
 		_game->getMod()->getSoundByDepth(0, _save->getAmbientSound())->stopLoop();
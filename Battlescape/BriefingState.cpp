@@ -168,6 +168,10 @@ void BriefingState::init()
 	else
 	{
 		_game->getMod()->playMusic(_musicId);
+
+		// battle music comes next, read it while the briefing is shown
+		const std::string &battleMusic = _game->getSavedGame()->getSavedBattle()->getMusic();
+		_game->getMod()->prefetchMusic(battleMusic.empty() ? "GMTACTIC" : battleMusic);
 	}
 }
 
@@ -728,6 +728,7 @@ void DebriefingState::init()
 	{
 		_game->getMod()->playMusic(Mod::DEBRIEF_MUSIC_BAD);
 	}
+	_game->getMod()->prefetchMusic("GMGEO");
 }
 
 /**
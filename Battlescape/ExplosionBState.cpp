@@ -208,9 +208,8 @@ void ExplosionBState::init()
 				int Y = RNG::generate(-_power/2,_power/2);
 				Position p = _center;
 				p.x += X; p.y += Y;
-				Explosion *explosion = new Explosion(p, frame, frameDelay, true);
 				// add the explosion on the map
-				_parent->getMap()->getExplosions()->push_back(explosion);
+				_parent->getMap()->getExplosions()->push_back(Explosion(p, frame, frameDelay, true));
 				if (i > 0 && i % counter == 0)
 				{
 					frameDelay++;
@@ -300,8 +299,7 @@ void ExplosionBState::init()
 
 		if (anim != -1)
 		{
-			Explosion *explosion = new Explosion(_center, anim, 0, false, (_hit || psi)); // Don't burn the tile
-			_parent->getMap()->getExplosions()->push_back(explosion);
+			_parent->getMap()->getExplosions()->push_back(Explosion(_center, anim, 0, false, (_hit || psi))); // Don't burn the tile
 		}
 		_parent->getMap()->getCamera()->setViewLevel(_center.z / 24);
 
@@ -326,11 +324,10 @@ void ExplosionBState::think()
 		if (_parent->getMap()->getExplosions()->empty())
 			explode();
 
-		for (std::list<Explosion*>::iterator i = _parent->getMap()->getExplosions()->begin(); i != _parent->getMap()->getExplosions()->end();)
+		for (std::vector<Explosion>::iterator i = _parent->getMap()->getExplosions()->begin(); i != _parent->getMap()->getExplosions()->end();)
 		{
-			if (!(*i)->animate())
+			if (!i->animate())
 			{
-				delete (*i);
 				i = _parent->getMap()->getExplosions()->erase(i);
 				if (_parent->getMap()->getExplosions()->empty())
 				{
@@ -17,6 +17,8 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <fstream>
+#include <algorithm>
+#include <string.h>
 #include "Map.h"
 #include "Camera.h"
 #include "UnitSprite.h"
@@ -68,6 +70,75 @@
 namespace OpenXcom
 {
 
+namespace
+{
+
+/// Starting value of draw keys.
+const Uint32 DRAW_KEY_BASIS = 2166136261u;
+
+/**
+ * Mixes a value into a draw key.
+ * @param key Key so far.
+ * @param value Value to add.
+ * @return New key.
+ */
+inline Uint32 mixKey(Uint32 key, size_t value)
+{
+	key = (key ^ (Uint32)value) * 16777619u;
+	return (key ^ (Uint32)((Uint64)value >> 32)) * 16777619u;
+}
+
+/**
+ * Mixes a position into a draw key.
+ * @param key Key so far.
+ * @param pos Position to add.
+ * @return New key.
+ */
+inline Uint32 mixKey(Uint32 key, const Position &pos)
+{
+	return mixKey(mixKey(mixKey(key, pos.x), pos.y), pos.z);
+}
+
+/**
+ * Divides rounding towards negative infinity, used for
+ * chunks that can be on both sides of the map origin.
+ */
+inline int floorDiv(int a, int b)
+{
+	return a >= 0 ? a / b : -((b - 1 - a) / b);
+}
+
+/**
+ * Copies a rectangle of pixels between two 8bpp surfaces, clipped to both.
+ * @param src Source surface.
+ * @param dest Destination surface.
+ * @param x Left side of the rectangle on the source.
+ * @param y Top side of the rectangle on the source.
+ * @param width Width of the rectangle.
+ * @param height Height of the rectangle.
+ * @param moveX Horizontal distance between the rectangle on the source and the destination.
+ * @param moveY Vertical distance between the rectangle on the source and the destination.
+ */
+void copyPixels(Surface *src, Surface *dest, int x, int y, int width, int height, int moveX, int moveY)
+{
+	const int left = std::max(std::max(x, 0), -moveX);
+	const int top = std::max(std::max(y, 0), -moveY);
+	const int right = std::min(std::min(x + width, src->getWidth()), dest->getWidth() - moveX);
+	const int bottom = std::min(std::min(y + height, src->getHeight()), dest->getHeight() - moveY);
+	if (left >= right || top >= bottom)
+	{
+		return;
+	}
+	SDL_Surface *from = src->getSurface();
+	SDL_Surface *to = dest->getSurface();
+	for (int row = top; row < bottom; ++row)
+	{
+		memcpy((Uint8*)to->pixels + (row + moveY) * to->pitch + left + moveX, (Uint8*)from->pixels + row * from->pitch + left, right - left);
+	}
+}
+
+} // namespace
+
 /**
  * Sets up a map with the specified size and position.
  * @param game Pointer to the core game.
@@ -77,7 +148,7 @@ namespace OpenXcom
  * @param y Y position in pixels.
  * @param visibleMapHeight Current visible map height.
  */
-Map::Map(Game *game, int width, int height, int x, int y, int visibleMapHeight) : InteractiveSurface(width, height, x, y), _game(game), _arrow(0), _selectorX(0), _selectorY(0), _mouseX(0), _mouseY(0), _cursorType(CT_NORMAL), _cursorSize(1), _animFrame(0), _projectile(0), _projectileInFOV(false), _explosionInFOV(false), _launch(false), _visibleMapHeight(visibleMapHeight), _unitDying(false), _smoothingEngaged(false), _flashScreen(false), _bgColor(15)
+Map::Map(Game *game, int width, int height, int x, int y, int visibleMapHeight) : InteractiveSurface(width, height, x, y), _game(game), _arrow(0), _selectorX(0), _selectorY(0), _mouseX(0), _mouseY(0), _cursorType(CT_NORMAL), _cursorSize(1), _animFrame(0), _projectile(0), _projectileInFOV(false), _explosionInFOV(false), _launch(false), _visibleMapHeight(visibleMapHeight), _unitDying(false), _smoothingEngaged(false), _flashScreen(false), _bgColor(15), _shadeFrame(0), _terrainCache(0), _terrainScratch(0), _terrainCacheState(0), _terrainCacheFrame(0), _chunkBeginX(0), _chunkBeginY(0), _chunksX(0), _chunksY(0)
 {
 	_iconHeight = _game->getMod()->getInterface("battlescape")->getElement("icons")->h;
 	_iconWidth = _game->getMod()->getInterface("battlescape")->getElement("icons")->w;
@@ -153,6 +224,8 @@ Map::~Map()
 	delete _message;
 	delete _camera;
 	delete _txtAccuracy;
+	delete _terrainCache;
+	delete _terrainScratch;
 }
 
 /**
@@ -233,10 +306,10 @@ void Map::draw()
 	_explosionInFOV = _save->getDebugMode();
 	if (!_explosions.empty())
 	{
-		for (std::list<Explosion*>::iterator i = _explosions.begin(); i != _explosions.end(); ++i)
+		for (std::vector<Explosion>::const_iterator i = _explosions.begin(); i != _explosions.end(); ++i)
 		{
-			t = _save->getTile(Position((*i)->getPosition().x/16, (*i)->getPosition().y/16, (*i)->getPosition().z/24));
-			if (t && ((*i)->isBig() || t->getVisible()))
+			t = _save->getTile(Position(i->getPosition().x/16, i->getPosition().y/16, i->getPosition().z/24));
+			if (t && (i->isBig() || t->getVisible()))
 			{
 				_explosionInFOV = true;
 				break;
@@ -273,6 +346,54 @@ void Map::setPalette(SDL_Color *colors, int firstcolor, int ncolors)
 	_message->setText(_game->getLanguage()->getString("STR_HIDDEN_MOVEMENT"));
 }
 
+/**
+ * Gets the shade of a tile for the frame being drawn.
+ * The same tile is asked for several times per frame (by itself and
+ * by the neighbours that re-render it), so the shade is only worked
+ * out the first time and then reused until the next frame.
+ * @param tile Tile to shade.
+ * @return Current shade of the tile.
+ */
+int Map::getTileShade(Tile *tile)
+{
+	int index = _save->getTileIndex(tile->getPosition());
+	if (_shadeCacheFrame[index] != _shadeFrame)
+	{
+		_shadeCacheFrame[index] = _shadeFrame;
+		_shadeCache[index] = reShade(tile);
+	}
+	return _shadeCache[index];
+}
+
+/**
+ * Gets the range of tiles in a map column that can end up on the surface.
+ * This is only a conservative bound to skip the bulk of the off-screen
+ * tiles, the exact check is still done for every tile in the range.
+ * @param surface The surface being drawn on.
+ * @param x X coordinate of the column.
+ * @param z Level of the column.
+ * @param beginY First Y coordinate to consider.
+ * @param endY Last Y coordinate to consider.
+ * @param lowY Pointer to the first Y coordinate to draw.
+ * @param highY Pointer to the last Y coordinate to draw.
+ * @param pad Pixels added around the surface.
+ */
+void Map::getVisibleColumn(Surface *surface, int x, int z, int beginY, int endY, int *lowY, int *highY, int pad) const
+{
+	const int halfWidth = _spriteWidth / 2;
+	const int quarterWidth = _spriteWidth / 4;
+	const int levelHeight = z * ((_spriteHeight + _spriteWidth / 4) / 2);
+	const Position offset = _camera->getMapOffset();
+
+	// screen x: (x - y) * halfWidth, screen y: (x + y) * quarterWidth - levelHeight
+	*lowY = std::max(beginY, std::max(
+		x - (surface->getWidth() + _spriteWidth + pad - offset.x) / halfWidth - 1,
+		(levelHeight - _spriteHeight - pad - offset.y) / quarterWidth - x - 1));
+	*highY = std::min(endY, std::min(
+		x + (_spriteWidth + pad + offset.x) / halfWidth + 1,
+		(surface->getHeight() + _spriteHeight + pad + levelHeight - offset.y) / quarterWidth - x + 1));
+}
+
 /**
  * Get shade of wall.
  * @param part For what wall do calculations.
@@ -285,7 +406,7 @@ int Map::getWallShade(MapDataType part, Tile* tileFrot, Tile* tileBehind)
 	int shade;
 	if (tileFrot->isDiscovered(2))
 	{
-		shade = reShade(tileFrot);
+		shade = getTileShade(tileFrot);
 	}
 	else
 	{
@@ -296,15 +417,259 @@ int Map::getWallShade(MapDataType part, Tile* tileFrot, Tile* tileBehind)
 		auto data = tileFrot->getMapData(part);
 		if ((data->isDoor() || data->isUFODoor()) && tileFrot->isDiscovered(part - 1))
 		{
-			shade = std::min(reShade(tileFrot), tileBehind ? tileBehind->getShade() + 5 : 16);
+			shade = std::min(getTileShade(tileFrot), tileBehind ? tileBehind->getShade() + 5 : 16);
 		}
 	}
 	return shade;
 }
 
+/**
+ * Gets a key of how a unit looks, it changes when the unit needs to be drawn again.
+ * Units can be animated by the map frame and by scripts, so the frame is a part of it.
+ * @param unit Unit to check, can be null.
+ * @return Key of the unit.
+ */
+Uint32 Map::getUnitDrawKey(BattleUnit *unit) const
+{
+	if (!unit)
+	{
+		return 0;
+	}
+	Uint32 key = mixKey(DRAW_KEY_BASIS, (size_t)unit);
+	if (!unit->getVisible() && !_save->getDebugMode())
+	{
+		// hidden units are not drawn, no matter what they do
+		return key;
+	}
+	key = mixKey(key, unit->getPosition());
+	key = mixKey(key, unit->getLastPosition());
+	key = mixKey(key, unit->getDestination());
+	key = mixKey(key, unit->getDirection());
+	key = mixKey(key, unit->getTurretDirection());
+	key = mixKey(key, unit->getVerticalDirection());
+	key = mixKey(key, unit->getStatus());
+	key = mixKey(key, unit->getWalkingPhase());
+	key = mixKey(key, unit->getDiagonalWalkingPhase());
+	key = mixKey(key, unit->getFallingPhase());
+	key = mixKey(key, unit->isKneeled());
+	key = mixKey(key, unit->isFloating());
+	key = mixKey(key, unit->getFire());
+	key = mixKey(key, unit->getBreathFrame());
+	key = mixKey(key, (size_t)unit->getArmor());
+	key = mixKey(key, (size_t)unit->getRightHandWeapon());
+	key = mixKey(key, (size_t)unit->getLeftHandWeapon());
+	key = mixKey(key, _animFrame);
+	return key;
+}
+
+/**
+ * Gets a key of everything drawn for a tile, it changes when the tile needs to be drawn again:
+ * sprites and their animation frames, light, discovery, items, units, smoke and path markers.
+ * @param tile Tile to check.
+ * @param tileNorth Tile to the north, it shades the north wall.
+ * @param tileWest Tile to the west, it shades the west wall.
+ * @param tileBelow Tile below, units on stairs there are seen through the floor.
+ * @return Key of the tile.
+ */
+Uint32 Map::getTileDrawKey(Tile *tile, Tile *tileNorth, Tile *tileWest, Tile *tileBelow)
+{
+	Uint32 key = mixKey(DRAW_KEY_BASIS, _save->getTileIndex(tile->getPosition()));
+	for (int part = O_FLOOR; part <= O_OBJECT; ++part)
+	{
+		key = mixKey(key, (size_t)tile->getMapData((MapDataType)part));
+		key = mixKey(key, (size_t)tile->getSprite(part));
+	}
+	key = mixKey(key, tile->isDiscovered(2) ? getTileShade(tile) : 16);
+	key = mixKey(key, tile->isDiscovered(0) | (tile->isDiscovered(1) << 1) | (tile->isDiscovered(2) << 2));
+	if (tile->getSprite(O_WESTWALL))
+	{
+		key = mixKey(key, getWallShade(O_WESTWALL, tile, tileWest));
+	}
+	if (tile->getSprite(O_NORTHWALL))
+	{
+		key = mixKey(key, getWallShade(O_NORTHWALL, tile, tileNorth));
+	}
+	if (tile->getSmoke())
+	{
+		key = mixKey(key, tile->getSmoke());
+		key = mixKey(key, tile->getFire());
+		key = mixKey(key, (_animFrame / 2) % 4 + tile->getAnimationOffset());
+	}
+	key = mixKey(key, tile->getPreview());
+	key = mixKey(key, tile->getMarkerColor());
+
+	BattleItem *item = tile->getTopItem();
+	if (item)
+	{
+		BattleUnit *itemUnit = item->getUnit();
+		key = mixKey(key, (size_t)item);
+		key = mixKey(key, (size_t)item->getRules());
+		if (itemUnit)
+		{
+			key = mixKey(key, itemUnit->getStatus());
+			key = mixKey(key, itemUnit->getFatalWounds());
+		}
+		if (itemUnit || item->getRules()->getRecolorScript())
+		{
+			// corpses and items with scripts can be animated
+			key = mixKey(key, _animFrame);
+		}
+	}
+
+	key = mixKey(key, getUnitDrawKey(tile->getUnit()));
+	if (tileBelow && tile->hasNoFloor(tileBelow))
+	{
+		key = mixKey(key, getUnitDrawKey(tileBelow->getUnit()));
+		key = mixKey(key, tileBelow->isDiscovered(2) ? getTileShade(tileBelow) : -1);
+	}
+	return key;
+}
+
+/**
+ * Gets the chunks of the kept terrain that a tile can draw on.
+ * Besides its own sprites a tile draws units walking by and parts of its neighbours
+ * again, so this covers a few sprites around it.
+ * @param screenPosition Position of the tile on the terrain surface.
+ * @param beginX Pointer to the first chunk column.
+ * @param beginY Pointer to the first chunk row.
+ * @param endX Pointer to the last chunk column.
+ * @param endY Pointer to the last chunk row.
+ * @return True if the tile draws on any chunk on screen.
+ */
+bool Map::getTerrainChunks(const Position &screenPosition, int *beginX, int *beginY, int *endX, int *endY) const
+{
+	const int x = screenPosition.x - _terrainCacheOffset.x;
+	const int y = screenPosition.y - _terrainCacheOffset.y;
+	*beginX = std::max(0, floorDiv(x - 2 * _spriteWidth, TERRAIN_CHUNK) - _chunkBeginX);
+	*endX = std::min(_chunksX - 1, floorDiv(x + 3 * _spriteWidth - 1, TERRAIN_CHUNK) - _chunkBeginX);
+	*beginY = std::max(0, floorDiv(y - 4 * _spriteHeight, TERRAIN_CHUNK) - _chunkBeginY);
+	*endY = std::min(_chunksY - 1, floorDiv(y + 3 * _spriteHeight - 1, TERRAIN_CHUNK) - _chunkBeginY);
+	return *beginX <= *endX && *beginY <= *endY;
+}
+
+/**
+ * Checks if a tile draws on any chunk of the kept terrain that is drawn again this frame.
+ * @param screenPosition Position of the tile on the terrain surface.
+ * @return True if the tile needs to be drawn.
+ */
+bool Map::isTerrainChunkDirty(const Position &screenPosition) const
+{
+	int beginX, beginY, endX, endY;
+	if (getTerrainChunks(screenPosition, &beginX, &beginY, &endX, &endY))
+	{
+		for (int y = beginY; y <= endY; ++y)
+		{
+			for (int x = beginX; x <= endX; ++x)
+			{
+				if (_chunkDirty[y * _chunksX + x])
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * Gets the kept terrain ready for a new frame. It's as big as the map with one chunk on every side,
+ * chunks are fixed to the map, so after scrolling the ones still on screen are moved along and reused.
+ * @param surface The surface the map is drawn on.
+ * @param state Key of everything that changes the look of the whole map.
+ */
+void Map::prepareTerrainCache(Surface *surface, Uint32 state)
+{
+	const int width = surface->getWidth() + 2 * TERRAIN_CHUNK;
+	const int height = surface->getHeight() + 2 * TERRAIN_CHUNK;
+	if (!_terrainCache || _terrainCache->getWidth() != width || _terrainCache->getHeight() != height)
+	{
+		delete _terrainCache;
+		delete _terrainScratch;
+		_terrainCache = new Surface(width, height);
+		_terrainScratch = new Surface(width, height);
+		_chunksX = _chunksY = 0;
+		_chunkKey.clear();
+		_chunkValid.clear();
+	}
+	if (state != _terrainCacheState)
+	{
+		_terrainCacheState = state;
+		std::fill(_chunkValid.begin(), _chunkValid.end(), 0);
+	}
+
+	// chunks that can be seen in the middle of the terrain surface
+	const Position offset = _camera->getMapOffset() + Position(TERRAIN_CHUNK, TERRAIN_CHUNK, 0);
+	const int beginX = floorDiv(TERRAIN_CHUNK - offset.x, TERRAIN_CHUNK);
+	const int beginY = floorDiv(TERRAIN_CHUNK - offset.y, TERRAIN_CHUNK);
+	const int chunksX = floorDiv(TERRAIN_CHUNK + surface->getWidth() - 1 - offset.x, TERRAIN_CHUNK) - beginX + 1;
+	const int chunksY = floorDiv(TERRAIN_CHUNK + surface->getHeight() - 1 - offset.y, TERRAIN_CHUNK) - beginY + 1;
+	if (offset.x != _terrainCacheOffset.x || offset.y != _terrainCacheOffset.y || chunksX != _chunksX || chunksY != _chunksY)
+	{
+		std::vector<Uint32> key(chunksX * chunksY, 0);
+		std::vector<Uint8> valid(chunksX * chunksY, 0);
+		bool reused = false;
+		for (int y = 0; y < chunksY; ++y)
+		{
+			for (int x = 0; x < chunksX; ++x)
+			{
+				const int oldX = beginX + x - _chunkBeginX;
+				const int oldY = beginY + y - _chunkBeginY;
+				if (oldX >= 0 && oldX < _chunksX && oldY >= 0 && oldY < _chunksY && _chunkValid[oldY * _chunksX + oldX])
+				{
+					key[y * chunksX + x] = _chunkKey[oldY * _chunksX + oldX];
+					valid[y * chunksX + x] = 1;
+					reused = true;
+				}
+			}
+		}
+		if (reused)
+		{
+			copyPixels(_terrainCache, _terrainScratch, 0, 0, width, height, offset.x - _terrainCacheOffset.x, offset.y - _terrainCacheOffset.y);
+			std::swap(_terrainCache, _terrainScratch);
+		}
+		_chunkKey.swap(key);
+		_chunkValid.swap(valid);
+		_chunkBeginX = beginX;
+		_chunkBeginY = beginY;
+		_chunksX = chunksX;
+		_chunksY = chunksY;
+	}
+	_terrainCacheOffset = offset;
+	_chunkNewKey.assign(_chunkKey.size(), DRAW_KEY_BASIS);
+	_chunkDirty.assign(_chunkKey.size(), 0);
+}
+
+/**
+ * Copies chunks of the kept terrain between surfaces.
+ * @param src Surface to copy from, the same size as the kept terrain.
+ * @param dest Surface to copy to.
+ * @param x Horizontal position of the kept terrain on the destination.
+ * @param y Vertical position of the kept terrain on the destination.
+ * @param dirtyOnly Only copy chunks that were drawn again.
+ */
+void Map::copyTerrainChunks(Surface *src, Surface *dest, int x, int y, bool dirtyOnly) const
+{
+	for (int chunkY = 0; chunkY < _chunksY; ++chunkY)
+	{
+		for (int chunkX = 0; chunkX < _chunksX; ++chunkX)
+		{
+			if (!dirtyOnly || _chunkDirty[chunkY * _chunksX + chunkX])
+			{
+				const int left = (_chunkBeginX + chunkX) * TERRAIN_CHUNK + _terrainCacheOffset.x;
+				const int top = (_chunkBeginY + chunkY) * TERRAIN_CHUNK + _terrainCacheOffset.y;
+				copyPixels(src, dest, left, top, TERRAIN_CHUNK, TERRAIN_CHUNK, x, y);
+			}
+		}
+	}
+}
+
 /**
  * Draw the terrain.
  * Keep this function as optimised as possible. It's big to minimise overhead of function calls.
+ * Everything that depends on the drawing order of tiles (terrain, items, units, smoke, bullets)
+ * is kept between frames in chunks fixed to the map. Each frame every chunk gets a key of
+ * the tiles that can draw on it; only chunks whose key changed are drawn again, the rest are
+ * copied from the last frame. Path markers, the unit arrow and explosions are drawn on top.
  * @param surface The surface to draw on.
  */
 void Map::drawTerrain(Surface *surface)
@@ -321,8 +686,6 @@ void Map::drawTerrain(Surface *surface)
 	int dummy;
 	BattleUnit *unit = 0;
 	int tileShade, wallShade, tileColor;
-	UnitSprite unitSprite(surface, _game->getMod(), _animFrame, _save->getDepth() != 0);
-	ItemSprite itemSprite(surface, _game->getMod(), _animFrame);
 
 	const int halfAnimFrame = (_animFrame / 2) % 4;
 	const int halfAnimFrameRest = (_animFrame % 2);
@@ -431,17 +794,131 @@ void Map::drawTerrain(Surface *surface)
 		}
 	}
 
-	// get corner map coordinates to give rough boundaries in which tiles to redraw are
-	_camera->convertScreenToMap(0, 0, &beginX, &dummy);
-	_camera->convertScreenToMap(surface->getWidth(), 0, &dummy, &beginY);
-	_camera->convertScreenToMap(surface->getWidth() + _spriteWidth, surface->getHeight() + _spriteHeight, &endX, &dummy);
-	_camera->convertScreenToMap(0, surface->getHeight() + _spriteHeight, &dummy, &endY);
+	// everything up to the path markers is drawn on the kept terrain, with the camera moved to its middle
+	Surface *screen = surface;
+	const Position mapOffset = _camera->getMapOffset();
+	Uint32 cacheState = DRAW_KEY_BASIS;
+	cacheState = mixKey(cacheState, mapOffset.z);
+	cacheState = mixKey(cacheState, _camera->getShowAllLayers());
+	cacheState = mixKey(cacheState, _save->getDebugMode());
+	cacheState = mixKey(cacheState, isAltPressed);
+	cacheState = mixKey(cacheState, _nvColor);
+	cacheState = mixKey(cacheState, _bgColor);
+	cacheState = mixKey(cacheState, _previewSetting);
+	cacheState = mixKey(cacheState, _cursorType);
+	cacheState = mixKey(cacheState, _cursorSize);
+	cacheState = mixKey(cacheState, _save->getBattleState()->getMouseOverIcons());
+	prepareTerrainCache(screen, cacheState);
+	++_terrainCacheFrame;
+	surface = _terrainScratch;
+	_camera->setMapOffset(mapOffset + Position(TERRAIN_CHUNK, TERRAIN_CHUNK, 0));
+	UnitSprite unitSprite(surface, _game->getMod(), _animFrame, _save->getDepth() != 0);
+	ItemSprite itemSprite(surface, _game->getMod(), _animFrame);
+
+	// get corner map coordinates to give rough boundaries in which tiles to redraw are,
+	// the margin covers tiles that draw into chunks from outside of the surface
+	const int pad = 4 * _spriteHeight;
+	_camera->convertScreenToMap(-pad, -pad, &beginX, &dummy);
+	_camera->convertScreenToMap(surface->getWidth() + pad, -pad, &dummy, &beginY);
+	_camera->convertScreenToMap(surface->getWidth() + pad, surface->getHeight() + pad, &endX, &dummy);
+	_camera->convertScreenToMap(-pad, surface->getHeight() + pad, &dummy, &endY);
 	beginY -= (_camera->getViewLevel() * 2);
 	beginX -= (_camera->getViewLevel() * 2);
 	if (beginX < 0)
 		beginX = 0;
 	if (beginY < 0)
 		beginY = 0;
+	// the margin reaches past the map edges, where neighbours looked up by the tiles don't exist
+	endX = std::min(endX, _save->getMapSizeX() - 1);
+	endY = std::min(endY, _save->getMapSizeY() - 1);
+
+	// start a new frame for the tile shade cache
+	size_t mapSize = _save->getMapSizeXYZ();
+	if (_shadeCache.size() != mapSize)
+	{
+		_shadeCache.assign(mapSize, 0);
+		_shadeCacheFrame.assign(mapSize, 0);
+	}
+	++_shadeFrame;
+
+	// tiles that show bullets or thrown items this frame
+	int projectileBeginX = 1, projectileBeginY = 1, projectileEndX = 0, projectileEndY = 0;
+	if (_projectile && _projectileInFOV)
+	{
+		if (_projectile->getItem())
+		{
+			projectileBeginX = _projectile->getPosition().x / 16 - 1;
+			projectileBeginY = _projectile->getPosition().y / 16 - 1;
+			projectileEndX = _projectile->getPosition().x / 16 + 1;
+			projectileEndY = _projectile->getPosition().y / 16 + 1;
+		}
+		else
+		{
+			projectileBeginX = bulletLowX - 1;
+			projectileBeginY = bulletLowY - 1;
+			projectileEndX = bulletHighX + 1;
+			projectileEndY = bulletHighY + 1;
+		}
+	}
+
+	// mix keys of all tiles into the chunks they draw on, to find the chunks that changed since the last frame
+	for (int itZ = beginZ; itZ <= endZ; itZ++)
+	{
+		for (int itX = beginX; itX <= endX; itX++)
+		{
+			int lowY, highY;
+			getVisibleColumn(surface, itX, itZ, beginY, endY, &lowY, &highY, pad);
+			for (int itY = lowY; itY <= highY; itY++)
+			{
+				int chunkBeginX, chunkBeginY, chunkEndX, chunkEndY;
+				mapPosition = Position(itX, itY, itZ);
+				_camera->convertMapToScreen(mapPosition, &screenPosition);
+				screenPosition += _camera->getMapOffset();
+				tile = _save->getTile(mapPosition);
+				if (!tile || !getTerrainChunks(screenPosition, &chunkBeginX, &chunkBeginY, &chunkEndX, &chunkEndY))
+				{
+					continue;
+				}
+
+				Uint32 key = getTileDrawKey(tile, _save->getTile(mapPosition - Position(0,1,0)), _save->getTile(mapPosition - Position(1,0,0)), _save->getTile(mapPosition - Position(0,0,1)));
+				// cursor, bullets, particles and waypoints are not part of the tile and are drawn again every frame
+				if (!tile->getParticleCloud()->empty() ||
+					(_cursorType != CT_NONE && _selectorX > itX - _cursorSize && _selectorY > itY - _cursorSize && _selectorX < itX+1 && _selectorY < itY+1) ||
+					(itX >= projectileBeginX && itX <= projectileEndX && itY >= projectileBeginY && itY <= projectileEndY) ||
+					std::find(_waypoints.begin(), _waypoints.end(), mapPosition) != _waypoints.end())
+				{
+					key = mixKey(key, _terrainCacheFrame);
+				}
+				for (int chunkY = chunkBeginY; chunkY <= chunkEndY; ++chunkY)
+				{
+					for (int chunkX = chunkBeginX; chunkX <= chunkEndX; ++chunkX)
+					{
+						Uint32 &chunkKey = _chunkNewKey[chunkY * _chunksX + chunkX];
+						chunkKey = mixKey(chunkKey, key);
+					}
+				}
+			}
+		}
+	}
+	int dirtyChunks = 0;
+	for (int chunkY = 0; chunkY < _chunksY; ++chunkY)
+	{
+		for (int chunkX = 0; chunkX < _chunksX; ++chunkX)
+		{
+			const int i = chunkY * _chunksX + chunkX;
+			if (!_chunkValid[i] || _chunkKey[i] != _chunkNewKey[i])
+			{
+				_chunkKey[i] = _chunkNewKey[i];
+				_chunkValid[i] = 1;
+				_chunkDirty[i] = 1;
+				++dirtyChunks;
+				surface->drawRect(
+					(_chunkBeginX + chunkX) * TERRAIN_CHUNK + _terrainCacheOffset.x,
+					(_chunkBeginY + chunkY) * TERRAIN_CHUNK + _terrainCacheOffset.y,
+					TERRAIN_CHUNK, TERRAIN_CHUNK, Palette::blockOffset(0) + _bgColor);
+			}
+		}
+	}
 
 	bool pathfinderTurnedOn = _save->getPathfinding()->isPathPreviewed();
 
@@ -453,19 +930,20 @@ void Map::drawTerrain(Surface *surface)
 	}
 
 	surface->lock();
-	for (int itZ = beginZ; itZ <= endZ; itZ++)
+	for (int itZ = beginZ; dirtyChunks && itZ <= endZ; itZ++)
 	{
 		for (int itX = beginX; itX <= endX; itX++)
 		{
-			for (int itY = beginY; itY <= endY; itY++)
+			int lowY, highY;
+			getVisibleColumn(surface, itX, itZ, beginY, endY, &lowY, &highY, pad);
+			for (int itY = lowY; itY <= highY; itY++)
 			{
 				mapPosition = Position(itX, itY, itZ);
 				_camera->convertMapToScreen(mapPosition, &screenPosition);
 				screenPosition += _camera->getMapOffset();
 
-				// only render cells that are inside the surface
-				if (screenPosition.x > -_spriteWidth && screenPosition.x < surface->getWidth() + _spriteWidth &&
-					screenPosition.y > -_spriteHeight && screenPosition.y < surface->getHeight() + _spriteHeight )
+				// only render cells that draw on chunks that changed
+				if (isTerrainChunkDirty(screenPosition))
 				{
 					tile = _save->getTile(mapPosition);
 					Tile *tileNorth = _save->getTile(mapPosition - Position(0,1,0));
@@ -475,7 +953,7 @@ void Map::drawTerrain(Surface *surface)
 
 					if (tile->isDiscovered(2))
 					{
-						tileShade = reShade(tile);
+						tileShade = getTileShade(tile);
 					}
 					else
 					{
@@ -526,7 +1004,7 @@ void Map::drawTerrain(Surface *surface)
 						int tileNorthShade, tileTwoNorthShade, tileWestShade, tileNorthWestShade, tileSouthWestShade;
 						if (tileNorth->isDiscovered(2))
 						{
-							tileNorthShade = reShade(tileNorth);
+							tileNorthShade = getTileShade(tileNorth);
 						}
 						else
 						{
@@ -565,7 +1043,7 @@ void Map::drawTerrain(Surface *surface)
 								Tile *tileTwoNorth = _save->getTile(mapPosition - Position(0,2,0));
 								if (tileTwoNorth->isDiscovered(2))
 								{
-									tileTwoNorthShade = reShade(tileTwoNorth);
+									tileTwoNorthShade = getTileShade(tileTwoNorth);
 								}
 								else
 								{
@@ -586,7 +1064,7 @@ void Map::drawTerrain(Surface *surface)
 								Tile *tileNorthWest = _save->getTile(mapPosition - Position(1,1,0));
 								if (tileNorthWest->isDiscovered(2))
 								{
-									tileNorthWestShade = reShade(tileNorthWest);
+									tileNorthWestShade = getTileShade(tileNorthWest);
 								}
 								else
 								{
@@ -620,7 +1098,7 @@ void Map::drawTerrain(Surface *surface)
 									Tile *tileSouthWest = _save->getTile(mapPosition + Position(-1, 1, 0));
 									if (tileSouthWest->isDiscovered(2))
 									{
-										tileSouthWestShade = reShade(tileSouthWest);
+										tileSouthWestShade = getTileShade(tileSouthWest);
 									}
 									else
 									{
@@ -639,7 +1117,7 @@ void Map::drawTerrain(Surface *surface)
 								BattleUnit *westUnit = tileWest->getUnit();
 								if (tileWest->isDiscovered(2))
 								{
-									tileWestShade = reShade(tileWest);
+									tileWestShade = getTileShade(tileWest);
 								}
 								else
 								{
@@ -981,7 +1459,7 @@ void Map::drawTerrain(Surface *surface)
 								tunit, part,
 								offset.x,
 								offset.y,
-								reShade(ttile)
+								getTileShade(ttile)
 							);
 						}
 					}
@@ -1018,22 +1496,22 @@ void Map::drawTerrain(Surface *surface)
 					}
 
 					//draw particle clouds
-					for (std::list<Particle*>::const_iterator i = tile->getParticleCloud()->begin(); i != tile->getParticleCloud()->end(); ++i)
+					for (std::vector<Particle>::const_iterator i = tile->getParticleCloud()->begin(); i != tile->getParticleCloud()->end(); ++i)
 					{
-						int vaporX = screenPosition.x + (*i)->getX();
-						int vaporY = screenPosition.y + (*i)->getY();
-						if ((int)(_transparencies->size()) >= ((*i)->getColor() + 1) * 1024)
+						int vaporX = screenPosition.x + i->getX();
+						int vaporY = screenPosition.y + i->getY();
+						if ((int)(_transparencies->size()) >= (i->getColor() + 1) * 1024)
 						{
-							switch ((*i)->getSize())
+							switch (i->getSize())
 							{
 							case 3:
-								surface->setPixel(vaporX+1, vaporY+1, (*_transparencies)[((*i)->getColor() * 1024) + ((*i)->getOpacity() * 256) + surface->getPixel(vaporX+1, vaporY+1)]);
+								surface->setPixel(vaporX+1, vaporY+1, (*_transparencies)[(i->getColor() * 1024) + (i->getOpacity() * 256) + surface->getPixel(vaporX+1, vaporY+1)]);
 							case 2:
-								surface->setPixel(vaporX + 1, vaporY, (*_transparencies)[((*i)->getColor() * 1024) + ((*i)->getOpacity() * 256) + surface->getPixel(vaporX + 1, vaporY)]);
+								surface->setPixel(vaporX + 1, vaporY, (*_transparencies)[(i->getColor() * 1024) + (i->getOpacity() * 256) + surface->getPixel(vaporX + 1, vaporY)]);
 							case 1:
-								surface->setPixel(vaporX, vaporY + 1, (*_transparencies)[((*i)->getColor() * 1024) + ((*i)->getOpacity() * 256) + surface->getPixel(vaporX, vaporY + 1)]);
+								surface->setPixel(vaporX, vaporY + 1, (*_transparencies)[(i->getColor() * 1024) + (i->getOpacity() * 256) + surface->getPixel(vaporX, vaporY + 1)]);
 							default:
-								surface->setPixel(vaporX, vaporY, (*_transparencies)[((*i)->getColor() * 1024) + ((*i)->getOpacity() * 256) + surface->getPixel(vaporX, vaporY)]);
+								surface->setPixel(vaporX, vaporY, (*_transparencies)[(i->getColor() * 1024) + (i->getOpacity() * 256) + surface->getPixel(vaporX, vaporY)]);
 								break;
 							}
 						}
@@ -1243,6 +1721,15 @@ void Map::drawTerrain(Surface *surface)
 			}
 		}
 	}
+	surface->unlock();
+
+	// keep the chunks that were drawn again and show the kept terrain
+	copyTerrainChunks(_terrainScratch, _terrainCache, 0, 0, true);
+	_camera->setMapOffset(mapOffset);
+	surface = screen;
+	surface->lock();
+	copyTerrainChunks(_terrainCache, surface, -TERRAIN_CHUNK, -TERRAIN_CHUNK, false);
+
 	if (pathfinderTurnedOn)
 	{
 		if (_numWaypid)
@@ -1253,7 +1740,9 @@ void Map::drawTerrain(Surface *surface)
 		{
 			for (int itX = beginX; itX <= endX; itX++)
 			{
-				for (int itY = beginY; itY <= endY; itY++)
+				int lowY, highY;
+				getVisibleColumn(surface, itX, itZ, beginY, endY, &lowY, &highY);
+				for (int itY = lowY; itY <= highY; itY++)
 				{
 					mapPosition = Position(itX, itY, itZ);
 					_camera->convertMapToScreen(mapPosition, &screenPosition);
@@ -1362,25 +1851,25 @@ void Map::drawTerrain(Surface *surface)
 		}
 		else
 		{
-			for (std::list<Explosion*>::const_iterator i = _explosions.begin(); i != _explosions.end(); ++i)
+			for (std::vector<Explosion>::const_iterator i = _explosions.begin(); i != _explosions.end(); ++i)
 			{
-				_camera->convertVoxelToScreen((*i)->getPosition(), &bulletPositionScreen);
-				if ((*i)->isBig())
+				_camera->convertVoxelToScreen(i->getPosition(), &bulletPositionScreen);
+				if (i->isBig())
 				{
-					if ((*i)->getCurrentFrame() >= 0)
+					if (i->getCurrentFrame() >= 0)
 					{
-						tmpSurface = _game->getMod()->getSurfaceSet("X1.PCK")->getFrame((*i)->getCurrentFrame());
+						tmpSurface = _game->getMod()->getSurfaceSet("X1.PCK")->getFrame(i->getCurrentFrame());
 						tmpSurface->blitNShade(surface, bulletPositionScreen.x - (tmpSurface->getWidth() / 2), bulletPositionScreen.y - (tmpSurface->getHeight() / 2), 0, false, _nvColor);
 					}
 				}
-				else if ((*i)->isHit())
+				else if (i->isHit())
 				{
-					tmpSurface = _game->getMod()->getSurfaceSet("HIT.PCK")->getFrame((*i)->getCurrentFrame());
+					tmpSurface = _game->getMod()->getSurfaceSet("HIT.PCK")->getFrame(i->getCurrentFrame());
 					tmpSurface->blitNShade(surface, bulletPositionScreen.x - 15, bulletPositionScreen.y - 25, 0, false, _nvColor);
 				}
 				else
 				{
-					tmpSurface = _game->getMod()->getSurfaceSet("SMOKE.PCK")->getFrame((*i)->getCurrentFrame());
+					tmpSurface = _game->getMod()->getSurfaceSet("SMOKE.PCK")->getFrame(i->getCurrentFrame());
 					tmpSurface->blitNShade(surface, bulletPositionScreen.x - 15, bulletPositionScreen.y - 15, 0, false, _nvColor);
 				}
 			}
@@ -1749,7 +2238,7 @@ Projectile *Map::getProjectile() const
  * Gets a list of explosion sprites on the map.
  * @return A list of explosion sprites.
  */
-std::list<Explosion*> *Map::getExplosions()
+std::vector<Explosion> *Map::getExplosions()
 {
 	return &_explosions;
 }
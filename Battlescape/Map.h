@@ -20,6 +20,7 @@
 #include "../Engine/InteractiveSurface.h"
 #include "../Engine/Options.h"
 #include "Position.h"
+#include "Explosion.h"
 #include <vector>
 
 namespace OpenXcom
@@ -30,7 +31,6 @@ class Surface;
 class SurfaceSet;
 class BattleUnit;
 class Projectile;
-class Explosion;
 class BattlescapeMessage;
 class Camera;
 class Timer;
@@ -51,6 +51,7 @@ private:
 	static const int NIGHT_VISION_THRESHOLD = 6;
 	static const int NIGHT_VISION_SHADE = 4;
 	static const int BULLET_SPRITES = 35;
+	static const int TERRAIN_CHUNK = 64;
 	Timer *_scrollMouseTimer, *_scrollKeyTimer;
 	Timer *_fadeTimer;
 	int _fadeShade;
@@ -69,7 +70,7 @@ private:
 	int _animFrame;
 	Projectile *_projectile;
 	bool _projectileInFOV;
-	std::list<Explosion *> _explosions;
+	std::vector<Explosion> _explosions;
 	bool _explosionInFOV, _launch;
 	BattlescapeMessage *_message;
 	Camera *_camera;
@@ -83,6 +84,23 @@ private:
 	void drawTerrain(Surface *surface);
 	int getTerrainLevel(Position pos, int size) const;
 	int getWallShade(MapDataType part, Tile* tileFrot, Tile* tileBehind);
+	int getTileShade(Tile *tile);
+	void getVisibleColumn(Surface *surface, int x, int z, int beginY, int endY, int *lowY, int *highY, int pad = 0) const;
+	Uint32 getUnitDrawKey(BattleUnit *unit) const;
+	Uint32 getTileDrawKey(Tile *tile, Tile *tileNorth, Tile *tileWest, Tile *tileBelow);
+	bool getTerrainChunks(const Position &screenPosition, int *beginX, int *beginY, int *endX, int *endY) const;
+	bool isTerrainChunkDirty(const Position &screenPosition) const;
+	void prepareTerrainCache(Surface *surface, Uint32 state);
+	void copyTerrainChunks(Surface *src, Surface *dest, int x, int y, bool dirtyOnly) const;
+	std::vector<int> _shadeCache;
+	std::vector<Uint32> _shadeCacheFrame;
+	Uint32 _shadeFrame;
+	Surface *_terrainCache, *_terrainScratch;
+	Position _terrainCacheOffset;
+	Uint32 _terrainCacheState, _terrainCacheFrame;
+	int _chunkBeginX, _chunkBeginY, _chunksX, _chunksY;
+	std::vector<Uint32> _chunkKey, _chunkNewKey;
+	std::vector<Uint8> _chunkValid, _chunkDirty;
 	int _iconHeight, _iconWidth, _messageColor;
 	const std::vector<Uint8> *_transparencies;
 public:
@@ -125,7 +143,7 @@ public:
 	/// Gets projectile.
 	Projectile *getProjectile() const;
 	/// Gets explosion set.
-	std::list<Explosion*> *getExplosions();
+	std::vector<Explosion> *getExplosions();
 	/// Gets the pointer to the camera.
 	Camera *getCamera();
 	/// Mouse-scrolls the camera.
@@ -605,9 +605,8 @@ void ProjectileFlyBState::think()
 								// insert an explosion and hit
 								if (_projectileImpact != V_OUTOFBOUNDS)
 								{
-									Explosion *explosion = new Explosion(proj->getPosition(1), _ammo->getRules()->getHitAnimation());
 									int power = _ammo->getRules()->getPowerBonus(_unit) - _ammo->getRules()->getPowerRangeReduction(proj->getDistance());
-									_parent->getMap()->getExplosions()->push_back(explosion);
+									_parent->getMap()->getExplosions()->push_back(Explosion(proj->getPosition(1), _ammo->getRules()->getHitAnimation()));
 									_parent->getSave()->getTileEngine()->hit(proj->getPosition(1), power, _ammo->getRules()->getDamageType(), 0, _action.weapon);
 								}
 							}
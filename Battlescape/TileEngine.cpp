@@ -17,8 +17,10 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <assert.h>
+#include <algorithm>
 #include <climits>
 #include <set>
+#include <unordered_set>
 #include "TileEngine.h"
 #include <SDL.h>
 #include "AIModule.h"
@@ -33,6 +35,8 @@
 #include "../Savegame/BattleUnitStatistics.h"
 #include "../Engine/RNG.h"
 #include "../Engine/GraphSubset.h"
+#include "../Engine/ThreadPool.h"
+#include "../Engine/Logger.h"
 #include "BattlescapeState.h"
 #include "../Mod/MapDataSet.h"
 #include "../Mod/MapData.h"
@@ -191,6 +195,47 @@ void iterateTiles(SavedBattleGame* save, GraphSubset gs, TileFunc func)
 	}
 }
 
+/**
+ * Iterate through some subset of map tiles, rows of all levels are split between threads.
+ * Only passes over the whole map (new battle, new turn) are split, updates around
+ * a single event are too small to pay for waking the workers and stay on the calling thread.
+ * `func` can only change the tile it gets and must not depend on order of calls.
+ * @param pool Threads used for the work.
+ * @param save Map data.
+ * @param gs Square subset of map area.
+ * @param func Call back.
+ */
+template<typename TileFunc>
+void iterateTilesParallel(ThreadPool &pool, SavedBattleGame* save, GraphSubset gs, TileFunc func)
+{
+	const auto totalSizeX = save->getMapSizeX();
+	const auto totalSizeY = save->getMapSizeY();
+	const auto totalSizeZ = save->getMapSizeZ();
+
+	gs = GraphSubset::intersection(gs, GraphSubset{ totalSizeX, totalSizeY });
+	if (gs.size_x() != totalSizeX || gs.size_y() != totalSizeY)
+	{
+		iterateTiles(save, gs, func);
+	}
+	else if (gs.size_x() && gs.size_y())
+	{
+		const int rowsPerLevel = gs.size_y();
+		const int rows = rowsPerLevel * totalSizeZ;
+		auto band = [&](int begin, int end)
+		{
+			for (int row = begin; row < end; ++row)
+			{
+				auto curr = save->getTile(Position{ gs.beg_x, gs.beg_y + row % rowsPerLevel, row / rowsPerLevel });
+				for (auto stepX = gs.size_x(); stepX != 0; --stepX, curr += 1)
+				{
+					func(curr);
+				}
+			}
+		};
+		pool.parallelFor(rows, std::max(8, rows / (pool.getThreadCount() * 4)), band);
+	}
+}
+
 /**
  * Generate square subset of map using position and radius.
  * @param position Starting position.
@@ -207,6 +252,42 @@ GraphSubset mapAreaExpand(GraphSubset gs, int radius)
 	return { std::make_pair(gs.beg_x - radius, gs.end_x + radius), std::make_pair(gs.beg_y - radius, gs.end_y + radius) };
 }
 
+/**
+ * Direction of one ray cast by explosion.
+ */
+struct ExplosionRay
+{
+	int te;
+	double sin_te, cos_te, sin_fi, cos_fi;
+};
+
+/**
+ * Gets directions of all rays cast by explosion, trigonometry is calculated only once.
+ * @return List of rays in order they are traced.
+ */
+const std::vector<ExplosionRay>& getExplosionRays()
+{
+	static std::vector<ExplosionRay> rays;
+	if (rays.empty())
+	{
+		for (int fi = -90; fi <= 90; fi += 5)
+		{
+			// raytrace every 3 degrees makes sure we cover all tiles in a circle.
+			for (int te = 0; te <= 360; te += 3)
+			{
+				ExplosionRay ray;
+				ray.te = te;
+				ray.cos_te = cos(te * M_PI / 180.0);
+				ray.sin_te = sin(te * M_PI / 180.0);
+				ray.sin_fi = sin(fi * M_PI / 180.0);
+				ray.cos_fi = cos(fi * M_PI / 180.0);
+				rays.push_back(ray);
+			}
+		}
+	}
+	return rays;
+}
+
 } // namespace
 
 const int TileEngine::heightFromCenter[11] = {0,-2,+2,-4,+4,-6,+6,-8,+8,-12,+12};
@@ -224,9 +305,11 @@ constexpr Position TileEngine::invalid;
 TileEngine::TileEngine(SavedBattleGame *save, std::vector<Uint16> *voxelData, int maxViewDistance, int maxDarknessToSeeUnits) :
 	_save(save), _voxelData(voxelData), _personalLighting(true),
 	_maxViewDistance(maxViewDistance), _maxViewDistanceSq(maxViewDistance * maxViewDistance),
-	_maxVoxelViewDistance(maxViewDistance * 16), _maxDarknessToSeeUnits(maxDarknessToSeeUnits)
+	_maxVoxelViewDistance(maxViewDistance * 16), _maxDarknessToSeeUnits(maxDarknessToSeeUnits),
+	_threads(&ThreadPool::getShared())
 {
 	_blockVisibility.resize(save->getMapSizeXYZ());
+	_explosionDamage.resize(save->getMapSizeXYZ(), -1);
 }
 
 /**
@@ -244,7 +327,8 @@ void TileEngine::calculateSunShading(GraphSubset gs)
 {
 	int power = 15 - _save->getGlobalShade();
 
-	iterateTiles(
+	iterateTilesParallel(
+		*_threads,
 		_save,
 		gs,
 		[&](Tile* tile)
@@ -378,6 +462,7 @@ void TileEngine::calculateUnitLighting(GraphSubset gs)
 
 void TileEngine::calculateLighting(LightLayers layer, Position position, int eventRadius, bool terrianChanged)
 {
+	Uint32 startTime = SDL_GetTicks();
 	auto gsDynamic = GraphSubset{ _save->getMapSizeX(), _save->getMapSizeY() };
 	auto gsStatic = gsDynamic;
 
@@ -389,7 +474,8 @@ void TileEngine::calculateLighting(LightLayers layer, Position position, int eve
 
 	if (terrianChanged)
 	{
-		iterateTiles(
+		iterateTilesParallel(
+			*_threads,
 			_save,
 			mapArea(position, position != invalid ? eventRadius + 1 : 1000),
 			[&](Tile* tile)
@@ -447,31 +533,46 @@ void TileEngine::calculateLighting(LightLayers layer, Position position, int eve
 		);
 	}
 
-	if (layer <= LL_FIRE)
+	if (position == invalid)
 	{
-		iterateTiles(
+		// whole map, light layers can be cleared directly in dense arrays
+		_save->getTileStorage()->resetLight(layer);
+	}
+	else
+	{
+		if (layer <= LL_FIRE)
+		{
+			iterateTilesParallel(
+				*_threads,
+				_save,
+				gsStatic,
+				[&](Tile* tile)
+				{
+					tile->resetLightMulti(layer);
+				}
+			);
+		}
+
+		iterateTilesParallel(
+			*_threads,
 			_save,
-			gsStatic,
+			gsDynamic,
 			[&](Tile* tile)
 			{
-				tile->resetLightMulti(layer);
+				tile->resetLightMulti(std::max(layer, LL_ITEMS));
 			}
 		);
 	}
 
-	iterateTiles(
-		_save,
-		gsDynamic,
-		[&](Tile* tile)
-		{
-			tile->resetLightMulti(std::max(layer, LL_ITEMS));
-		}
-	);
-
 	if (layer <= LL_AMBIENT) calculateSunShading(gsStatic);
 	if (layer <= LL_FIRE) calculateTerrainBackground(gsStatic);
 	if (layer <= LL_ITEMS) calculateTerrainItems(gsDynamic);
 	if (layer <= LL_UNITS) calculateUnitLighting(gsDynamic);
+
+	if (position == invalid)
+	{
+		Log(LOG_DEBUG) << "Relit whole map from layer " << (int)layer << (terrianChanged ? " with terrain" : "") << " in " << (SDL_GetTicks() - startTime) << " ms";
+	}
 }
 
 /**
@@ -782,17 +883,7 @@ bool TileEngine::calculateUnitsInFOV(BattleUnit* unit, const Position eventPos,
 */
 void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos, const int eventRadius)
 {
-	bool useTurretDirection = false;
-	bool skipNarrowArcTest = false;
-	int direction;
-	if (Options::strafe && (unit->getTurretType() > -1)) {
-		direction = unit->getTurretDirection();
-		useTurretDirection = true;
-	}
-	else
-	{
-		direction = unit->getDirection();
-	}
+	bool useTurretDirection = Options::strafe && (unit->getTurretType() > -1);
 	if (unit->getFaction() != FACTION_PLAYER || (eventRadius == 1 && !unit->checkViewSector(eventPos, useTurretDirection)))
 	{
 		//The event wasn't meant for us and/or visible for us.
@@ -804,6 +895,7 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 		return;
 	}
 	Position posSelf = unit->getPosition();
+	bool skipNarrowArcTest = false;
 	if (setupEventVisibilitySector(posSelf, eventPos, eventRadius))
 	{
 		//Asked to do a full check. Or unit within event. Should update all.
@@ -814,9 +906,35 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 	//Only recalculate bresenham lines to tiles that are at the event or further away.
 	const int distanceSqrMin = skipNarrowArcTest ? 0 : std::max(distanceSq(posSelf, eventPos, false) - eventRadius * eventRadius, 0);
 
+	std::vector<Tile*> tiles;
+	traceTilesInFOV(unit, distanceSqrMin, !skipNarrowArcTest, tiles);
+	revealTilesInFOV(unit, tiles);
+}
+
+/**
+* Finds tiles in line of sight of a player controlled soldier.
+* Only reads the terrain, so lines of sight of many units can be traced at the same time.
+* @param unit Unit to check line of sight of.
+* @param distanceSqrMin Tiles closer than this (squared) are skipped.
+* @param narrowArc True to only check tiles in the arc set up by setupEventVisibilitySector.
+* @param tiles Gets every tile along lines of vision, each once, in order they were found.
+*/
+void TileEngine::traceTilesInFOV(BattleUnit *unit, int distanceSqrMin, bool narrowArc, std::vector<Tile*> &tiles)
+{
+	int direction;
+	if (Options::strafe && (unit->getTurretType() > -1)) {
+		direction = unit->getTurretDirection();
+	}
+	else
+	{
+		direction = unit->getDirection();
+	}
+	Position posSelf = unit->getPosition();
+
 	//Variables for finding the tiles to test based on the view direction.
 	Position posTest;
 	std::vector<Position> _trajectory;
+	std::unordered_set<Tile*> found;
 	bool swap = (direction == 0 || direction == 4);
 	const int signX[8] = { +1, +1, +1, +1, -1, -1, -1, -1 };
 	const int signY[8] = { -1, -1, -1, +1, +1, +1, -1, -1 };
@@ -851,7 +969,7 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 				posTest.x = posSelf.x + signX[direction] * (swap ? y : x);
 				posTest.y = posSelf.y + signY[direction] * (swap ? x : y);
 				//Only continue if the column of tiles at (x,y) is within the narrow arc of interest (if enabled)
-				if (inEventVisibilitySector(posTest))
+				if (!narrowArc || inEventVisibilitySector(posTest))
 				{
 					for (int z = 0; z < _save->getMapSizeZ(); z++)
 					{
@@ -877,20 +995,12 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 									//Reveal all tiles along line of vision. Note: needed due to width of bresenham stroke.
 									for (std::vector<Position>::iterator i = _trajectory.begin(); i != _trajectory.end(); ++i)
 									{
-										Position posVisited = (*i);
-										//Add tiles to the visible list only once. BUT we still need to calculate the whole trajectory as
+										//Add tiles to the list only once. BUT we still need to calculate the whole trajectory as
 										// this bresenham line's period might be different from the one that originally revealed the tile.
-										if (!unit->hasVisibleTile(_save->getTile(posVisited)))
+										Tile *tile = _save->getTile(*i);
+										if (found.insert(tile).second)
 										{
-											unit->addToVisibleTiles(_save->getTile(posVisited));
-											_save->getTile(posVisited)->setVisible(+1);
-											_save->getTile(posVisited)->setDiscovered(true, 2);
-
-											// walls to the east or south of a visible tile, we see that too
-											Tile* t = _save->getTile(Position(posVisited.x + 1, posVisited.y, posVisited.z));
-											if (t) t->setDiscovered(true, 0);
-											t = _save->getTile(Position(posVisited.x, posVisited.y + 1, posVisited.z));
-											if (t) t->setDiscovered(true, 1);
+											tiles.push_back(tile);
 										}
 									}
 								}
@@ -903,6 +1013,32 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 	}
 }
 
+/**
+* Marks tiles found by traceTilesInFOV as visible to the soldier and discovered.
+* @param unit Unit that sees the tiles.
+* @param tiles Tiles in line of sight.
+*/
+void TileEngine::revealTilesInFOV(BattleUnit *unit, const std::vector<Tile*> &tiles)
+{
+	for (std::vector<Tile*>::const_iterator i = tiles.begin(); i != tiles.end(); ++i)
+	{
+		Tile *tile = *i;
+		if (!unit->hasVisibleTile(tile))
+		{
+			unit->addToVisibleTiles(tile);
+			tile->setVisible(+1);
+			tile->setDiscovered(true, 2);
+
+			// walls to the east or south of a visible tile, we see that too
+			const Position posVisited = tile->getPosition();
+			Tile* t = _save->getTile(Position(posVisited.x + 1, posVisited.y, posVisited.z));
+			if (t) t->setDiscovered(true, 0);
+			t = _save->getTile(Position(posVisited.x, posVisited.y + 1, posVisited.z));
+			if (t) t->setDiscovered(true, 1);
+		}
+	}
+}
+
 /**
 * Recalculates line of sight of a soldier.
 * @param unit Unit to check line of sight of.
@@ -2151,9 +2287,7 @@ void TileEngine::explode(const Position &center, int power, const RuleDamageType
 	int hitSide = 0;
 	int diagonalWall = 0;
 	int power_;
-	std::map<Tile*, int> tilesAffected;
 	std::vector<BattleItem*> toRemove;
-	std::pair<std::map<Tile*, int>::iterator, bool> ret;
 
 	if (type->FireBlastCalc)
 	{
@@ -2186,151 +2320,180 @@ void TileEngine::explode(const Position &center, int power, const RuleDamageType
 			hitSide = (center.x % 16 + center.y % 16 - 15) > 0 ? 1 : -1;
 	}
 
-	for (int fi = -90; fi <= 90; fi += 5)
+	// blockage between two tiles doesn't change until tiles get detonated,
+	// so rays passing the same tiles can share it
+	_explosionBlockage.clear();
+	auto rayBlockage = [&](Tile *from, Tile *to)
 	{
-		// raytrace every 3 degrees makes sure we cover all tiles in a circle.
-		for (int te = 0; te <= 360; te += 3)
+		const Position diff = to->getPosition() - from->getPosition();
+		if (std::abs(diff.x) > 1 || std::abs(diff.y) > 1 || std::abs(diff.z) > 1)
+		{
+			return verticalBlockage(from, to, type->ResistType, false) * 2 + horizontalBlockage(from, to, type->ResistType, false) * 2;
+		}
+		const int key = _save->getTileIndex(from->getPosition()) * 27 + (diff.z + 1) * 9 + (diff.y + 1) * 3 + (diff.x + 1);
+		std::unordered_map<int, int>::iterator cached = _explosionBlockage.find(key);
+		if (cached == _explosionBlockage.end())
 		{
-			double cos_te = cos(te * M_PI / 180.0);
-			double sin_te = sin(te * M_PI / 180.0);
-			double sin_fi = sin(fi * M_PI / 180.0);
-			double cos_fi = cos(fi * M_PI / 180.0);
-
-			origin = _save->getTile(centetTile);
-			dest = origin;
-			double l = 0;
-			int tileX, tileY, tileZ;
-			power_ = power;
-			while (power_ > 0 && l <= maxRadius)
+			const int block = verticalBlockage(from, to, type->ResistType, false) * 2 + horizontalBlockage(from, to, type->ResistType, false) * 2;
+			cached = _explosionBlockage.insert(std::make_pair(key, block)).first;
+		}
+		return cached->second;
+	};
+
+	const std::vector<ExplosionRay> &rays = getExplosionRays();
+	for (std::vector<ExplosionRay>::const_iterator ray = rays.begin(); ray != rays.end(); ++ray)
+	{
+		const int te = ray->te;
+		const double cos_te = ray->cos_te;
+		const double sin_te = ray->sin_te;
+		const double sin_fi = ray->sin_fi;
+		const double cos_fi = ray->cos_fi;
+
+		origin = _save->getTile(centetTile);
+		dest = origin;
+		double l = 0;
+		int tileX, tileY, tileZ;
+		power_ = power;
+		while (power_ > 0 && l <= maxRadius)
+		{
+			if (power_ > 0)
 			{
-				if (power_ > 0)
+				// check if we had this tile already affected
+				const int index = _save->getTileIndex(dest->getPosition());
+				const bool firstHit = _explosionDamage[index] < 0;
+				if (firstHit)
 				{
-					ret = tilesAffected.insert(std::make_pair(dest, 0)); // check if we had this tile already affected
+					_explosionDamage[index] = 0;
+					_explosionTiles.push_back(index);
+				}
 
-					const int tileDmg = type->getTileDamage(power_);
-					if (tileDmg > ret.first->second)
-					{
-						ret.first->second = tileDmg;
-					}
-					if (ret.second)
-					{
-						const int damage = type->getRandomDamage(power_);
-						BattleUnit *bu = dest->getUnit();
+				const int tileDmg = type->getTileDamage(power_);
+				if (tileDmg > _explosionDamage[index])
+				{
+					_explosionDamage[index] = tileDmg;
+				}
+				if (firstHit)
+				{
+					const int damage = type->getRandomDamage(power_);
+					BattleUnit *bu = dest->getUnit();
 
-						toRemove.clear();
-						if (bu)
+					toRemove.clear();
+					if (bu)
+					{
+						if (distance(dest->getPosition(), centetTile) < 2)
 						{
-							if (distance(dest->getPosition(), centetTile) < 2)
-							{
-								// ground zero effect is in effect
-								hitUnit(unit, clipOrWeapon, bu, Position(0, 0, 0), damage, type, rangeAtack);
-							}
-							else
-							{
-								// directional damage relative to explosion position.
-								// units above the explosion will be hit in the legs, units lateral to or below will be hit in the torso
-								hitUnit(unit, clipOrWeapon, bu, centetTile + Position(0, 0, 5) - dest->getPosition(), damage, type, rangeAtack);
-							}
+							// ground zero effect is in effect
+							hitUnit(unit, clipOrWeapon, bu, Position(0, 0, 0), damage, type, rangeAtack);
+						}
+						else
+						{
+							// directional damage relative to explosion position.
+							// units above the explosion will be hit in the legs, units lateral to or below will be hit in the torso
+							hitUnit(unit, clipOrWeapon, bu, centetTile + Position(0, 0, 5) - dest->getPosition(), damage, type, rangeAtack);
+						}
 
-							// Affect all items and units in inventory
-							const int itemDamage = bu->getOverKillDamage();
-							if (itemDamage > 0)
+						// Affect all items and units in inventory
+						const int itemDamage = bu->getOverKillDamage();
+						if (itemDamage > 0)
+						{
+							for (std::vector<BattleItem*>::iterator it = bu->getInventory()->begin(); it != bu->getInventory()->end(); ++it)
 							{
-								for (std::vector<BattleItem*>::iterator it = bu->getInventory()->begin(); it != bu->getInventory()->end(); ++it)
+								if (!hitUnit(unit, clipOrWeapon, (*it)->getUnit(), Position(0, 0, 0), itemDamage, type, rangeAtack) && type->getItemDamage(itemDamage) > (*it)->getRules()->getArmor())
 								{
-									if (!hitUnit(unit, clipOrWeapon, (*it)->getUnit(), Position(0, 0, 0), itemDamage, type, rangeAtack) && type->getItemDamage(itemDamage) > (*it)->getRules()->getArmor())
-									{
-										toRemove.push_back(*it);
-									}
+									toRemove.push_back(*it);
 								}
 							}
 						}
-						// Affect all items and units on ground
-						for (std::vector<BattleItem*>::iterator it = dest->getInventory()->begin(); it != dest->getInventory()->end(); ++it)
-						{
-							if (!hitUnit(unit, clipOrWeapon, (*it)->getUnit(), Position(0, 0, 0), damage, type) && type->getItemDamage(damage) > (*it)->getRules()->getArmor())
-							{
-								toRemove.push_back(*it);
-							}
-						}
-						for (std::vector<BattleItem*>::iterator it = toRemove.begin(); it != toRemove.end(); ++it)
+					}
+					// Affect all items and units on ground
+					for (std::vector<BattleItem*>::iterator it = dest->getInventory()->begin(); it != dest->getInventory()->end(); ++it)
+					{
+						if (!hitUnit(unit, clipOrWeapon, (*it)->getUnit(), Position(0, 0, 0), damage, type) && type->getItemDamage(damage) > (*it)->getRules()->getArmor())
 						{
-							_save->removeItem((*it));
+							toRemove.push_back(*it);
 						}
-
-						hitTile(dest, damage, type);
 					}
+					for (std::vector<BattleItem*>::iterator it = toRemove.begin(); it != toRemove.end(); ++it)
+					{
+						_save->removeItem((*it));
+					}
+
+					hitTile(dest, damage, type);
 				}
+			}
 
-				l += 1.0;
+			l += 1.0;
 
-				tileX = int(floor(centetTile.x + 0.5 + l * sin_te * cos_fi));
-				tileY = int(floor(centetTile.y + 0.5 + l * cos_te * cos_fi));
-				tileZ = int(floor(centetTile.z + 0.5 + l * sin_fi));
+			tileX = int(floor(centetTile.x + 0.5 + l * sin_te * cos_fi));
+			tileY = int(floor(centetTile.y + 0.5 + l * cos_te * cos_fi));
+			tileZ = int(floor(centetTile.z + 0.5 + l * sin_fi));
 
-				origin = dest;
-				dest = _save->getTile(Position(tileX, tileY, tileZ));
+			origin = dest;
+			dest = _save->getTile(Position(tileX, tileY, tileZ));
 
-				if (!dest) break; // out of map!
+			if (!dest) break; // out of map!
 
-				// blockage by terrain is deducted from the explosion power
-				power_ -= type->RadiusReduction; // explosive damage decreases by 10 per tile
-				if (origin->getPosition().z != tileZ)
-					power_ -= vertdec; //3d explosion factor
+			// blockage by terrain is deducted from the explosion power
+			power_ -= type->RadiusReduction; // explosive damage decreases by 10 per tile
+			if (origin->getPosition().z != tileZ)
+				power_ -= vertdec; //3d explosion factor
 
-				if (type->FireBlastCalc)
+			if (type->FireBlastCalc)
+			{
+				int dir;
+				Pathfinding::vectorToDirection(origin->getPosition() - dest->getPosition(), dir);
+				if (dir != -1 && dir %2) power_ -= 0.5f * type->RadiusReduction; // diagonal movement costs an extra 50% for fire.
+			}
+			if (l > 0.5) {
+				if ( l > 1.5)
 				{
-					int dir;
-					Pathfinding::vectorToDirection(origin->getPosition() - dest->getPosition(), dir);
-					if (dir != -1 && dir %2) power_ -= 0.5f * type->RadiusReduction; // diagonal movement costs an extra 50% for fire.
+					power_ -= rayBlockage(origin, dest);
 				}
-				if (l > 0.5) {
-					if ( l > 1.5)
+				else //tricky bigwall deflection /Volutar
+				{
+					bool skipObject = diagonalWall == 0;
+					if (diagonalWall == Pathfinding::BIGWALLNESW) // --
 					{
-						power_ -= verticalBlockage(origin, dest, type->ResistType, false) * 2;
-						power_ -= horizontalBlockage(origin, dest, type->ResistType, false) * 2;
+						if (hitSide<0 && te >= 135 && te < 315)
+							skipObject = true;
+						if (hitSide>0 && ( te < 135 || te > 315))
+							skipObject = true;
 					}
-					else //tricky bigwall deflection /Volutar
+					if (diagonalWall == Pathfinding::BIGWALLNWSE) // |
 					{
-						bool skipObject = diagonalWall == 0;
-						if (diagonalWall == Pathfinding::BIGWALLNESW) // --
-						{
-							if (hitSide<0 && te >= 135 && te < 315)
-								skipObject = true;
-							if (hitSide>0 && ( te < 135 || te > 315))
-								skipObject = true;
-						}
-						if (diagonalWall == Pathfinding::BIGWALLNWSE) // |
-						{
-							if (hitSide>0 && te >= 45 && te < 225)
-								skipObject = true;
-							if (hitSide<0 && ( te < 45 || te > 225))
-								skipObject = true;
-						}
-						power_ -= verticalBlockage(origin, dest, type->ResistType, skipObject) * 2;
-						power_ -= horizontalBlockage(origin, dest, type->ResistType, skipObject) * 2;
-
+						if (hitSide>0 && te >= 45 && te < 225)
+							skipObject = true;
+						if (hitSide<0 && ( te < 45 || te > 225))
+							skipObject = true;
 					}
+					power_ -= verticalBlockage(origin, dest, type->ResistType, skipObject) * 2;
+					power_ -= horizontalBlockage(origin, dest, type->ResistType, skipObject) * 2;
+
 				}
 			}
 		}
 	}
 
-	// now detonate the tiles affected by explosion
-	if (type->ToTile > 0.0f)
+	// now detonate the tiles affected by explosion, in order of tiles in map
+	std::sort(_explosionTiles.begin(), _explosionTiles.end());
+	for (std::vector<int>::iterator i = _explosionTiles.begin(); i != _explosionTiles.end(); ++i)
 	{
-		for (std::map<Tile*, int>::iterator i = tilesAffected.begin(); i != tilesAffected.end(); ++i)
+		const int damage = _explosionDamage[*i];
+		_explosionDamage[*i] = -1;
+		if (type->ToTile > 0.0f)
 		{
-			if (detonate(i->first, i->second))
+			Tile *tile = _save->getTile(*i);
+			if (detonate(tile, damage))
 			{
 				_save->addDestroyedObjective();
 			}
-			applyGravity(i->first);
-			Tile *j = _save->getTile(i->first->getPosition() + Position(0,0,1));
+			applyGravity(tile);
+			Tile *j = _save->getTile(tile->getPosition() + Position(0,0,1));
 			if (j)
 				applyGravity(j);
 		}
 	}
+	_explosionTiles.clear();
 	calculateLighting(LL_AMBIENT, centetTile, maxRadius + 1, true); // roofs could have been destroyed and fires could have been started
 	calculateFOV(centetTile, maxRadius + 1, true, true);
 	if (unit && distance(centetTile, unit->getPosition()) > maxRadius + 1)
@@ -3925,18 +4088,145 @@ bool TileEngine::validateThrow(BattleAction &action, Position originVoxel, Posit
 	return true;
 }
 
+/**
+ * Traces tiles seen by all soldiers on the map, lines of sight only depend
+ * on the terrain so every soldier can be traced at the same time.
+ * @param tiles Tiles seen by each unit, in order of units in the battle.
+ * @param traced Marks units that were traced.
+ */
+void TileEngine::traceAllTilesInFOV(std::vector<std::vector<Tile*> > &tiles, std::vector<char> &traced)
+{
+	std::vector<BattleUnit*> &units = *_save->getUnits();
+
+	tiles.assign(units.size(), std::vector<Tile*>());
+	traced.assign(units.size(), false);
+	auto trace = [&](int begin, int end)
+	{
+		for (int i = begin; i < end; ++i)
+		{
+			BattleUnit *unit = units[i];
+			if (unit->getTile() != 0 && unit->getFaction() == FACTION_PLAYER && !unit->isOut())
+			{
+				traceTilesInFOV(unit, 0, false, tiles[i]);
+				traced[i] = true;
+			}
+		}
+	};
+	_threads->parallelFor(units.size(), 1, trace);
+}
+
 /**
  * Recalculates FOV of all units in-game.
  */
 void TileEngine::recalculateFOV()
 {
-	for (std::vector<BattleUnit*>::iterator bu = _save->getUnits()->begin(); bu != _save->getUnits()->end(); ++bu)
+	Uint32 startTime = SDL_GetTicks();
+	std::vector<BattleUnit*> &units = *_save->getUnits();
+
+	// lines of sight are traced for all soldiers at the same time,
+	// then everything that changes the battle is done one unit after another in the usual order
+	std::vector<std::vector<Tile*> > tiles;
+	std::vector<char> traced;
+	traceAllTilesInFOV(tiles, traced);
+
+#ifndef NDEBUG
+	// tracing does not change anything, so debug builds can trace again on this thread and expect the same tiles
+	for (size_t i = 0; i < units.size(); ++i)
+	{
+		if (traced[i])
+		{
+			std::vector<Tile*> serial;
+			traceTilesInFOV(units[i], 0, false, serial);
+			if (serial != tiles[i])
+			{
+				Log(LOG_ERROR) << "Parallel FOV mismatch: unit " << units[i]->getId() << " sees " << tiles[i].size() << " tiles, serial path sees " << serial.size();
+			}
+			assert(serial == tiles[i] && "Threaded FOV differs from serial one");
+		}
+	}
+#endif
+
+	for (size_t i = 0; i < units.size(); ++i)
+	{
+		BattleUnit *unit = units[i];
+		if (unit->getTile() == 0)
+		{
+			continue;
+		}
+		if (traced[i] && unit->getFaction() == FACTION_PLAYER && !unit->isOut())
+		{
+			// same as full check in calculateTilesInFOV
+			setupEventVisibilitySector(unit->getPosition(), invalid, 0);
+			unit->clearVisibleTiles();
+			revealTilesInFOV(unit, tiles[i]);
+			calculateUnitsInFOV(unit);
+		}
+		else
+		{
+			calculateFOV(unit);
+		}
+	}
+	Log(LOG_DEBUG) << "Recalculated FOV of " << units.size() << " units in " << (SDL_GetTicks() - startTime) << " ms";
+}
+
+/**
+ * Repeats lighting and lines of sight of the whole map once on worker threads and once
+ * on the calling thread and compares them. Both must be bit-identical, otherwise
+ * a battle would not play the same way from the same seed.
+ * Lighting of the whole map is recalculated, lines of sight are only traced.
+ * @return Number of tiles and units with different results.
+ */
+int TileEngine::checkParallelResults()
+{
+	TileStorage *storage = _save->getTileStorage();
+	int differences = 0;
+
+	calculateLighting(LL_AMBIENT, invalid, 0, true);
+	std::vector<int> light[LL_MAX];
+	for (int layer = 0; layer < LL_MAX; ++layer)
+	{
+		light[layer] = storage->light[layer];
+	}
+	std::vector<VisibilityBlockCache> blocks = _blockVisibility;
+	std::vector<std::vector<Tile*> > tiles;
+	std::vector<char> traced;
+	traceAllTilesInFOV(tiles, traced);
+
+	ThreadPool serial(0);
+	_threads = &serial;
+	calculateLighting(LL_AMBIENT, invalid, 0, true);
+	std::vector<std::vector<Tile*> > serialTiles;
+	std::vector<char> serialTraced;
+	traceAllTilesInFOV(serialTiles, serialTraced);
+	_threads = &ThreadPool::getShared();
+
+	for (size_t i = 0; i < blocks.size(); ++i)
+	{
+		const VisibilityBlockCache &a = blocks[i], &b = _blockVisibility[i];
+		bool same = a.blockDir == b.blockDir && a.blockDirUp == b.blockDirUp && a.blockDirDown == b.blockDirDown &&
+			a.bigWall == b.bigWall && a.height == b.height &&
+			a.blockUp == b.blockUp && a.blockDown == b.blockDown && a.smoke == b.smoke && a.fire == b.fire;
+		for (int layer = 0; layer < LL_MAX; ++layer)
+		{
+			same = same && light[layer][i] == storage->light[layer][i];
+		}
+		if (!same)
+		{
+			++differences;
+		}
+	}
+	for (size_t i = 0; i < tiles.size(); ++i)
 	{
-		if ((*bu)->getTile() != 0)
+		if (traced[i] != serialTraced[i] || tiles[i] != serialTiles[i])
 		{
-			calculateFOV(*bu);
+			++differences;
 		}
 	}
+	if (differences)
+	{
+		Log(LOG_ERROR) << "Threaded lighting or FOV differs from the serial one in " << differences << " places";
+	}
+	return differences;
 }
 
 /**
@@ -18,6 +18,7 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <vector>
+#include <unordered_map>
 #include "Position.h"
 #include "BattlescapeGame.h"
 #include "../Mod/RuleItem.h"
@@ -30,6 +31,7 @@ class SavedBattleGame;
 class BattleUnit;
 class BattleItem;
 class Tile;
+class ThreadPool;
 struct BattleAction;
 struct GraphSubset;
 
@@ -80,6 +82,8 @@ private:
 	SavedBattleGame *_save;
 	std::vector<Uint16> *_voxelData;
 	std::vector<VisibilityBlockCache> _blockVisibility;
+	std::vector<int> _explosionDamage, _explosionTiles;
+	std::unordered_map<int, int> _explosionBlockage;
 	static const int heightFromCenter[11];
 	bool _personalLighting;
 	const int _maxViewDistance;        // 20 tiles by default
@@ -87,6 +91,7 @@ private:
 	const int _maxVoxelViewDistance;   // maxViewDistance * 16
 	const int _maxDarknessToSeeUnits;  // 9 by default
 	Position _eventVisibilitySectorL, _eventVisibilitySectorR, _eventVisibilityObserverPos;
+	ThreadPool *_threads;
 
 	/// Add light source.
 	void addLight(GraphSubset gs, const Position &center, int power, LightLayers layer);
@@ -107,6 +112,12 @@ private:
 
 	bool setupEventVisibilitySector(const Position &observerPos, const Position &eventPos, const int &eventRadius);
 	inline bool inEventVisibilitySector(const Position &toCheck) const;
+	/// Finds tiles in line of sight of a soldier, without changing them.
+	void traceTilesInFOV(BattleUnit *unit, int distanceSqrMin, bool narrowArc, std::vector<Tile*> &tiles);
+	/// Traces tiles seen by all soldiers at the same time.
+	void traceAllTilesInFOV(std::vector<std::vector<Tile*> > &tiles, std::vector<char> &traced);
+	/// Marks tiles in line of sight of a soldier as visible.
+	void revealTilesInFOV(BattleUnit *unit, const std::vector<Tile*> &tiles);
 
 	/// Calculates sun shading of the whole map.
 	void calculateSunShading(GraphSubset gs);
@@ -218,6 +229,8 @@ public:
 	std::pair<int, Position> checkAdjacentDoors(Position pos, int part);
 	/// Recalculates FOV of all units in-game.
 	void recalculateFOV();
+	/// Checks that threaded lighting and FOV match the single threaded results.
+	int checkParallelResults();
 	/// Get direction to a certain point
 	int getDirectionTo(const Position &origin, const Position &target) const;
 	/// Get arc between two direction.
@@ -19,6 +19,10 @@
 #include "AdlibMusic.h"
 #include <fstream>
 #include <algorithm>
+#include <atomic>
+#include <vector>
+#include <string.h>
+#include <SDL_thread.h>
 #include "Exception.h"
 #include "Options.h"
 #include "Logger.h"
@@ -35,6 +39,20 @@ int AdlibMusic::delay = 0;
 int AdlibMusic::rate = 0;
 std::map<int, int> AdlibMusic::delayRates;
 
+namespace
+{
+
+/// Music rendered ahead of playback, written only by render thread and read only by audio callback.
+std::vector<Uint8> ringBuffer;
+/// Total number of bytes read from and written to the ring buffer.
+std::atomic<size_t> ringRead(0), ringWrite(0);
+/// Number of bytes rendered at once.
+size_t renderBlock = 0;
+std::atomic<bool> renderStop(false);
+SDL_Thread *renderThread = 0;
+
+}
+
 /**
  * Initializes a new music track.
  * @param volume Music volume modifier (1.0 = 100%).
@@ -126,32 +144,110 @@ void AdlibMusic::play(int) const
 		stop();
 		func_setup_music((unsigned char*)_data, _size);
 		func_set_music_volume(127 * _volume);
+		startRender();
 		Mix_HookMusic(player, (void*)this);
 	}
 #endif
 }
 
 /**
- * Custom audio player.
- * @param udata User data to send to the player.
- * @param stream Raw audio to output.
- * @param len Length of audio to output.
+ * Starts a thread that renders this track into the ring buffer,
+ * so the audio callback only has to copy finished samples.
+ * If the thread can't be created, the callback renders music itself.
  */
-void AdlibMusic::player(void *udata, Uint8 *stream, int len)
+void AdlibMusic::startRender() const
 {
-#ifndef __NO_MUSIC
-	if (Options::musicVolume == 0)
-		return;
-	if (Options::musicAlwaysLoop && !func_is_music_playing())
+	// music is unhooked at this point, so the buffer can be replaced
+	stopRender();
+
+	// 16-bit stereo, four audio chunks ahead, rendered in halves of chunk
+	renderBlock = Options::audioChunkSize * 2;
+	ringBuffer.assign(renderBlock * 8, 0);
+	ringRead = 0;
+	ringWrite = 0;
+	renderStop = false;
+	renderThread = SDL_CreateThread(renderer, (void*)this);
+	if (!renderThread)
 	{
-		AdlibMusic *music = (AdlibMusic*)udata;
-		music->play();
-		return;
+		Log(LOG_WARNING) << "Failed to start Adlib render thread";
+		ringBuffer.clear();
+	}
+}
+
+/**
+ * Stops the render thread, so the player state can be changed safely.
+ * Music already rendered is dropped, so nothing of the old track
+ * is heard if the player gets hooked again.
+ */
+void AdlibMusic::stopRender()
+{
+	if (renderThread)
+	{
+		renderStop = true;
+		SDL_WaitThread(renderThread, 0);
+		renderThread = 0;
+	}
+	// audio callback can still be running
+	SDL_LockAudio();
+	ringRead = 0;
+	ringWrite = 0;
+	SDL_UnlockAudio();
+}
+
+/**
+ * Render thread, fills the ring buffer whenever the audio callback
+ * has made room for another block.
+ * @param music Pointer to the playing track.
+ * @return Thread exit code.
+ */
+int AdlibMusic::renderer(void *music)
+{
+	const size_t size = ringBuffer.size();
+	// time to play one block, in ms
+	const Uint32 blockTime = std::max(1, (int)(renderBlock * 1000 / 4 / std::max(rate, 1)));
+	while (!renderStop)
+	{
+		const size_t write = ringWrite.load(std::memory_order_relaxed);
+		if (size - (write - ringRead.load(std::memory_order_acquire)) < renderBlock)
+		{
+			SDL_Delay(blockTime / 2 + 1);
+			continue;
+		}
+		loopMusic((const AdlibMusic*)music);
+		// buffer size is a multiple of block size, so blocks never wrap
+		render(&ringBuffer[write % size], renderBlock);
+		ringWrite.store(write + renderBlock, std::memory_order_release);
+	}
+	return 0;
+}
+
+/**
+ * Restarts the track if it has finished and music is set to always loop.
+ * @param music Pointer to the playing track.
+ */
+void AdlibMusic::loopMusic(const AdlibMusic *music)
+{
+	if (Options::musicAlwaysLoop && music && !func_is_music_playing())
+	{
+		func_setup_music((unsigned char*)music->_data, music->_size);
+		func_set_music_volume(127 * music->_volume);
 	}
+}
+
+/**
+ * Synthesizes music with the YM3812 emulator.
+ * @param stream Raw audio to output.
+ * @param len Length of audio to output.
+ */
+void AdlibMusic::render(Uint8 *stream, int len)
+{
 	while (len != 0)
 	{
 		if (!opl[0] || !opl[1])
+		{
+			memset(stream, 0, len);
 			return;
+		}
 		int i = std::min(delay, len);
 		if (i)
 		{
@@ -168,6 +264,51 @@ void AdlibMusic::player(void *udata, Uint8 *stream, int len)
 
 		delay = delayRates[rate];
 	}
+}
+
+/**
+ * Custom audio player.
+ * Copies music from the ring buffer filled by the render thread.
+ * @param udata User data to send to the player.
+ * @param stream Raw audio to output.
+ * @param len Length of audio to output.
+ */
+void AdlibMusic::player(void *udata, Uint8 *stream, int len)
+{
+#ifndef __NO_MUSIC
+	const size_t size = ringBuffer.size();
+	if (Options::musicVolume == 0)
+	{
+		// drop music rendered meanwhile, so it doesn't play late when volume comes back
+		if (size != 0)
+		{
+			ringRead.store(ringWrite.load(std::memory_order_acquire), std::memory_order_release);
+		}
+		return;
+	}
+	if (size == 0)
+	{
+		if (Options::musicAlwaysLoop && !func_is_music_playing())
+		{
+			loopMusic((AdlibMusic*)udata);
+			return;
+		}
+		render(stream, len);
+		return;
+	}
+	size_t read = ringRead.load(std::memory_order_relaxed);
+	// on underrun play whatever is ready, rest of stream stays silent
+	size_t bytes = std::min((size_t)len, ringWrite.load(std::memory_order_acquire) - read);
+	while (bytes != 0)
+	{
+		const size_t pos = read % size;
+		const size_t part = std::min(bytes, size - pos);
+		memcpy(stream, &ringBuffer[pos], part);
+		stream += part;
+		read += part;
+		bytes -= part;
+	}
+	ringRead.store(read, std::memory_order_release);
 #endif
 }
 
@@ -37,6 +37,14 @@ private:
 	float _volume;
 	static int delay, rate;
 	static std::map<int, int> delayRates;
+	/// Synthesizes music into a buffer.
+	static void render(Uint8 *stream, int len);
+	/// Restarts the track if it ended and should loop.
+	static void loopMusic(const AdlibMusic *music);
+	/// Render thread, keeps music rendered ahead of playback.
+	static int renderer(void *music);
+	/// Starts rendering this track ahead of playback.
+	void startRender() const;
 public:
 	/// Creates a blank music track.
 	AdlibMusic(float volume = 1.0f);
@@ -50,6 +58,8 @@ public:
 	void play(int loop = -1) const;
 	/// Adlib music player.
 	static void player(void *udata, Uint8 *stream, int len);
+	/// Stops rendering music ahead of playback.
+	static void stopRender();
 	bool isPlaying();
 };
 
@@ -25,6 +25,7 @@
 #include <sstream>
 #include <string>
 #include <locale>
+#include <chrono>
 #include <stdint.h>
 #include <time.h>
 #include <sys/stat.h>
@@ -718,6 +719,24 @@ time_t getDateModified(const std::string &path)
 	}
 }
 
+/**
+ * Gets the size of a file.
+ * @param path Full path to file.
+ * @return The size in bytes, 0 if the file can't be found.
+ */
+Uint64 getFileSize(const std::string &path)
+{
+	struct stat info;
+	if (stat(path.c_str(), &info) == 0)
+	{
+		return info.st_size;
+	}
+	else
+	{
+		return 0;
+	}
+}
+
 /**
  * Converts a date/time into a human-readable string
  * using the ISO 8601 standard.
@@ -816,6 +835,24 @@ void flashWindow()
 #endif
 }
 
+/**
+ * Gets the number of processors available to the game,
+ * used to decide how much work can be done in parallel.
+ * @return Number of logical processors, at least 1.
+ */
+int getProcessorCount()
+{
+	int count = 1;
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	count = (int)info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+	count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	return count > 0 ? count : 1;
+}
+
 /**
  * Gets the executable path in DOS-style (short) form.
  * For non-Windows systems, just use a dummy path.
@@ -1034,6 +1071,18 @@ std::string now()
 	return result;
 }
 
+/**
+ * Gets the time of a monotonic high resolution clock,
+ * unlike SDL_GetTicks it isn't limited to whole milliseconds.
+ * @return Time in microseconds since some unspecified point.
+ */
+Uint64 getMonotonicTime()
+{
+	typedef std::chrono::steady_clock Clock;
+	static const Clock::time_point start = Clock::now();
+	return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+}
+
 /**
  * Logs the details of this crash and shows an error.
  * @param ex Pointer to exception data (PEXCEPTION_POINTERS on Windows, signal int on Unix)
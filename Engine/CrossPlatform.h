@@ -79,6 +79,8 @@ namespace CrossPlatform
 	bool isQuitShortcut(const SDL_Event &ev);
 	/// Gets the modified date of a file.
 	time_t getDateModified(const std::string &path);
+	/// Gets the size of a file.
+	Uint64 getFileSize(const std::string &path);
 	/// Converts a timestamp to a string.
 	std::pair<std::wstring, std::wstring> timeToString(time_t time);
 	/// Compares two strings by natural order.
@@ -87,6 +89,8 @@ namespace CrossPlatform
 	bool moveFile(const std::string &src, const std::string &dest);
 	/// Flashes the game window.
 	void flashWindow();
+	/// Gets the number of processors.
+	int getProcessorCount();
 	/// Gets the DOS-style executable path.
 	std::string getDosPath();
 	/// Sets the window icon.
@@ -95,6 +99,8 @@ namespace CrossPlatform
 	void stackTrace(void *ctx);
 	/// Produces a quick timestamp.
 	std::string now();
+	/// Gets the time of a monotonic clock.
+	Uint64 getMonotonicTime();
 	/// Produces a crash dump.
 	void crashDump(void *ex, const std::string &err);
 }
@@ -20,8 +20,15 @@
 #include "FileMap.h"
 #include "Logger.h"
 #include "CrossPlatform.h"
-#include <map>
+#include "Exception.h"
+#include "ThreadPool.h"
+#include "../lodepng.h"
+#include <SDL_mutex.h>
+#include <unordered_map>
 #include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <yaml-cpp/yaml.h>
 
 namespace OpenXcom
 {
@@ -29,10 +36,74 @@ namespace FileMap
 {
 
 static std::vector<std::pair<std::string, std::vector<std::string> > > _rulesets;
-static std::map<std::string, std::string> _resources;
-static std::map< std::string, std::set<std::string> > _vdirs;
+static std::unordered_map<std::string, std::string> _resources;
+static std::unordered_map< std::string, std::set<std::string> > _vdirs;
 static std::set<std::string> _emptySet;
 
+/**
+ * Contents of one scanned directory.
+ */
+struct DirListing
+{
+	/// Modification time of directory, changes when files are added or removed.
+	time_t modified;
+	/// Sorted names of all entries.
+	std::vector<std::string> names;
+	/// Index of listing of sub directory for every entry, -1 for files.
+	std::vector<int> children;
+};
+
+/**
+ * Contents of whole directory tree, root directory is first.
+ */
+typedef std::vector<DirListing> TreeListing;
+
+/**
+ * Position of one file in mod archive.
+ */
+struct ArchiveEntry
+{
+	/// Position and size of data in archive.
+	unsigned int offset, size;
+	/// Size of file after inflating its zlib data, 0 if file is stored as is.
+	unsigned int unpacked;
+};
+
+/**
+ * Mod packed in single file. Archive starts with an index of all
+ * files (name, offset, size and unpacked size), followed by contents of files.
+ */
+struct Archive
+{
+	std::ifstream file;
+	/// Guards file position, so files can be read from worker threads.
+	SDL_mutex *lock;
+	time_t modified;
+	std::vector<std::string> names;
+	std::unordered_map<std::string, ArchiveEntry> entries;
+
+	Archive() : lock(SDL_CreateMutex()), modified(0) {}
+	~Archive() { SDL_DestroyMutex(lock); }
+};
+
+/// Header that every mod archive starts with.
+static const char _archiveMagic[8] = { 'O', 'X', 'C', 'P', 'A', 'C', 'K', '2' };
+/// Extension of mod archives.
+static const std::string _archiveExt = "oxpack";
+/// Mounted mod archives, by their path.
+static std::unordered_map<std::string, Archive*> _archives;
+
+/// Directory trees scanned so far, kept across mod list changes.
+static std::unordered_map<std::string, TreeListing> _listings;
+/// Directory trees already checked since last clear().
+static std::set<std::string> _checked;
+/// Header of the file that keeps directory trees between runs.
+static const char _listingsMagic[8] = { 'O', 'X', 'C', 'D', 'I', 'R', 'S', '1' };
+/// Set when a directory tree was scanned again since the listings were last read or written.
+static bool _listingsChanged = false;
+/// Set once the kept listings were read.
+static bool _listingsLoaded = false;
+
 static std::string _canonicalize(const std::string &in)
 {
 	std::string ret = in;
@@ -42,14 +113,14 @@ static std::string _canonicalize(const std::string &in)
 
 const std::string &getFilePath(const std::string &relativeFilePath)
 {
-	std::string canonicalRelativeFilePath = _canonicalize(relativeFilePath);
-	if (_resources.find(canonicalRelativeFilePath) == _resources.end())
+	std::unordered_map<std::string, std::string>::const_iterator i = _resources.find(_canonicalize(relativeFilePath));
+	if (i == _resources.end())
 	{
 		Log(LOG_INFO) << "requested file not found: " << relativeFilePath;
 		return relativeFilePath;
 	}
 
-	return _resources.at(canonicalRelativeFilePath);
+	return i->second;
 }
 
 const std::set<std::string> &getVFolderContents(const std::string &relativePath)
@@ -62,12 +133,13 @@ const std::set<std::string> &getVFolderContents(const std::string &relativePath)
 		canonicalRelativePath.resize(canonicalRelativePath.length() - 1);
 	}
 	
-	if (_vdirs.find(canonicalRelativePath) == _vdirs.end())
+	std::unordered_map< std::string, std::set<std::string> >::const_iterator i = _vdirs.find(canonicalRelativePath);
+	if (i == _vdirs.end())
 	{
 		return _emptySet;
 	}
 
-	return _vdirs.at(canonicalRelativePath);
+	return i->second;
 }
 
 template <typename T>
@@ -107,11 +179,205 @@ static std::string _combinePath(const std::string &prefixPath, const std::string
 	return ret;
 }
 
+static unsigned int _readUint(std::istream &in)
+{
+	unsigned char b[4] = { };
+	in.read((char*)b, sizeof(b));
+	return b[0] | (b[1] << 8) | (b[2] << 16) | ((unsigned int)b[3] << 24);
+}
+
+static void _writeUint(std::ostream &out, unsigned int value)
+{
+	unsigned char b[4] = { (unsigned char)value, (unsigned char)(value >> 8), (unsigned char)(value >> 16), (unsigned char)(value >> 24) };
+	out.write((const char*)b, sizeof(b));
+}
+
+/**
+ * Opens mod archive and reads its index.
+ * Does not touch any global state, so archives can be opened at the same time.
+ * @param path Path to archive.
+ * @return New archive.
+ */
+static Archive *_openArchive(const std::string &path)
+{
+	Archive *archive = new Archive();
+	archive->modified = CrossPlatform::getDateModified(path);
+	archive->file.open(path.c_str(), std::ios::in | std::ios::binary);
+
+	char magic[sizeof(_archiveMagic)] = { };
+	archive->file.read(magic, sizeof(magic));
+	if (!archive->file || !std::equal(magic, magic + sizeof(magic), _archiveMagic))
+	{
+		delete archive;
+		throw Exception(path + " is not a mod archive");
+	}
+	archive->file.seekg(0, std::ios::end);
+	const unsigned int fileSize = (unsigned int)archive->file.tellg();
+	archive->file.seekg(sizeof(_archiveMagic), std::ios::beg);
+
+	const unsigned int count = _readUint(archive->file);
+	for (unsigned int i = 0; i < count && archive->file; ++i)
+	{
+		const unsigned int nameSize = _readUint(archive->file);
+		if (nameSize > fileSize)
+		{
+			break;
+		}
+		std::string name(nameSize, '\0');
+		archive->file.read(&name[0], name.size());
+		ArchiveEntry entry;
+		entry.offset = _readUint(archive->file);
+		entry.size = _readUint(archive->file);
+		entry.unpacked = _readUint(archive->file);
+		if (entry.offset > fileSize || entry.size > fileSize - entry.offset)
+		{
+			break;
+		}
+		archive->names.push_back(name);
+		archive->entries[name] = entry;
+	}
+	if (!archive->file || archive->names.size() != count)
+	{
+		delete archive;
+		throw Exception(path + " has broken index");
+	}
+	return archive;
+}
+
+/**
+ * Creates tree listing from names of files in archive,
+ * in same form as listing of directory on disk.
+ * @param archive Mod archive.
+ * @param tree Listing to append to.
+ */
+static void _listArchive(const Archive &archive, TreeListing &tree)
+{
+	std::unordered_map<std::string, int> dirs;
+	tree.push_back(DirListing());
+	tree.back().modified = archive.modified;
+	dirs[""] = 0;
+	for (std::vector<std::string>::const_iterator i = archive.names.begin(); i != archive.names.end(); ++i)
+	{
+		int parent = 0;
+		size_t begin = 0, end;
+		while ((end = i->find('/', begin)) != std::string::npos)
+		{
+			std::unordered_map<std::string, int>::const_iterator dir = dirs.find(i->substr(0, end));
+			if (dir == dirs.end())
+			{
+				const int index = tree.size();
+				tree.push_back(DirListing());
+				tree[index].modified = archive.modified;
+				tree[parent].names.push_back(i->substr(begin, end - begin));
+				tree[parent].children.push_back(index);
+				dirs[i->substr(0, end)] = index;
+				parent = index;
+			}
+			else
+			{
+				parent = dir->second;
+			}
+			begin = end + 1;
+		}
+		tree[parent].names.push_back(i->substr(begin));
+		tree[parent].children.push_back(-1);
+	}
+	// same order as directory listing
+	for (TreeListing::iterator i = tree.begin(); i != tree.end(); ++i)
+	{
+		std::vector<std::pair<std::string, int> > entries;
+		for (size_t j = 0; j < i->names.size(); ++j)
+		{
+			entries.push_back(std::make_pair(i->names[j], i->children[j]));
+		}
+		std::sort(entries.begin(), entries.end());
+		for (size_t j = 0; j < entries.size(); ++j)
+		{
+			i->names[j] = entries[j].first;
+			i->children[j] = entries[j].second;
+		}
+	}
+}
+
+/**
+ * Finds mounted archive that contains file.
+ * @param fullPath Path to file, archive path followed by path of file in archive.
+ * @param name Set to path of file in archive.
+ * @return Archive or null if file is not in any of them.
+ */
+static Archive *_findArchive(const std::string &fullPath, std::string &name)
+{
+	for (std::unordered_map<std::string, Archive*>::const_iterator i = _archives.begin(); i != _archives.end(); ++i)
+	{
+		const std::string &path = i->first;
+		if (fullPath.size() > path.size() && fullPath[path.size()] == '/' && fullPath.compare(0, path.size(), path) == 0)
+		{
+			name = fullPath.substr(path.size() + 1);
+			return i->second;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Reads directory and all its sub directories into the tree listing.
+ * Does not touch any global state, so trees can be scanned at the same time.
+ * @param fullDir Path to directory.
+ * @param tree Listing to append to.
+ */
+static void _scanDir(const std::string &fullDir, TreeListing &tree)
+{
+	const size_t index = tree.size();
+	tree.push_back(DirListing());
+	tree[index].modified = CrossPlatform::getDateModified(fullDir);
+
+	std::vector<std::string> files = CrossPlatform::getFolderContents(fullDir);
+	std::vector<int> children(files.size(), -1);
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		std::string fullpath = fullDir + "/" + files[i];
+		if (CrossPlatform::folderExists(fullpath))
+		{
+			children[i] = tree.size();
+			_scanDir(fullpath, tree);
+		}
+	}
+	tree[index].names.swap(files);
+	tree[index].children.swap(children);
+}
+
+/**
+ * Checks if cached listing still matches the directory tree.
+ * Only directories are checked, their modification time changes
+ * when any entry is added, removed or renamed.
+ * @param fullDir Path to directory.
+ * @param tree Cached listing.
+ * @param index Listing of `fullDir` in the tree.
+ * @return True if listing can be used.
+ */
+static bool _validListing(const std::string &fullDir, const TreeListing &tree, int index)
+{
+	const DirListing &dir = tree[index];
+	if (dir.modified == 0 || dir.modified != CrossPlatform::getDateModified(fullDir))
+	{
+		return false;
+	}
+	for (size_t i = 0; i < dir.names.size(); ++i)
+	{
+		if (dir.children[i] != -1 && !_validListing(fullDir + "/" + dir.names[i], tree, dir.children[i]))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 static void _mapFiles(const std::string &modId, const std::string &basePath,
-		      const std::string &relPath, bool ignoreMods)
+		      const std::string &relPath, bool ignoreMods, const TreeListing &tree, int index)
 {
 	std::string fullDir = basePath + (relPath.length() ? "/" + relPath : "");
-	std::vector<std::string> files = CrossPlatform::getFolderContents(fullDir);
+	const std::vector<std::string> &files = tree[index].names;
+	const std::vector<int> &children = tree[index].children;
 	std::set<std::string> rulesetFiles = _filterFiles(files, "rul");
 
 	if (!ignoreMods && rulesetFiles.size())
@@ -125,31 +391,32 @@ static void _mapFiles(const std::string &modId, const std::string &basePath,
 		}
 	}
 
-	for (std::vector<std::string>::iterator i = files.begin(); i != files.end(); ++i)
+	for (size_t i = 0; i < files.size(); ++i)
 	{
-		std::string fullpath = fullDir + "/" + *i;
+		const std::string &file = files[i];
+		std::string fullpath = fullDir + "/" + file;
 		
-		if (_canonicalize(*i) == "metadata.yml" || rulesetFiles.find(*i) != rulesetFiles.end())
+		if (_canonicalize(file) == "metadata.yml" || rulesetFiles.find(file) != rulesetFiles.end())
 		{
 			// no need to map mod metadata files or ruleset files
 			Log(LOG_VERBOSE) << "  ignoring non-resource file: " << fullpath;
 			continue;
 		}
 
-		if (CrossPlatform::folderExists(fullpath))
+		if (children[i] != -1)
 		{
 			Log(LOG_VERBOSE) << "  recursing into: " << fullpath;
 			// allow old mod directory format -- if the top-level subdir
 			// is named "Mod" and no top-level ruleset files were found,
 			// record ruleset files in that subdirectory, otherwise ignore them
 			bool ignoreModsRecurse = ignoreMods ||
-				!rulesetFiles.empty() || !relPath.empty() || _canonicalize(*i) != "ruleset";
-			_mapFiles(modId, basePath, _combinePath(relPath, *i), ignoreModsRecurse);
+				!rulesetFiles.empty() || !relPath.empty() || _canonicalize(file) != "ruleset";
+			_mapFiles(modId, basePath, _combinePath(relPath, file), ignoreModsRecurse, tree, children[i]);
 			continue;
 		}
 
 		// populate resource map
-		std::string canonicalRelativeFilePath = _canonicalize(_combinePath(relPath, *i));
+		std::string canonicalRelativeFilePath = _canonicalize(_combinePath(relPath, file));
 		if (_resources.insert(std::pair<std::string, std::string>(canonicalRelativeFilePath, fullpath)).second)
 		{
 			Log(LOG_VERBOSE) << "  mapped resource: " << canonicalRelativeFilePath << " -> " << fullpath;
@@ -161,12 +428,8 @@ static void _mapFiles(const std::string &modId, const std::string &basePath,
 
 		// populate vdir map
 		std::string canonicalRelativePath = _canonicalize(relPath);
-		std::string canonicalFile = _canonicalize(*i);
-		if (_vdirs.find(canonicalRelativePath) == _vdirs.end())
-		{
-			_vdirs.insert(std::pair< std::string, std::set<std::string> >(canonicalRelativePath, std::set<std::string>()));
-		}
-		if (_vdirs.at(canonicalRelativePath).insert(canonicalFile).second)
+		std::string canonicalFile = _canonicalize(file);
+		if (_vdirs[canonicalRelativePath].insert(canonicalFile).second)
 		{
 			Log(LOG_VERBOSE) << "  mapped file to virtual directory: " << canonicalRelativePath << " -> " << canonicalFile;
 		}
@@ -178,12 +441,251 @@ void clear()
 	_rulesets.clear();
 	_resources.clear();
 	_vdirs.clear();
+	_checked.clear();
+}
+
+void scan(const std::vector<std::string> &paths)
+{
+	std::vector<std::string> todo;
+	for (std::vector<std::string>::const_iterator i = paths.begin(); i != paths.end(); ++i)
+	{
+		if (!_checked.insert(*i).second)
+		{
+			continue;
+		}
+		std::unordered_map<std::string, TreeListing>::const_iterator cached = _listings.find(*i);
+		if (cached == _listings.end())
+		{
+			todo.push_back(*i);
+		}
+		else if (_archives.find(*i) != _archives.end() ? cached->second[0].modified != CrossPlatform::getDateModified(*i) : !_validListing(*i, cached->second, 0))
+		{
+			todo.push_back(*i);
+		}
+	}
+	if (todo.empty())
+	{
+		return;
+	}
+
+	std::vector<TreeListing> trees(todo.size());
+	std::vector<Archive*> archives(todo.size());
+	std::vector<std::string> errors(todo.size());
+	auto scanTrees = [&](int begin, int end)
+	{
+		for (int i = begin; i < end; ++i)
+		{
+			try
+			{
+				if (isArchive(todo[i]))
+				{
+					archives[i] = _openArchive(todo[i]);
+					_listArchive(*archives[i], trees[i]);
+				}
+				else
+				{
+					_scanDir(todo[i], trees[i]);
+				}
+			}
+			catch (Exception &e)
+			{
+				errors[i] = e.what();
+			}
+		}
+	};
+	ThreadPool::getShared().parallelFor(todo.size(), 1, scanTrees);
+
+	std::string error;
+	for (size_t i = 0; i < todo.size(); ++i)
+	{
+		if (!errors[i].empty())
+		{
+			_listings.erase(todo[i]);
+			_checked.erase(todo[i]);
+			if (isArchive(todo[i]))
+			{
+				// a broken mod archive only disables that mod, it is not worth aborting the game
+				Log(LOG_ERROR) << "skipping broken mod archive: " << errors[i];
+				std::unordered_map<std::string, Archive*>::iterator mounted = _archives.find(todo[i]);
+				if (mounted != _archives.end())
+				{
+					delete mounted->second;
+					_archives.erase(mounted);
+				}
+			}
+			else if (error.empty())
+			{
+				error = errors[i];
+			}
+			continue;
+		}
+		Log(LOG_VERBOSE) << "  scanned " << trees[i].size() << " directories in: " << todo[i];
+		_listings[todo[i]].swap(trees[i]);
+		_listingsChanged = _listingsChanged || !archives[i];
+		if (archives[i])
+		{
+			Archive *&mounted = _archives[todo[i]];
+			delete mounted;
+			mounted = archives[i];
+		}
+	}
+	if (!error.empty())
+	{
+		throw Exception(error);
+	}
 }
 
 void load(const std::string &modId, const std::string &path, bool ignoreMods)
 {
 	Log(LOG_VERBOSE) << "  mapping resources in: " << path;
-	_mapFiles(modId, path, "", ignoreMods);
+	scan(std::vector<std::string>(1, path));
+	std::unordered_map<std::string, TreeListing>::const_iterator listing = _listings.find(path);
+	if (listing == _listings.end())
+	{
+		// broken mod archive, already reported by scan()
+		return;
+	}
+	_mapFiles(modId, path, "", ignoreMods, listing->second, 0);
+}
+
+void loadListings(const std::string &filename)
+{
+	if (_listingsLoaded)
+	{
+		return;
+	}
+	_listingsLoaded = true;
+	std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+	if (!file)
+	{
+		return;
+	}
+	file.seekg(0, std::ios::end);
+	const unsigned int fileSize = (unsigned int)file.tellg();
+	file.seekg(0, std::ios::beg);
+
+	char magic[sizeof(_listingsMagic)] = { };
+	file.read(magic, sizeof(magic));
+	if (!file || !std::equal(magic, magic + sizeof(magic), _listingsMagic))
+	{
+		Log(LOG_WARNING) << "ignoring unknown directory listings: " << filename;
+		return;
+	}
+
+	// every count is checked against the file size, so a broken file can't ask for huge amounts of memory,
+	// and sub directories must come after their parent, so a broken tree can't loop
+	auto readString = [&](std::string &str)
+	{
+		const unsigned int size = _readUint(file);
+		if (!file || size > fileSize)
+		{
+			return false;
+		}
+		str.assign(size, '\0');
+		file.read(&str[0], size);
+		return (bool)file;
+	};
+	std::unordered_map<std::string, TreeListing> listings;
+	const unsigned int count = _readUint(file);
+	bool valid = (bool)file && count <= fileSize;
+	for (unsigned int i = 0; i < count && valid; ++i)
+	{
+		std::string path;
+		valid = readString(path);
+		const unsigned int dirs = _readUint(file);
+		valid = valid && file && dirs > 0 && dirs <= fileSize;
+		TreeListing tree(valid ? dirs : 0);
+		for (unsigned int j = 0; j < tree.size() && valid; ++j)
+		{
+			DirListing &dir = tree[j];
+			const unsigned int low = _readUint(file);
+			const unsigned int high = _readUint(file);
+			dir.modified = (time_t)(((Uint64)high << 32) | low);
+			const unsigned int entries = _readUint(file);
+			valid = file && entries <= fileSize;
+			for (unsigned int k = 0; k < entries && valid; ++k)
+			{
+				std::string name;
+				valid = readString(name);
+				const int child = (int)_readUint(file);
+				valid = valid && file && (child == -1 || (child > (int)j && child < (int)tree.size()));
+				dir.names.push_back(name);
+				dir.children.push_back(child);
+			}
+		}
+		if (valid)
+		{
+			listings[path].swap(tree);
+		}
+	}
+	if (!valid)
+	{
+		Log(LOG_WARNING) << "ignoring broken directory listings: " << filename;
+		return;
+	}
+	for (std::unordered_map<std::string, TreeListing>::iterator i = listings.begin(); i != listings.end(); ++i)
+	{
+		// trees scanned in this run are newer
+		if (_listings.find(i->first) == _listings.end())
+		{
+			_listings[i->first].swap(i->second);
+		}
+	}
+	Log(LOG_VERBOSE) << "read " << listings.size() << " directory listings from: " << filename;
+}
+
+void saveListings(const std::string &filename)
+{
+	if (!_listingsChanged)
+	{
+		return;
+	}
+	std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		Log(LOG_WARNING) << "Failed to save directory listings: " << filename;
+		return;
+	}
+
+	// archives are listed from their own index, and trees of removed mods are dropped
+	std::vector<std::unordered_map<std::string, TreeListing>::const_iterator> kept;
+	for (std::unordered_map<std::string, TreeListing>::const_iterator i = _listings.begin(); i != _listings.end(); ++i)
+	{
+		if (_archives.find(i->first) == _archives.end() && CrossPlatform::folderExists(i->first))
+		{
+			kept.push_back(i);
+		}
+	}
+
+	file.write(_listingsMagic, sizeof(_listingsMagic));
+	_writeUint(file, kept.size());
+	for (size_t i = 0; i < kept.size(); ++i)
+	{
+		const TreeListing &tree = kept[i]->second;
+		_writeUint(file, kept[i]->first.size());
+		file.write(kept[i]->first.data(), kept[i]->first.size());
+		_writeUint(file, tree.size());
+		for (TreeListing::const_iterator dir = tree.begin(); dir != tree.end(); ++dir)
+		{
+			_writeUint(file, (unsigned int)((Uint64)dir->modified & 0xFFFFFFFF));
+			_writeUint(file, (unsigned int)((Uint64)dir->modified >> 32));
+			_writeUint(file, dir->names.size());
+			for (size_t j = 0; j < dir->names.size(); ++j)
+			{
+				_writeUint(file, dir->names[j].size());
+				file.write(dir->names[j].data(), dir->names[j].size());
+				_writeUint(file, (unsigned int)dir->children[j]);
+			}
+		}
+	}
+	if (file)
+	{
+		_listingsChanged = false;
+	}
+	else
+	{
+		Log(LOG_WARNING) << "Failed to save directory listings: " << filename;
+	}
 }
 
 bool isResourcesEmpty(void)
@@ -191,6 +693,200 @@ bool isResourcesEmpty(void)
 	return _resources.empty();
 }
 
+bool isArchive(const std::string &path)
+{
+	return _filterFiles(std::vector<std::string>(1, path), _archiveExt).size() == 1 && CrossPlatform::fileExists(path);
+}
+
+bool isMounted(const std::string &path)
+{
+	return _archives.find(path) != _archives.end();
+}
+
+bool isInArchive(const std::string &fullPath)
+{
+	std::string name;
+	return _findArchive(fullPath, name) != 0;
+}
+
+bool fileExists(const std::string &fullPath)
+{
+	std::string name;
+	Archive *archive = _findArchive(fullPath, name);
+	if (archive)
+	{
+		return archive->entries.find(name) != archive->entries.end();
+	}
+	return CrossPlatform::fileExists(fullPath);
+}
+
+bool readFile(const std::string &fullPath, std::string &data)
+{
+	std::string name;
+	Archive *archive = _findArchive(fullPath, name);
+	if (archive)
+	{
+		std::unordered_map<std::string, ArchiveEntry>::const_iterator entry = archive->entries.find(name);
+		if (entry == archive->entries.end())
+		{
+			return false;
+		}
+		std::string stored(entry->second.size, '\0');
+		SDL_mutexP(archive->lock);
+		archive->file.clear();
+		archive->file.seekg(entry->second.offset, std::ios::beg);
+		const bool ok = (bool)archive->file.read(&stored[0], stored.size());
+		SDL_mutexV(archive->lock);
+		if (!ok)
+		{
+			return false;
+		}
+		if (entry->second.unpacked == 0)
+		{
+			data.swap(stored);
+			return true;
+		}
+		// inflated outside of the lock, so other threads can read meanwhile
+		std::vector<unsigned char> inflated;
+		inflated.reserve(entry->second.unpacked);
+		if (lodepng::decompress(inflated, (const unsigned char*)stored.data(), stored.size()) || inflated.size() != entry->second.unpacked)
+		{
+			Log(LOG_ERROR) << "corrupt data in mod archive: " << fullPath;
+			return false;
+		}
+		data.assign(inflated.begin(), inflated.end());
+		return true;
+	}
+
+	std::ifstream file(fullPath.c_str(), std::ios::in | std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+	data.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	return true;
+}
+
+std::unique_ptr<std::istream> openFile(const std::string &fullPath)
+{
+	if (isInArchive(fullPath))
+	{
+		std::istringstream *content = new std::istringstream();
+		std::unique_ptr<std::istream> stream(content);
+		std::string data;
+		if (readFile(fullPath, data))
+		{
+			content->str(data);
+		}
+		else
+		{
+			stream->setstate(std::ios::failbit);
+		}
+		return stream;
+	}
+	return std::unique_ptr<std::istream>(new std::ifstream(fullPath.c_str(), std::ios::in | std::ios::binary));
+}
+
+YAML::Node loadYaml(const std::string &fullPath)
+{
+	std::unique_ptr<std::istream> file = openFile(fullPath);
+	if (!*file)
+	{
+		throw Exception(fullPath + " not found");
+	}
+	return YAML::Load(*file);
+}
+
+void packMod(const std::string &dir, const std::string &archivePath)
+{
+	TreeListing tree;
+	_scanDir(dir, tree);
+
+	// collect all files, with path relative to mod directory
+	std::vector<std::string> names;
+	std::vector<std::pair<int, std::string> > stack(1, std::make_pair(0, std::string()));
+	while (!stack.empty())
+	{
+		const DirListing &listing = tree[stack.back().first];
+		const std::string prefix = stack.back().second;
+		stack.pop_back();
+		for (size_t i = 0; i < listing.names.size(); ++i)
+		{
+			const std::string name = _combinePath(prefix, listing.names[i]);
+			if (listing.children[i] == -1)
+			{
+				names.push_back(name);
+			}
+			else
+			{
+				stack.push_back(std::make_pair(listing.children[i], name));
+			}
+		}
+	}
+	std::sort(names.begin(), names.end());
+
+	std::ofstream out(archivePath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!out)
+	{
+		throw Exception("Failed to create " + archivePath);
+	}
+
+	// contents of files go after the index, which is written last when all sizes are known
+	unsigned long long offset = sizeof(_archiveMagic) + 4;
+	for (std::vector<std::string>::const_iterator i = names.begin(); i != names.end(); ++i)
+	{
+		offset += 4 + i->size() + 4 + 4 + 4;
+	}
+	std::vector<ArchiveEntry> entries(names.size());
+	out.seekp(offset, std::ios::beg);
+	std::string data;
+	std::vector<unsigned char> deflated;
+	for (size_t i = 0; i < names.size(); ++i)
+	{
+		if (!readFile(dir + "/" + names[i], data))
+		{
+			throw Exception("Failed to read " + dir + "/" + names[i]);
+		}
+		// files that zlib can't shrink (like PNG) are stored as they are
+		deflated.clear();
+		const bool packed = !data.empty() && lodepng::compress(deflated, (const unsigned char*)data.data(), data.size()) == 0 && deflated.size() < data.size();
+		const size_t size = packed ? deflated.size() : data.size();
+		if (offset + size > 0xFFFFFFFFull)
+		{
+			throw Exception(dir + " is too big for mod archive");
+		}
+		entries[i].offset = (unsigned int)offset;
+		entries[i].size = (unsigned int)size;
+		entries[i].unpacked = packed ? (unsigned int)data.size() : 0;
+		if (packed)
+		{
+			out.write((const char*)&deflated[0], deflated.size());
+		}
+		else
+		{
+			out.write(data.data(), data.size());
+		}
+		offset += size;
+	}
+
+	out.seekp(0, std::ios::beg);
+	out.write(_archiveMagic, sizeof(_archiveMagic));
+	_writeUint(out, names.size());
+	for (size_t i = 0; i < names.size(); ++i)
+	{
+		_writeUint(out, names[i].size());
+		out.write(names[i].c_str(), names[i].size());
+		_writeUint(out, entries[i].offset);
+		_writeUint(out, entries[i].size);
+		_writeUint(out, entries[i].unpacked);
+	}
+	out.close();
+	if (!out)
+	{
+		throw Exception("Failed to write " + archivePath);
+	}
+}
+
 }
 
 }
@@ -20,6 +20,13 @@
 #include <set>
 #include <string>
 #include <vector>
+#include <istream>
+#include <memory>
+
+namespace YAML
+{
+	class Node;
+}
 
 namespace OpenXcom
 {
@@ -51,14 +58,51 @@ namespace FileMap
 	/// clears FileMap state
 	void clear();
 
+	/// Reads directory trees rooted at the specified filesystem paths, in parallel.  Listings are kept
+	/// for following load() calls and reused as long as modification times of their directories do not change.
+	void scan(const std::vector<std::string> &paths);
+
 	/// Scans a directory tree rooted at the specified filesystem path.  Any files it encounters that have already
 	/// been mapped will be ignored.  Therefore, load files from mods with the highest priority first.  If
 	/// ignoreMods is false, it will add any rulesets it finds to the front of the vector
 	/// returned by getMods().
 	void load(const std::string &modId, const std::string &path, bool ignoreMods);
 
+	/// Reads directory trees kept by saveListings() in an earlier run.  scan() uses them instead of
+	/// reading the directories again, as long as modification times of the directories match.
+	void loadListings(const std::string &filename);
+
+	/// Writes directory trees scanned so far to a file, if any of them was scanned again since it was read.
+	void saveListings(const std::string &filename);
+
 	/// Determines if _resources set is empty
 	bool isResourcesEmpty(void);
+
+	/// Checks if the path is a mod packed in a single archive file (*.oxpack).  Archives can be passed
+	/// to scan() and load() in place of directories, their files then have paths like "mod.oxpack/Resources/x.png".
+	bool isArchive(const std::string &path);
+
+	/// Checks if the mod archive at the path was mounted by scan(), broken archives are skipped.
+	bool isMounted(const std::string &path);
+
+	/// Checks if the file path points inside a mounted mod archive.
+	bool isInArchive(const std::string &fullPath);
+
+	/// Checks if a file exists, either on disk or in a mounted mod archive.
+	bool fileExists(const std::string &fullPath);
+
+	/// Reads whole file, either from disk or from a mounted mod archive.  Returns false if the file can't be read.
+	bool readFile(const std::string &fullPath, std::string &data);
+
+	/// Opens file for binary reading, either from disk or from a mounted mod archive.  Check the stream state
+	/// for errors, like for std::ifstream.
+	std::unique_ptr<std::istream> openFile(const std::string &fullPath);
+
+	/// Loads YAML document, either from disk or from a mounted mod archive.
+	YAML::Node loadYaml(const std::string &fullPath);
+
+	/// Packs all files in mod directory into a single archive that can be used in place of the directory.
+	void packMod(const std::string &dir, const std::string &archivePath);
 }
 
 }
@@ -31,6 +31,7 @@
 #include <SDL_mixer.h>
 #include <fstream>
 #include "Logger.h"
+#include "FileMap.h"
 #include "Screen.h"
 #include "Surface.h"
 #include "Options.h"
@@ -78,7 +79,9 @@ enum PlayingState
 	SKIPPED
 };
 
-FlcPlayer::FlcPlayer() : _fileBuf(0), _mainScreen(0), _realScreen(0), _game(0)
+FlcPlayer::FlcPlayer() : _fileBuf(0), _mainScreen(0), _realScreen(0), _game(0), _canvas(0),
+	_frameRead(0), _frameWrite(0), _framesReady(0), _decoderDone(false), _decoderStop(false),
+	_decoderThread(0), _frameLock(0), _frameCond(0)
 {
 	_volume = Game::volumeExponent(Options::musicVolume);
 }
@@ -118,22 +121,17 @@ bool FlcPlayer::init(const char *filename, void(*frameCallBack)(), Game *game, i
 	_audioData.loadingBuffer = 0;
 	_audioData.playingBuffer = 0;
 
-	std::ifstream file;
-	file.open(filename, std::ifstream::in | std::ifstream::binary | std::ifstream::ate);
-	if (!file.is_open())
+	std::string data;
+	if (!FileMap::readFile(filename, data))
 	{
 		Log(LOG_ERROR) << "Could not open FLI/FLC file: " << filename;
 		return false;
 	}
 
-	std::streamoff size = file.tellg();
-	file.seekg(0, std::ifstream::beg);
-
 	// TODO: substitute with a cross-platform memory mapped file?
-	_fileBuf = new Uint8[size];
-	_fileSize = size;
-	file.read((char *)_fileBuf, size);
-	file.close();
+	_fileBuf = new Uint8[data.size()];
+	_fileSize = data.size();
+	std::copy(data.begin(), data.end(), _fileBuf);
 
 	_audioFrameData = _fileBuf + 128;
 
@@ -170,6 +168,8 @@ bool FlcPlayer::init(const char *filename, void(*frameCallBack)(), Game *game, i
 
 void FlcPlayer::deInit()
 {
+	stopDecoder();
+
 	if (_mainScreen != 0 && _realScreen != 0)
 	{
 		if (_mainScreen != _realScreen->getSurface()->getSurface())
@@ -194,12 +194,12 @@ void FlcPlayer::play(bool skipLastFrame)
 	// Vertically center the video
 	_dy = (_mainScreen->h - _headerHeight) / 2;
 
-	_offset = _dy * _mainScreen->pitch + _mainScreen->format->BytesPerPixel * _dx;
-
 	// Skip file header
 	_videoFrameData = _fileBuf + 128;
 	_audioFrameData = _videoFrameData;
 
+	startDecoder();
+
 	while (!shouldQuit())
 	{
 		if (_frameCallBack)
@@ -208,12 +208,122 @@ void FlcPlayer::play(bool skipLastFrame)
 			decodeAudio(2);
 
 		if (!shouldQuit())
-			decodeVideo(skipLastFrame);
+			showNextFrame(skipLastFrame);
 
 		if(!shouldQuit())
 			SDLPolling();
 	}
-	
+
+	stopDecoder();
+}
+
+/**
+ * Prepares the frame queue and starts the thread that decodes
+ * frames ahead of playback. If the thread can't be created,
+ * frames are decoded on demand by the main thread instead.
+ */
+void FlcPlayer::startDecoder()
+{
+	const size_t frameSize = _headerWidth * _headerHeight;
+
+	// first buffer is the decoder canvas, delta chunks are applied to it
+	_framePixels.assign(frameSize * (FRAME_QUEUE_SIZE + 1), 0);
+	_canvas = &_framePixels[0];
+	for (int i = 0; i < FRAME_QUEUE_SIZE; ++i)
+	{
+		_frames[i].pixels = _canvas + frameSize * (i + 1);
+	}
+
+	// colors not set by the video keep what the screen already shows
+	SDL_Palette *palette = _mainScreen->format->palette;
+	if (palette)
+	{
+		std::copy(palette->colors, palette->colors + std::min(palette->ncolors, 256), _colors);
+	}
+
+	_frameRead = 0;
+	_frameWrite = 0;
+	_framesReady = 0;
+	_decoderDone = false;
+	_decoderStop = false;
+
+	_frameLock = SDL_CreateMutex();
+	_frameCond = SDL_CreateCond();
+	if (_frameLock && _frameCond)
+	{
+		_decoderThread = SDL_CreateThread(decoderThread, this);
+	}
+	if (!_decoderThread)
+	{
+		Log(LOG_WARNING) << "Failed to start video decoder thread, decoding frames on playback";
+	}
+}
+
+/**
+ * Stops the decoder thread and frees the frame queue.
+ */
+void FlcPlayer::stopDecoder()
+{
+	if (_decoderThread)
+	{
+		SDL_mutexP(_frameLock);
+		_decoderStop = true;
+		SDL_CondBroadcast(_frameCond);
+		SDL_mutexV(_frameLock);
+		SDL_WaitThread(_decoderThread, 0);
+		_decoderThread = 0;
+	}
+	if (_frameCond)
+	{
+		SDL_DestroyCond(_frameCond);
+		_frameCond = 0;
+	}
+	if (_frameLock)
+	{
+		SDL_DestroyMutex(_frameLock);
+		_frameLock = 0;
+	}
+	std::vector<Uint8>().swap(_framePixels);
+	_canvas = 0;
+}
+
+/**
+ * Decoder thread body, keeps the frame queue full until
+ * the video ends or playback stops.
+ * @param userData Pointer to the FlcPlayer.
+ * @return Thread exit code.
+ */
+int FlcPlayer::decoderThread(void *userData)
+{
+	FlcPlayer *player = (FlcPlayer*)userData;
+
+	SDL_mutexP(player->_frameLock);
+	while (!player->_decoderStop && !player->_decoderDone)
+	{
+		if (player->_framesReady == FRAME_QUEUE_SIZE)
+		{
+			SDL_CondWait(player->_frameCond, player->_frameLock);
+			continue;
+		}
+		SDL_mutexV(player->_frameLock);
+
+		// free slot is not touched by the main thread until it's counted as ready
+		bool decoded = player->decodeFrame(player->_frames[player->_frameWrite]);
+
+		SDL_mutexP(player->_frameLock);
+		if (decoded)
+		{
+			player->_frameWrite = (player->_frameWrite + 1) % FRAME_QUEUE_SIZE;
+			++player->_framesReady;
+		}
+		else
+		{
+			player->_decoderDone = true;
+		}
+		SDL_CondBroadcast(player->_frameCond);
+	}
+	SDL_mutexV(player->_frameLock);
+	return 0;
 }
 
 void FlcPlayer::delay(Uint32 milliseconds)
@@ -306,9 +416,7 @@ void FlcPlayer::decodeAudio(int frames)
 
 				readU16(sampleRate, _audioFrameData + 8);
 
-				_chunkData = _audioFrameData + 16;
-
-				playAudioFrame(sampleRate);
+				playAudioFrame(sampleRate, _audioFrameData + 16);
 
 				_audioFrameData += _audioFrameSize + 16;
 
@@ -319,52 +427,45 @@ void FlcPlayer::decodeAudio(int frames)
 	}
 }
 
-void FlcPlayer::decodeVideo(bool skipLastFrame)
+/**
+ * Decodes the next video frame of the file into the canvas
+ * and copies the result, with its palette, to a queue slot.
+ * @param frame Queue slot to fill.
+ * @return False if there are no more frames.
+ */
+bool FlcPlayer::decodeFrame(VideoFrame &frame)
 {
-	bool videoFrameFound = false;
-	
-	while (!videoFrameFound)
+	while (!isEndOfFile(_videoFrameData))
 	{
 		if (!isValidFrame(_videoFrameData, _videoFrameSize, _videoFrameType))
 		{
-			_playingState = FINISHED;
-			break;
+			return false;
 		}
 
 		switch (_videoFrameType)
 		{
 		case FRAME_TYPE:
-
-			Uint32 delay;
-
 			readU16(_frameChunks, _videoFrameData + 6);
-			readU16(_delayOverride, _videoFrameData + 8);
-
-			if (_headerType == FLI_TYPE)
-			{
-				delay = _delayOverride > 0 ? _delayOverride : _headerSpeed * (1000.0 / 70.0);
-			}
-			else
-			{
-				delay = _videoDelay;
-			}
-
-			waitForNextFrame(delay);
+			readU16(frame.delayOverride, _videoFrameData + 8);
 
 			// Skip the frame header, we are not interested in the rest
 			_chunkData = _videoFrameData + 16;
 
 			_videoFrameData += _videoFrameSize;
-			// If this frame is the last one, don't play it
-			if(isEndOfFile(_videoFrameData))
-				_playingState = FINISHED;
-
-			if(!shouldQuit() || !skipLastFrame)
-				playVideoFrame();
+			frame.last = isEndOfFile(_videoFrameData);
 
-			videoFrameFound = true;
+			_colorFirst = 256;
+			_colorEnd = 0;
+			decodeChunks();
 
-			break;
+			std::copy(_canvas, _canvas + _headerWidth * _headerHeight, frame.pixels);
+			frame.firstColor = _colorFirst;
+			frame.numColors = std::max(0, _colorEnd - _colorFirst);
+			if (frame.numColors > 0)
+			{
+				std::copy(_colors + _colorFirst, _colors + _colorEnd, frame.colors + _colorFirst);
+			}
+			return true;
 		case AUDIO_CHUNK:
 			_videoFrameData += _videoFrameSize + 16;
 			break;
@@ -375,13 +476,124 @@ void FlcPlayer::decodeVideo(bool skipLastFrame)
 			break;
 		}
 	}
+	return false;
+}
+
+/**
+ * Takes the next decoded frame from the queue and shows it
+ * once its delay has passed.
+ * @param skipLastFrame Don't show the last frame of the video.
+ */
+void FlcPlayer::showNextFrame(bool skipLastFrame)
+{
+	if (_decoderThread)
+	{
+		SDL_mutexP(_frameLock);
+		while (_framesReady == 0 && !_decoderDone)
+		{
+			SDL_CondWait(_frameCond, _frameLock);
+		}
+		SDL_mutexV(_frameLock);
+	}
+	else if (_framesReady == 0 && !_decoderDone)
+	{
+		if (decodeFrame(_frames[_frameWrite]))
+		{
+			_frameWrite = (_frameWrite + 1) % FRAME_QUEUE_SIZE;
+			++_framesReady;
+		}
+		else
+		{
+			_decoderDone = true;
+		}
+	}
+
+	if (_framesReady == 0)
+	{
+		_playingState = FINISHED;
+		return;
+	}
+
+	const VideoFrame &frame = _frames[_frameRead];
+	Uint32 delay;
+
+	if (_headerType == FLI_TYPE)
+	{
+		delay = frame.delayOverride > 0 ? frame.delayOverride : _headerSpeed * (1000.0 / 70.0);
+	}
+	else
+	{
+		delay = _videoDelay;
+	}
+
+	waitForNextFrame(delay);
+
+	// If this frame is the last one, don't play it
+	if (frame.last)
+		_playingState = FINISHED;
+
+	if (!shouldQuit() || !skipLastFrame)
+		playVideoFrame(frame);
+
+	if (_decoderThread)
+	{
+		SDL_mutexP(_frameLock);
+		_frameRead = (_frameRead + 1) % FRAME_QUEUE_SIZE;
+		--_framesReady;
+		SDL_CondBroadcast(_frameCond);
+		SDL_mutexV(_frameLock);
+	}
+	else
+	{
+		_frameRead = (_frameRead + 1) % FRAME_QUEUE_SIZE;
+		--_framesReady;
+	}
 }
 
-void FlcPlayer::playVideoFrame()
+/**
+ * Shows a decoded frame on the screen.
+ * @param frame Frame to show.
+ */
+void FlcPlayer::playVideoFrame(const VideoFrame &frame)
 {
 	++_frameCount;
+
+	if (frame.numColors > 0)
+	{
+		SDL_Color *colors = const_cast<SDL_Color*>(frame.colors) + frame.firstColor;
+		if (_mainScreen != _realScreen->getSurface()->getSurface())
+			SDL_SetColors(_mainScreen, colors, frame.firstColor, frame.numColors);
+		_realScreen->setPalette(colors, frame.firstColor, frame.numColors, true);
+	}
+
 	if (SDL_LockSurface(_mainScreen) < 0)
 		return;
+
+	const int offset = _dy * _mainScreen->pitch + _mainScreen->format->BytesPerPixel * _dx;
+	const Uint8 *pSrc = frame.pixels;
+	Uint8 *pDst = (Uint8*)_mainScreen->pixels + offset;
+	for (int y = 0; y < _headerHeight; ++y)
+	{
+		memcpy(pDst, pSrc, _headerWidth);
+		pSrc += _headerWidth;
+		pDst += _mainScreen->pitch;
+	}
+
+	SDL_UnlockSurface(_mainScreen);
+
+	/* TODO: Track which rectangles have really changed */
+	//SDL_UpdateRect(_mainScreen, 0, 0, 0, 0);
+	if (_mainScreen != _realScreen->getSurface()->getSurface())
+		SDL_BlitSurface(_mainScreen, 0, _realScreen->getSurface()->getSurface(), 0);
+
+	_realScreen->flip();
+}
+
+/**
+ * Applies all chunks of the current frame to the canvas.
+ */
+void FlcPlayer::decodeChunks()
+{
 	int chunkCount = _frameChunks;
 
 	for (int i = 0; i < chunkCount; ++i)
@@ -421,18 +633,20 @@ void FlcPlayer::playVideoFrame()
 
 		_chunkData += _chunkSize;
 	}
+}
 
-	SDL_UnlockSurface(_mainScreen);
-
-	/* TODO: Track which rectangles have really changed */
-	//SDL_UpdateRect(_mainScreen, 0, 0, 0, 0);
-	if (_mainScreen != _realScreen->getSurface()->getSurface())
-		SDL_BlitSurface(_mainScreen, 0, _realScreen->getSurface()->getSurface(), 0);
-
-	_realScreen->flip();
+/**
+ * Marks palette entries changed by the current frame.
+ * @param first First changed color.
+ * @param count Number of changed colors.
+ */
+void FlcPlayer::setColors(int first, int count)
+{
+	_colorFirst = std::min(_colorFirst, first);
+	_colorEnd = std::max(_colorEnd, std::min(first + count, 256));
 }
 
-void FlcPlayer::playAudioFrame(Uint16 sampleRate)
+void FlcPlayer::playAudioFrame(Uint16 sampleRate, const Uint8 *samples)
 {
 	/* TFTD audio header (10 bytes)
 	* Uint16 unknown1 - always 0
@@ -468,7 +682,7 @@ void FlcPlayer::playAudioFrame(Uint16 sampleRate)
 
 	for (unsigned int i = 0; i < _audioFrameSize; i++)
 	{
-		loadingBuff->samples[loadingBuff->sampleCount + i] = (float)((_chunkData[i]) -128) * 240 * _volume;
+		loadingBuff->samples[loadingBuff->sampleCount + i] = (float)((samples[i]) -128) * 240 * _volume;
 	}
 	loadingBuff->sampleCount += _audioFrameSize;
 
@@ -495,16 +709,17 @@ void FlcPlayer::color256()
 			numColors = 256;
 		}
 
-		for (int i = 0; i < numColors; ++i)
+		for (int i = 0; i < numColors; ++i, pSrc += 3)
 		{
-			_colors[i].r = *(pSrc++);
-			_colors[i].g = *(pSrc++);
-			_colors[i].b = *(pSrc++);
+			if (numColorsSkip + i < 256)
+			{
+				_colors[numColorsSkip + i].r = pSrc[0];
+				_colors[numColorsSkip + i].g = pSrc[1];
+				_colors[numColorsSkip + i].b = pSrc[2];
+			}
 		}
 
-		if (_mainScreen != _realScreen->getSurface()->getSurface())
-			SDL_SetColors(_mainScreen, _colors, numColorsSkip, numColors);
-		_realScreen->setPalette(_colors, numColorsSkip, numColors, true);
+		setColors(numColorsSkip, numColors);
 
 		if (numColorPackets >= 1)
 		{
@@ -524,7 +739,7 @@ void FlcPlayer::fliSS2()
 	Uint8 lastByte = 0;
 
 	pSrc = _chunkData + 6;
-	pDst = (Uint8*)_mainScreen->pixels + _offset;
+	pDst = _canvas;
 	readU16(lines, pSrc);
 
 	pSrc += 2;
@@ -536,7 +751,7 @@ void FlcPlayer::fliSS2()
 
 		if ((count & MASK) == SKIP_LINES) 
 		{
-			pDst += (-count)*_mainScreen->pitch;
+			pDst += (-count)*_headerWidth;
 			++lines;
 			continue;
 		}
@@ -585,9 +800,9 @@ void FlcPlayer::fliSS2()
 			if (setLastByte)
 			{
 				setLastByte = false;
-				*(pDst + _mainScreen->pitch - 1) = lastByte;
+				*(pDst + _headerWidth - 1) = lastByte;
 			}
-			pDst += _mainScreen->pitch;
+			pDst += _headerWidth;
 		}
 	}
 }
@@ -600,7 +815,7 @@ void FlcPlayer::fliBRun()
 
 	heightCount = _headerHeight;
 	pSrc = _chunkData + 6; // Skip chunk header
-	pDst = (Uint8*)_mainScreen->pixels + _offset;
+	pDst = _canvas;
 
 	while (heightCount--) 
 	{
@@ -632,7 +847,7 @@ void FlcPlayer::fliBRun()
 				}
 			}
 		}
-		pDst += _mainScreen->pitch;
+		pDst += _headerWidth;
 	}
 }
 
@@ -647,11 +862,11 @@ void FlcPlayer::fliLC()
 	int packetsCount;
 
 	pSrc = _chunkData + 6;
-	pDst = (Uint8*)_mainScreen->pixels + _offset;
+	pDst = _canvas;
 
 	readU16(tmp, pSrc);
 	pSrc += 2;
-	pDst += tmp*_mainScreen->pitch;
+	pDst += tmp*_headerWidth;
 	readU16(lines, pSrc);
 	pSrc += 2;
 
@@ -686,7 +901,7 @@ void FlcPlayer::fliLC()
 				}
 			}
 		}
-		pDst += _mainScreen->pitch;
+		pDst += _headerWidth;
 	}
 }
 
@@ -710,16 +925,17 @@ void FlcPlayer::color64()
 			NumColors = 256;
 		}
 
-		for (int i = 0; i < NumColors; ++i)
+		for (int i = 0; i < NumColors; ++i, pSrc += 3)
 		{
-			_colors[i].r = *(pSrc++) << 2;
-			_colors[i].g = *(pSrc++) << 2;
-			_colors[i].b = *(pSrc++) << 2;
+			if (NumColorsSkip + i < 256)
+			{
+				_colors[NumColorsSkip + i].r = pSrc[0] << 2;
+				_colors[NumColorsSkip + i].g = pSrc[1] << 2;
+				_colors[NumColorsSkip + i].b = pSrc[2] << 2;
+			}
 		}
 
-		if (_mainScreen != _realScreen->getSurface()->getSurface())
-			SDL_SetColors(_mainScreen, _colors, NumColorsSkip, NumColors);
-		_realScreen->setPalette(_colors, NumColorsSkip, NumColors, true);
+		setColors(NumColorsSkip, NumColors);
 	}
 }
 
@@ -728,13 +944,13 @@ void FlcPlayer::fliCopy()
 	Uint8 *pSrc, *pDst;
 	int Lines = _screenHeight;
 	pSrc = _chunkData + 6;
-	pDst = (Uint8*)_mainScreen->pixels + _offset;
+	pDst = _canvas;
 
 	while (Lines--) 
 	{
 		memcpy(pDst, pSrc, _screenWidth);
 		pSrc += _screenWidth;
-		pDst += _mainScreen->pitch;
+		pDst += _headerWidth;
 	}
 }
 
@@ -742,12 +958,12 @@ void FlcPlayer::black()
 {
 	Uint8 *pDst;
 	int Lines = _screenHeight;
-	pDst = (Uint8*)_mainScreen->pixels + _offset;
+	pDst = _canvas;
 
 	while (Lines-- > 0) 
 	{
-		memset(pDst, 0, _screenHeight);
-		pDst += _mainScreen->pitch;
+		memset(pDst, 0, _screenWidth);
+		pDst += _headerWidth;
 	}
 }
 
@@ -23,6 +23,8 @@
  * Based on http://www.libsdl.org/projects/flxplay/
  */
 #include <SDL.h>
+#include <SDL_thread.h>
+#include <vector>
 
 namespace OpenXcom
 {
@@ -52,7 +54,6 @@ private:
 	Uint16 _frameChunks;   /* Number of chunks in frame */
 	Uint32 _chunkSize;     /* Size of chunk */
 	Uint16 _chunkType;     /* Type of chunk */
-	Uint16 _delayOverride; /* FRAME_TYPE extension */
 	Uint32 _audioFrameSize;
 	Uint16 _audioFrameType;
 
@@ -65,7 +66,6 @@ private:
 	int _screenHeight;
 	int _screenDepth;
 	int _dx, _dy;
-	int _offset;
 	int _playingState;
 	bool _hasAudio;
 	int _videoDelay;
@@ -93,6 +93,29 @@ private:
 
 	Game *_game;
 
+	/// Number of decoded frames that can wait to be shown.
+	static const int FRAME_QUEUE_SIZE = 8;
+
+	typedef struct VideoFrame
+	{
+		Uint8 *pixels;
+		SDL_Color colors[256];
+		int firstColor;
+		int numColors;
+		Uint16 delayOverride; /* FRAME_TYPE extension */
+		bool last;
+	}VideoFrame;
+
+	std::vector<Uint8> _framePixels;
+	Uint8 *_canvas;
+	int _colorFirst, _colorEnd;
+	VideoFrame _frames[FRAME_QUEUE_SIZE];
+	int _frameRead, _frameWrite, _framesReady;
+	bool _decoderDone, _decoderStop;
+	SDL_Thread *_decoderThread;
+	SDL_mutex *_frameLock;
+	SDL_cond *_frameCond;
+
 	void readU16(Uint16 &dst, const Uint8 *const src);
 	void readU32(Uint32 &dst, const Uint8 *const src);
 	void readS16(Sint16 &dst, const Sint8 *const src);
@@ -100,13 +123,18 @@ private:
 	void readFileHeader();
 
 	bool isValidFrame(Uint8 *frameHeader, Uint32 &frameSize, Uint16 &frameType);
-	void decodeVideo(bool skipLastFrame);
 	void decodeAudio(int frames);
+	bool decodeFrame(VideoFrame &frame);
+	void showNextFrame(bool skipLastFrame);
+	void startDecoder();
+	void stopDecoder();
 	void waitForNextFrame(Uint32 delay);
 	void SDLPolling();
 	bool shouldQuit();
 
-	void playVideoFrame();
+	void playVideoFrame(const VideoFrame &frame);
+	void decodeChunks();
+	void setColors(int first, int count);
 	void color256();
 	void fliBRun();
 	void fliCopy();
@@ -115,13 +143,14 @@ private:
 	void color64();
 	void black();
 
-	void playAudioFrame(Uint16 sampleRate);
+	void playAudioFrame(Uint16 sampleRate, const Uint8 *samples);
 	void initAudio(Uint16 format, Uint8 channels);
 	void deInitAudio();
 
 	bool isEndOfFile(Uint8 *pos);
 
 	static void audioCallback(void *userData, Uint8 *stream, int len);
+	static int decoderThread(void *userData);
 
 public:
 
@@ -30,6 +30,12 @@ namespace OpenXcom
  */
 Font::Font() : _monospace(false)
 {
+	for (unsigned i = 0; i < LATIN_CHARS; ++i)
+	{
+		_latin[i].surface = 0;
+		_latin[i].spacing = 0;
+		_latin[i].rect.x = _latin[i].rect.y = _latin[i].rect.w = _latin[i].rect.h = 0;
+	}
 }
 
 /**
@@ -117,7 +123,7 @@ void Font::init(size_t index, const std::wstring &str)
 			rect.y = startY;
 			rect.w = image->width;
 			rect.h = image->height;
-			_chars[str[i]] = std::make_pair(index, rect);
+			setGlyph(str[i], index, rect);
 		}
 	}
 	else
@@ -155,27 +161,33 @@ void Font::init(size_t index, const std::wstring &str)
 			rect.w = right - left + 1;
 			rect.h = image->height;
 
-			_chars[str[i]] = std::make_pair(index, rect);
+			setGlyph(str[i], index, rect);
 		}
 	}
 	surface->unlock();
 }
 
 /**
- * Returns a particular character from the set stored in the font.
- * @param c Character to use for size/position.
- * @return Pointer to the font's surface with the respective
- * cropping rectangle set up.
+ * Stores where a character is in the font images, Latin-1
+ * characters go in a flat table and the rest in a hash table.
+ * @param c Character.
+ * @param index The index of the surface that has the character.
+ * @param rect Position of the character in the surface.
  */
-Surface *Font::getChar(wchar_t c)
+void Font::setGlyph(wchar_t c, size_t index, const SDL_Rect &rect)
 {
-	if (_chars.find(c) == _chars.end())
+	FontGlyph glyph;
+	glyph.surface = _images[index].surface;
+	glyph.rect = rect;
+	glyph.spacing = _images[index].spacing;
+	if (static_cast<unsigned>(c) < LATIN_CHARS)
+	{
+		_latin[c] = glyph;
+	}
+	else
 	{
-		return 0;
+		_chars[c] = glyph;
 	}
-	Surface *surface = _images[_chars[c].first].surface;
-	*surface->getCrop() = _chars[c].second;
-	return surface;
 }
 
 /**
@@ -212,14 +224,21 @@ int Font::getSpacing() const
  * @param c Font character.
  * @return Width and Height dimensions (X and Y are ignored).
  */
-SDL_Rect Font::getCharSize(wchar_t c)
+SDL_Rect Font::getCharSize(wchar_t c) const
 {
 	SDL_Rect size = { 0, 0, 0, 0 };
 	if (c != 1 && !isLinebreak(c) && !isSpace(c))
 	{
-		FontImage *image = &_images[_chars[c].first];
-		size.w = _chars[c].second.w + image->spacing;
-		size.h = _chars[c].second.h + image->spacing;
+		const FontGlyph *glyph = getGlyph(c);
+		if (glyph != 0)
+		{
+			size.w = glyph->rect.w + glyph->spacing;
+			size.h = glyph->rect.h + glyph->spacing;
+		}
+		else
+		{
+			size.w = size.h = getSpacing();
+		}
 	}
 	else
 	{
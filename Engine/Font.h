@@ -17,7 +17,7 @@
  * You should have received a copy of the GNU General Public License
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <map>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 #include <string>
@@ -36,6 +36,16 @@ struct FontImage
 	Surface *surface;
 };
 
+/**
+ * Position of a single character in one of the font images.
+ */
+struct FontGlyph
+{
+	Surface *surface;
+	SDL_Rect rect;
+	int spacing;
+};
+
 /**
  * Takes care of loading and storing each character in a sprite font.
  * Sprite fonts consist of a set of characters split in fixed-size regions.
@@ -45,11 +55,17 @@ struct FontImage
 class Font
 {
 private:
+	/// Characters that are looked up directly by their code, the rest goes to a hash table.
+	static const unsigned LATIN_CHARS = 256;
+
 	std::vector<FontImage> _images;
-	std::map< wchar_t, std::pair<size_t, SDL_Rect> > _chars;
+	FontGlyph _latin[LATIN_CHARS];
+	std::unordered_map<wchar_t, FontGlyph> _chars;
 	bool _monospace;
 	/// Determines the size and position of each character in the font.
 	void init(size_t index, const std::wstring &str);
+	/// Stores the position of a character.
+	void setGlyph(wchar_t c, size_t index, const SDL_Rect &rect);
 public:
 	/// Creates a blank font.
 	Font();
@@ -67,8 +83,16 @@ public:
 	void load(const YAML::Node& node);
 	/// Generate the terminal font.
 	void loadTerminal();
-	/// Gets a particular character from the font, with its real size.
-	Surface *getChar(wchar_t c);
+	/// Gets the glyph of a particular character, or null if the font doesn't have it.
+	const FontGlyph *getGlyph(wchar_t c) const
+	{
+		if (static_cast<unsigned>(c) < LATIN_CHARS)
+		{
+			return _latin[c].surface ? &_latin[c] : 0;
+		}
+		std::unordered_map<wchar_t, FontGlyph>::const_iterator i = _chars.find(c);
+		return i != _chars.end() ? &i->second : 0;
+	}
 	/// Gets the font's character width.
 	int getWidth() const;
 	/// Gets the font's character height.
@@ -76,7 +100,7 @@ public:
 	/// Gets the spacing between characters.
 	int getSpacing() const;
 	/// Gets the size of a particular character;
-	SDL_Rect getCharSize(wchar_t c);
+	SDL_Rect getCharSize(wchar_t c) const;
 	/// Gets the font's palette.
 	SDL_Color *getPalette() const;
 	/// Sets the font's palette.
@@ -37,6 +37,7 @@
 #include "Options.h"
 #include "CrossPlatform.h"
 #include "FileMap.h"
+#include "Timer.h"
 #include "../Menu/TestState.h"
 #include <algorithm>
 
@@ -50,7 +51,7 @@ const double Game::VOLUME_GRADIENT = 10.0;
  * creates the display screen and sets up the cursor.
  * @param title Title of the game window.
  */
-Game::Game(const std::string &title) : _screen(0), _cursor(0), _lang(0), _save(0), _mod(0), _quit(false), _init(false), _mouseActive(true), _timeUntilNextFrame(0)
+Game::Game(const std::string &title) : _screen(0), _cursor(0), _lang(0), _save(0), _mod(0), _quit(false), _init(false), _mouseActive(true), _nextFrame(0), _sleepOvershoot(0)
 {
 	Options::reload = false;
 	Options::mute = false;
@@ -97,12 +98,10 @@ Game::Game(const std::string &title) : _screen(0), _cursor(0), _lang(0), _save(0
 	SDL_SetCursor(SDL_CreateCursor(&cursor, &cursor, 1,1,0,0));
 
 	// Create fps counter
-	_fpsCounter = new FpsCounter(15, 5, 0, 0);
+	_fpsCounter = new FpsCounter(15, 11, 0, 0);
 
 	// Create blank language
 	_lang = new Language();
-
-	_timeOfLastFrame = 0;
 }
 
 /**
@@ -197,6 +196,10 @@ void Game::run()
 							break;
 					}
 					break;
+				case SDL_VIDEOEXPOSE:
+					// window contents were lost, unchanged frames can't be skipped
+					_screen->invalidate();
+					break;
 				case SDL_VIDEORESIZE:
 					if (Options::allowResize)
 					{
@@ -260,6 +263,7 @@ void Game::run()
 		}
 		
 		// Process rendering
+		Uint64 frameTime = 0;
 		if (runningState != PAUSED)
 		{
 			// Process logic
@@ -267,20 +271,19 @@ void Game::run()
 			_fpsCounter->think();
 			if (Options::FPS > 0 && !(Options::useOpenGL && Options::vSyncForOpenGL))
 			{
-				// Update our FPS delay time based on the time of the last draw.
 				int fps = SDL_GetAppState() & SDL_APPINPUTFOCUS ? Options::FPS : Options::FPSInactive;
-
-				_timeUntilNextFrame = (1000.0f / fps) - (SDL_GetTicks() - _timeOfLastFrame);
-			}
-			else
-			{
-				_timeUntilNextFrame = 0;
+				frameTime = fps > 0 ? 1000000 / fps : 0;
 			}
 
-			if (_init && _timeUntilNextFrame <= 0)
+			const Uint64 now = CrossPlatform::getMonotonicTime();
+			if (_init && now >= _nextFrame)
 			{
-				// make a note of when this frame update occurred.
-				_timeOfLastFrame = SDL_GetTicks();
+				// keep frames on a fixed schedule, unless we fell behind it
+				_nextFrame += frameTime;
+				if (_nextFrame <= now)
+				{
+					_nextFrame = now + frameTime;
+				}
 				_fpsCounter->addFrame();
 				_screen->clear();
 				std::list<State*>::iterator i = _states.end();
@@ -301,10 +304,19 @@ void Game::run()
 		}
 
 		// Save on CPU
+		const Uint64 nextTimer = Timer::takeNextDeadline();
 		switch (runningState)
 		{
 			case RUNNING: 
-				SDL_Delay(1); //Save CPU from going 100%
+				if (frameTime > 0)
+				{
+					// wake up for whatever comes first, the next frame or the next logic tick
+					sleepUntil(std::min(_nextFrame, nextTimer));
+				}
+				else
+				{
+					SDL_Delay(1); //Save CPU from going 100%
+				}
 				break;
 			case SLOWED: case PAUSED:
 				SDL_Delay(100); break; //More slowing down.
@@ -314,6 +326,34 @@ void Game::run()
 	Options::save();
 }
 
+/**
+ * Sleeps until the given time. SDL_Delay only works in whole milliseconds
+ * and usually wakes up late, so it sleeps a bit shorter by the average
+ * lateness of previous sleeps. What is left is slept away a millisecond
+ * at a time, only the last millisecond is spent yielding the processor.
+ * @param deadline Time of CrossPlatform::getMonotonicTime to wake up at.
+ */
+void Game::sleepUntil(Uint64 deadline)
+{
+	// never busy wait for longer than this, even if the system timer is coarse
+	const Uint64 maxOvershoot = 2000;
+	Uint64 now = CrossPlatform::getMonotonicTime();
+	if (deadline > now + _sleepOvershoot + 1000)
+	{
+		const Uint32 delay = (Uint32)((deadline - now - _sleepOvershoot) / 1000);
+		SDL_Delay(delay);
+		const Uint64 woke = CrossPlatform::getMonotonicTime();
+		const Uint64 overshoot = std::min(woke - now > delay * 1000 ? woke - now - delay * 1000 : 0, maxOvershoot);
+		_sleepOvershoot = (_sleepOvershoot * 7 + overshoot) / 8;
+		now = woke;
+	}
+	while (now < deadline)
+	{
+		SDL_Delay(deadline - now > 1000 ? 1 : 0);
+		now = CrossPlatform::getMonotonicTime();
+	}
+}
+
 /**
  * Stops the state machine and the game is shut down.
  */
@@ -473,7 +513,7 @@ void Game::loadLanguage(const std::string &filename)
 			std::string modId = i->first;
 			ModInfo modInfo = Options::getModInfos().find(modId)->second;
 			std::string file = modInfo.getPath() + ss.str();
-			if (CrossPlatform::fileExists(file))
+			if (FileMap::fileExists(file))
 			{
 				_lang->load(file);
 			}
@@ -51,10 +51,12 @@ private:
 	bool _quit, _init;
 	FpsCounter *_fpsCounter;
 	bool _mouseActive;
-	unsigned int _timeOfLastFrame;
-	int _timeUntilNextFrame;
+	Uint64 _nextFrame, _sleepOvershoot;
 	static const double VOLUME_GRADIENT;
 
+	/// Sleeps until the given time.
+	void sleepUntil(Uint64 deadline);
+
 public:
 	/// Creates a new game and initializes SDL.
 	Game(const std::string &title);
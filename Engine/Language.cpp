@@ -18,6 +18,7 @@
  */
 
 #include "Language.h"
+#include "FileMap.h"
 #include <algorithm>
 #include <fstream>
 #include <cassert>
@@ -382,7 +383,7 @@ void Language::getList(std::vector<std::string> &files, std::vector<std::wstring
  */
 void Language::load(const std::string &filename)
 {
-	YAML::Node doc = YAML::LoadFile(filename);
+	YAML::Node doc = FileMap::loadYaml(filename);
 	_id = doc.begin()->first.as<std::string>();
 	YAML::Node lang = doc.begin()->second;
 	for (YAML::const_iterator i = lang.begin(); i != lang.end(); ++i)
@@ -18,6 +18,7 @@
  */
 
 #include "ModInfo.h"
+#include "FileMap.h"
 #include "CrossPlatform.h"
 #include <yaml-cpp/yaml.h>
 
@@ -25,7 +26,7 @@ namespace OpenXcom
 {
 
 ModInfo::ModInfo(const std::string &path) :
-	 _path(path), _name(CrossPlatform::baseFilename(path)),
+	 _path(path), _name(FileMap::isArchive(path) ? CrossPlatform::noExt(CrossPlatform::baseFilename(path)) : CrossPlatform::baseFilename(path)),
 	_desc("No description."), _version("1.0"), _author("unknown author"),
 	_id(_name), _master("xcom1"), _isMaster(false), _reservedSpace(1)
 {
@@ -39,7 +40,7 @@ ModInfo::~ModInfo()
 
 void ModInfo::load(const std::string &filename)
 {
-	YAML::Node doc = YAML::LoadFile(filename);
+	YAML::Node doc = FileMap::loadYaml(filename);
 
 	_name     = doc["name"].as<std::string>(_name);
 	_desc     = doc["description"].as<std::string>(_desc);
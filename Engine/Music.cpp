@@ -17,20 +17,102 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "Music.h"
+#include <fstream>
+#include <vector>
+#include <SDL_thread.h>
 #include "Exception.h"
 #include "Options.h"
 #include "Logger.h"
 #include "Language.h"
+#include "FileMap.h"
 #include "Adlib/adlplayer.h"
 #include "AdlibMusic.h"
 
 namespace OpenXcom
 {
 
+namespace
+{
+
+/**
+ * Music file read into memory by a background thread.
+ */
+struct MusicPrefetch
+{
+	std::string filename;
+	std::string data;
+	bool loaded;
+	SDL_Thread *thread;
+};
+
+/// Most files kept in memory before they are played.
+const size_t MaxPrefetch = 2;
+/// Files read in the background, oldest first.
+std::vector<MusicPrefetch*> prefetched;
+
+/**
+ * Reads a whole music file.
+ * @param data Pointer to the MusicPrefetch.
+ * @return Thread exit code.
+ */
+int prefetchThread(void *data)
+{
+	MusicPrefetch *p = (MusicPrefetch*)data;
+	std::ifstream file(p->filename.c_str(), std::ios::binary);
+	if (file)
+	{
+		file.seekg(0, std::ios::end);
+		p->data.resize((size_t)file.tellg());
+		file.seekg(0);
+		file.read(&p->data[0], p->data.size());
+		p->loaded = file.good();
+	}
+	return 0;
+}
+
+/**
+ * Waits for a background read and frees it.
+ * @param p Pointer to the MusicPrefetch.
+ */
+void finishPrefetch(MusicPrefetch *p)
+{
+	SDL_WaitThread(p->thread, 0);
+	delete p;
+}
+
+/**
+ * Takes the contents of a prefetched music file, waiting for the read to finish.
+ * @param filename Filename of the music file.
+ * @param data Gets the file contents.
+ * @return True if the file was prefetched and read successfully.
+ */
+bool takePrefetch(const std::string &filename, std::string &data)
+{
+	for (std::vector<MusicPrefetch*>::iterator i = prefetched.begin(); i != prefetched.end(); ++i)
+	{
+		if ((*i)->filename == filename)
+		{
+			MusicPrefetch *p = *i;
+			prefetched.erase(i);
+			SDL_WaitThread(p->thread, 0);
+			bool loaded = p->loaded;
+			if (loaded)
+			{
+				data.swap(p->data);
+			}
+			delete p;
+			return loaded;
+		}
+	}
+	return false;
+}
+
+}
+
 /**
  * Initializes a new music track.
  */
-Music::Music() : _music(0)
+Music::Music() : _music(0), _rwops(0)
 {
 }
 
@@ -42,6 +124,10 @@ Music::~Music()
 #ifndef __NO_MUSIC
 	stop();
 	Mix_FreeMusic(_music);
+	if (_rwops)
+	{
+		SDL_FreeRW(_rwops);
+	}
 #endif
 }
 
@@ -52,6 +138,27 @@ Music::~Music()
 void Music::load(const std::string &filename)
 {
 #ifndef __NO_MUSIC
+	bool inMemory = takePrefetch(filename, _data);
+	if (!inMemory && FileMap::isInArchive(filename))
+	{
+		if (!FileMap::readFile(filename, _data))
+		{
+			throw Exception(filename + " not found");
+		}
+		inMemory = true;
+	}
+	if (inMemory)
+	{
+		// music is streamed, so data need stay alive until music is freed
+		_rwops = SDL_RWFromConstMem(_data.data(), _data.size());
+		_music = Mix_LoadMUS_RW(_rwops);
+		if (_music == 0)
+		{
+			throw Exception(Mix_GetError());
+		}
+		return;
+	}
+
 	// SDL only takes UTF-8 filenames
 	// so here's an ugly hack to match this ugly reasoning
 	std::string utf8 = Language::wstrToUtf8(Language::fsToWstr(filename));
@@ -111,6 +218,7 @@ void Music::stop()
 #ifndef __NO_MUSIC
 	if (!Options::mute)
 	{
+		AdlibMusic::stopRender();
 		func_mute();
 		Mix_HookMusic(NULL, NULL);
 		Mix_HaltMusic();
@@ -162,4 +270,58 @@ bool Music::isPlaying()
 	return false;
 }
 
+/**
+ * Starts reading a music file into memory on a background thread,
+ * so loading it later doesn't have to wait for the disk.
+ * Only a few files are kept, older ones are dropped.
+ * @param filename Filename of the music file.
+ */
+void Music::prefetch(const std::string &filename)
+{
+#ifndef __NO_MUSIC
+	// archives share one stream, they can't be read from other threads
+	if (FileMap::isInArchive(filename))
+	{
+		return;
+	}
+	for (std::vector<MusicPrefetch*>::const_iterator i = prefetched.begin(); i != prefetched.end(); ++i)
+	{
+		if ((*i)->filename == filename)
+		{
+			return;
+		}
+	}
+	if (prefetched.size() >= MaxPrefetch)
+	{
+		finishPrefetch(prefetched.front());
+		prefetched.erase(prefetched.begin());
+	}
+
+	MusicPrefetch *p = new MusicPrefetch();
+	p->filename = filename;
+	p->loaded = false;
+	p->thread = SDL_CreateThread(prefetchThread, p);
+	if (p->thread)
+	{
+		prefetched.push_back(p);
+	}
+	else
+	{
+		delete p;
+	}
+#endif
+}
+
+/**
+ * Stops all background reads and drops the prefetched files.
+ */
+void Music::clearPrefetch()
+{
+	for (std::vector<MusicPrefetch*>::iterator i = prefetched.begin(); i != prefetched.end(); ++i)
+	{
+		finishPrefetch(*i);
+	}
+	prefetched.clear();
+}
+
 }
@@ -31,6 +31,8 @@ class Music
 {
 private:
 	Mix_Music *_music;
+	std::string _data;
+	SDL_RWops *_rwops;
 public:
 	/// Creates a blank music track.
 	Music();
@@ -50,6 +52,10 @@ public:
 	static void resume();
 	/// Checks if music is playing.
 	static bool isPlaying();
+	/// Starts reading a music file in the background.
+	static void prefetch(const std::string &filename);
+	/// Stops all background reads and drops their data.
+	static void clearPrefetch();
 };
 
 }
@@ -74,6 +74,7 @@ void create()
 
 	_info.push_back(OptionInfo("maxFrameSkip", &maxFrameSkip, 0));
 	_info.push_back(OptionInfo("traceAI", &traceAI, false));
+	_info.push_back(OptionInfo("scriptProfiling", &scriptProfiling, false));
 	_info.push_back(OptionInfo("verboseLogging", &verboseLogging, false));
 	_info.push_back(OptionInfo("StereoSound", &StereoSound, true));
 	//_info.push_back(OptionInfo("baseXResolution", &baseXResolution, Screen::ORIGINAL_WIDTH));
@@ -116,6 +117,8 @@ void create()
 	_info.push_back(OptionInfo("audioBitDepth", &audioBitDepth, 16));
 	_info.push_back(OptionInfo("audioChunkSize", &audioChunkSize, 1024));
 	_info.push_back(OptionInfo("pauseMode", &pauseMode, 0));
+	_info.push_back(OptionInfo("compressSaves", &compressSaves, false));
+	_info.push_back(OptionInfo("mapCacheSize", &mapCacheSize, 64)); // MB of terrain data kept between battles
 	_info.push_back(OptionInfo("battleNotifyDeath", &battleNotifyDeath, false));
 	_info.push_back(OptionInfo("showFundsOnGeoscape", &showFundsOnGeoscape, false));
 	_info.push_back(OptionInfo("allowResize", &allowResize, false));
@@ -438,6 +441,8 @@ bool showHelp(int argc, char *argv[])
 	help << "        use PATH as the default Config Folder instead of auto-detecting" << std::endl << std::endl;
 	help << "-KEY VALUE" << std::endl;
 	help << "        set option KEY to VALUE instead of default/loaded value (eg. -displayWidth 640)" << std::endl << std::endl;
+	help << "-pack-mod PATH" << std::endl;
+	help << "        pack all files of mod folder PATH into a single archive PATH.oxpack and exit" << std::endl << std::endl;
 	help << "-help" << std::endl;
 	help << "-?" << std::endl;
 	help << "        show command-line help" << std::endl;
@@ -462,6 +467,39 @@ bool showHelp(int argc, char *argv[])
 	return false;
 }
 
+/**
+ * Packs a mod folder into a single archive when asked by command-line.
+ * @param argc Number of arguments.
+ * @param argv Array of argument strings.
+ * @return True if the mod was packed (or packing failed) and the game should exit.
+ */
+static bool _packMod(int argc, char *argv[])
+{
+	for (int i = 1; i < argc - 1; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "-pack-mod" || arg == "--pack-mod" || arg == "/pack-mod")
+		{
+			std::string dir = argv[i + 1];
+			while (dir.size() > 1 && (dir[dir.size() - 1] == '/' || dir[dir.size() - 1] == CrossPlatform::PATH_SEPARATOR))
+			{
+				dir.resize(dir.size() - 1);
+			}
+			try
+			{
+				FileMap::packMod(dir, dir + ".oxpack");
+				std::cout << "Mod packed into " << dir << ".oxpack" << std::endl;
+			}
+			catch (Exception &e)
+			{
+				std::cerr << e.what() << std::endl;
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
 const std::map<std::string, ModInfo> &getModInfos() { return _modInfos; }
 
 static void _scanMods(const std::string &modsDir)
@@ -476,7 +514,16 @@ static void _scanMods(const std::string &modsDir)
 	for (std::vector<std::string>::iterator i = contents.begin(); i != contents.end(); ++i)
 	{
 		std::string modPath = modsDir + CrossPlatform::PATH_SEPARATOR + *i;
-		if (!CrossPlatform::folderExists(modPath))
+		if (FileMap::isArchive(modPath))
+		{
+			// mount packed mod to read its metadata
+			FileMap::scan(std::vector<std::string>(1, modPath));
+			if (!FileMap::isMounted(modPath))
+			{
+				continue;
+			}
+		}
+		else if (!CrossPlatform::folderExists(modPath))
 		{
 			// skip non-directories (e.g. README.txt)
 			continue;
@@ -486,7 +533,7 @@ static void _scanMods(const std::string &modsDir)
 		ModInfo modInfo(modPath);
 
 		std::string metadataPath = modPath + "/metadata.yml";
-		if (!CrossPlatform::fileExists(metadataPath))
+		if (!FileMap::fileExists(metadataPath))
 		{
 			Log(LOG_VERBOSE) << metadataPath << " not found; using default values for mod: " << *i;
 		}
@@ -531,6 +578,8 @@ bool init(int argc, char *argv[])
 {
 	if (showHelp(argc, argv))
 		return false;
+	if (_packMod(argc, argv))
+		return false;
 	create();
 	resetDefault();
 	loadArgs(argc, argv);
@@ -567,6 +616,7 @@ bool init(int argc, char *argv[])
 void updateMods()
 {
 	// pick up stuff in common before-hand
+	FileMap::loadListings(_userFolder + "listings.dat");
 	FileMap::load("common", CrossPlatform::searchDataFolder("common"), true);
 
 	std::string modPath = CrossPlatform::searchDataFolder("standard");
@@ -700,7 +750,16 @@ std::string getActiveMaster()
 	return curMaster;
 }
 
-static void _loadMod(const ModInfo &modInfo, std::set<std::string> circDepCheck)
+/**
+ * Directory tree that is mapped for a mod.
+ */
+struct ModResourceDir
+{
+	std::string modId, path;
+	bool ignoreMods;
+};
+
+static void _loadMod(const ModInfo &modInfo, std::set<std::string> circDepCheck, std::vector<ModResourceDir> &dirs)
 {
 	if (circDepCheck.end() != circDepCheck.find(modInfo.getId()))
 	{
@@ -708,7 +767,8 @@ static void _loadMod(const ModInfo &modInfo, std::set<std::string> circDepCheck)
 		return;
 	}
 
-	FileMap::load(modInfo.getId(), modInfo.getPath(), false);
+	ModResourceDir modDir = { modInfo.getId(), modInfo.getPath(), false };
+	dirs.push_back(modDir);
 	for (std::vector<std::string>::const_iterator i = modInfo.getExternalResourceDirs().begin(); i != modInfo.getExternalResourceDirs().end(); ++i)
 	{
 		// use external resource folders from the user dir if they exist
@@ -720,7 +780,8 @@ static void _loadMod(const ModInfo &modInfo, std::set<std::string> circDepCheck)
 		}
 
 		// always ignore ruleset files in external resource dir
-		FileMap::load(modInfo.getId(), extResourceFolder, true);
+		ModResourceDir extDir = { modInfo.getId(), extResourceFolder, true };
+		dirs.push_back(extDir);
 	}
 
 	// if this is a master but it has a master of its own, allow it to
@@ -733,7 +794,7 @@ static void _loadMod(const ModInfo &modInfo, std::set<std::string> circDepCheck)
 		if (it != _modInfos.end())
 		{
 			const ModInfo &masterInfo = it->second;
-			_loadMod(masterInfo, circDepCheck);
+			_loadMod(masterInfo, circDepCheck, dirs);
 		}
 		else
 		{
@@ -748,6 +809,7 @@ void mapResources()
 	FileMap::clear();
 
 	std::string curMaster = getActiveMaster();
+	std::vector<ModResourceDir> dirs;
 	for (std::vector< std::pair<std::string, bool> >::reverse_iterator i = mods.rbegin(); i != mods.rend(); ++i)
 	{
 		if (!i->second)
@@ -764,10 +826,25 @@ void mapResources()
 		}
 
 		std::set<std::string> circDepCheck;
-		_loadMod(modInfo, circDepCheck);
+		_loadMod(modInfo, circDepCheck, dirs);
 	}
 	// TODO: Figure out why we still need to check common here
-	FileMap::load("common", CrossPlatform::searchDataFolder("common"), true);
+	ModResourceDir commonDir = { "common", CrossPlatform::searchDataFolder("common"), true };
+	dirs.push_back(commonDir);
+
+	// read all directory trees at once, then map them in order of priority
+	std::vector<std::string> paths;
+	for (std::vector<ModResourceDir>::const_iterator i = dirs.begin(); i != dirs.end(); ++i)
+	{
+		paths.push_back(i->path);
+	}
+	FileMap::loadListings(_userFolder + "listings.dat");
+	FileMap::scan(paths);
+	FileMap::saveListings(_userFolder + "listings.dat");
+	for (std::vector<ModResourceDir>::const_iterator i = dirs.begin(); i != dirs.end(); ++i)
+	{
+		FileMap::load(i->modId, i->path, i->ignoreMods);
+	}
 	Log(LOG_INFO) << "Resources files mapped successfully.";
 }
 
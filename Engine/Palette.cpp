@@ -19,6 +19,7 @@
 #include "Palette.h"
 #include <fstream>
 #include "Exception.h"
+#include "FileMap.h"
 
 namespace OpenXcom
 {
@@ -56,18 +57,18 @@ void Palette::loadDat(const std::string &filename, int ncolors, int offset)
 	memset(_colors, 0, sizeof(SDL_Color) * _count);
 
 	// Load file and put colors in palette
-	std::ifstream palFile (filename.c_str(), std::ios::in | std::ios::binary);
-	if (!palFile)
+	std::unique_ptr<std::istream> palFile = FileMap::openFile(filename);
+	if (!*palFile)
 	{
 		throw Exception(filename + " not found");
 	}
 
 	// Move pointer to proper palette
-	palFile.seekg(offset, std::ios::beg);
+	palFile->seekg(offset, std::ios::beg);
 
 	Uint8 value[3];
 
-	for (int i = 0; i < _count && palFile.read((char*)value, 3); ++i)
+	for (int i = 0; i < _count && palFile->read((char*)value, 3); ++i)
 	{
 		// Correct X-Com colors to RGB colors
 		_colors[i].r = value[0] * 4;
@@ -76,8 +77,6 @@ void Palette::loadDat(const std::string &filename, int ncolors, int offset)
 		_colors[i].unused = 255;
 	}
 	_colors[0].unused = 0;
-
-	palFile.close();
 }
 
 /**
@@ -105,7 +105,7 @@ void Screen::makeVideoFlags()
  * Initializes a new display screen for the game to render contents to.
  * The screen is set up based on the current options.
  */
-Screen::Screen() : _baseWidth(ORIGINAL_WIDTH), _baseHeight(ORIGINAL_HEIGHT), _scaleX(1.0), _scaleY(1.0), _flags(0), _numColors(0), _firstColor(0), _pushPalette(false), _surface(0)
+Screen::Screen() : _baseWidth(ORIGINAL_WIDTH), _baseHeight(ORIGINAL_HEIGHT), _scaleX(1.0), _scaleY(1.0), _flags(0), _numColors(0), _firstColor(0), _pushPalette(false), _surface(0), _zoomBuffer(0), _fullRedraw(true)
 {
 	resetDisplay();
 	memset(deferredPalette, 0, 256*sizeof(SDL_Color));
@@ -118,6 +118,7 @@ Screen::Screen() : _baseWidth(ORIGINAL_WIDTH), _baseHeight(ORIGINAL_HEIGHT), _sc
 Screen::~Screen()
 {
 	delete _surface;
+	SDL_FreeSurface(_zoomBuffer);
 }
 
 /**
@@ -172,18 +173,100 @@ void Screen::handle(Action *action)
 }
 
 
+/**
+ * Compares the buffer against the last frame put on screen and
+ * works out the smallest rectangle covering every changed pixel.
+ * The copy of the last frame is brought up to date in the process.
+ * @param rect Pointer to the rectangle to fill with the changed area.
+ * @return True if anything changed since the last flip.
+ */
+bool Screen::getDamage(SDL_Rect *rect)
+{
+	SDL_Surface *s = _surface->getSurface();
+	const size_t pitch = s->pitch;
+	const size_t bpp = s->format->BytesPerPixel;
+	const size_t rowBytes = s->w * bpp;
+	const Uint8 *pixels = (const Uint8*)s->pixels;
+
+	if (_lastFrame.size() != pitch * s->h)
+	{
+		_lastFrame.assign(pixels, pixels + pitch * s->h);
+		rect->x = 0;
+		rect->y = 0;
+		rect->w = s->w;
+		rect->h = s->h;
+		return true;
+	}
+
+	int top = s->h, bottom = -1;
+	size_t left = rowBytes, right = 0;
+	for (int y = 0; y < s->h; ++y)
+	{
+		const Uint8 *now = pixels + y * pitch;
+		Uint8 *last = &_lastFrame[y * pitch];
+		if (memcmp(now, last, rowBytes) == 0)
+		{
+			continue;
+		}
+		size_t l = 0, r = rowBytes;
+		while (now[l] == last[l])
+		{
+			++l;
+		}
+		while (now[r - 1] == last[r - 1])
+		{
+			--r;
+		}
+		memcpy(last + l, now + l, r - l);
+		left = std::min(left, l);
+		right = std::max(right, r);
+		top = std::min(top, y);
+		bottom = y;
+	}
+
+	if (bottom < 0)
+	{
+		return false;
+	}
+	rect->x = left / bpp;
+	rect->y = top;
+	rect->w = (right + bpp - 1) / bpp - rect->x;
+	rect->h = bottom - top + 1;
+	return true;
+}
+
 /**
  * Renders the buffer's contents onto the screen, applying
  * any necessary filters or conversions in the process.
  * If the scaling factor is bigger than 1, the entire contents
  * of the buffer are resized by that factor (eg. 2 = doubled)
  * before being put on screen.
+ * Frames identical to the last one are skipped entirely, and
+ * unscaled software displays only update the changed area.
  */
 void Screen::flip()
 {
+	SDL_Rect damage;
+	if (!getDamage(&damage) && !_fullRedraw)
+	{
+		// the window is still showing this exact frame
+		return;
+	}
+
+	bool partial = false;
 	if (getWidth() != _baseWidth || getHeight() != _baseHeight || isOpenGLEnabled())
 	{
-		Zoom::flipWithZoom(_surface->getSurface(), _screen, _topBlackBand, _bottomBlackBand, _leftBlackBand, _rightBlackBand, &glOutput);
+		// the scalers don't touch the black bands, so wipe them first
+		if (_screen->flags & SDL_SWSURFACE) memset(_screen->pixels, 0, _screen->h*_screen->pitch);
+		else SDL_FillRect(_screen, &_clear, 0);
+		Zoom::flipWithZoom(_surface->getSurface(), _screen, _topBlackBand, _bottomBlackBand, _leftBlackBand, _rightBlackBand, &glOutput, _zoomBuffer);
+	}
+	else if (!_fullRedraw && !(_screen->flags & SDL_HWSURFACE))
+	{
+		// software display: the rest of the window already holds the right pixels
+		SDL_Rect target = damage;
+		SDL_BlitSurface(_surface->getSurface(), &damage, _screen, &target);
+		partial = true;
 	}
 	else
 	{
@@ -201,12 +284,15 @@ void Screen::flip()
 		_pushPalette = false;
 	}
 
-
-	
-	if (SDL_Flip(_screen) == -1)
+	if (partial)
+	{
+		SDL_UpdateRect(_screen, damage.x, damage.y, damage.w, damage.h);
+	}
+	else if (SDL_Flip(_screen) == -1)
 	{
 		throw Exception(SDL_GetError());
 	}
+	_fullRedraw = false;
 }
 
 /**
@@ -215,8 +301,16 @@ void Screen::flip()
 void Screen::clear()
 {
 	_surface->clear();
-	if (_screen->flags & SDL_SWSURFACE) memset(_screen->pixels, 0, _screen->h*_screen->pitch);
-	else SDL_FillRect(_screen, &_clear, 0);
+}
+
+/**
+ * Forces the next flip to redraw the whole window, even
+ * if the buffer contents haven't changed (eg. when the
+ * window contents were lost or the palette was changed).
+ */
+void Screen::invalidate()
+{
+	_fullRedraw = true;
 }
 
 /**
@@ -243,6 +337,7 @@ void Screen::setPalette(SDL_Color* colors, int firstcolor, int ncolors, bool imm
 	}
 
 	_surface->setPalette(colors, firstcolor, ncolors);
+	_fullRedraw = true;
 
 	// defer actual update of screen until SDL_Flip()
 	if (immediately && _screen->format->BitsPerPixel == 8 && SDL_SetColors(_screen, colors, firstcolor, ncolors) == 0)
@@ -318,6 +413,9 @@ void Screen::resetDisplay(bool resetVideo)
 		if (_surface->getSurface()->format->BitsPerPixel == 8) _surface->setPalette(deferredPalette);
 	}
 	SDL_SetColorKey(_surface->getSurface(), 0, 0); // turn off color key! 
+	// letterbox buffer matches the old display mode, it is created again on next flip
+	SDL_FreeSurface(_zoomBuffer);
+	_zoomBuffer = 0;
 
 	if (resetVideo || _screen->format->BitsPerPixel != _bpp)
 	{
@@ -359,6 +457,7 @@ void Screen::resetDisplay(bool resetVideo)
 	{
 		clear();
 	}
+	_fullRedraw = true;
 
 	Options::displayWidth = getWidth();
 	Options::displayHeight = getHeight();
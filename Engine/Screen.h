@@ -19,6 +19,7 @@
  */
 #include <SDL.h>
 #include <string>
+#include <vector>
 #include "OpenGL.h"
 
 namespace OpenXcom
@@ -49,9 +50,14 @@ private:
 	bool _pushPalette;
 	OpenGL glOutput;
 	Surface *_surface;
+	SDL_Surface *_zoomBuffer;
 	SDL_Rect _clear;
+	std::vector<Uint8> _lastFrame;
+	bool _fullRedraw;
 	/// Sets the _flags and _bpp variables based on game options; needed in more than one place now
 	void makeVideoFlags();
+	/// Gets the area of the buffer changed since the last flip.
+	bool getDamage(SDL_Rect *rect);
 public:
 	static const int ORIGINAL_WIDTH;
 	static const int ORIGINAL_HEIGHT;
@@ -72,6 +78,8 @@ public:
 	void flip();
 	/// Clears the screen.
 	void clear();
+	/// Forces the whole screen to be redrawn on the next flip.
+	void invalidate();
 	/// Sets the screen's 8bpp palette.
 	void setPalette(SDL_Color *colors, int firstcolor = 0, int ncolors = 256, bool immediately = false);
 	/// Gets the screen's 8bpp palette.
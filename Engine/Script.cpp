@@ -21,6 +21,7 @@
 #include <iomanip>
 #include <tuple>
 #include <algorithm>
+#include <chrono>
 
 #include "Logger.h"
 #include "Options.h"
@@ -61,6 +62,17 @@ namespace OpenXcom
 	MACRO_COPY_64(Func, (Pos) + 0x80) \
 	MACRO_COPY_64(Func, (Pos) + 0xC0)
 
+#define MACRO_HEX_16(Func, Hex) \
+	Func(Hex##0) Func(Hex##1) Func(Hex##2) Func(Hex##3) \
+	Func(Hex##4) Func(Hex##5) Func(Hex##6) Func(Hex##7) \
+	Func(Hex##8) Func(Hex##9) Func(Hex##A) Func(Hex##B) \
+	Func(Hex##C) Func(Hex##D) Func(Hex##E) Func(Hex##F)
+#define MACRO_HEX_256(Func) \
+	MACRO_HEX_16(Func, 0x0) MACRO_HEX_16(Func, 0x1) MACRO_HEX_16(Func, 0x2) MACRO_HEX_16(Func, 0x3) \
+	MACRO_HEX_16(Func, 0x4) MACRO_HEX_16(Func, 0x5) MACRO_HEX_16(Func, 0x6) MACRO_HEX_16(Func, 0x7) \
+	MACRO_HEX_16(Func, 0x8) MACRO_HEX_16(Func, 0x9) MACRO_HEX_16(Func, 0xA) MACRO_HEX_16(Func, 0xB) \
+	MACRO_HEX_16(Func, 0xC) MACRO_HEX_16(Func, 0xD) MACRO_HEX_16(Func, 0xE) MACRO_HEX_16(Func, 0xF)
+
 
 ////////////////////////////////////////////////////////////
 //						proc definition
@@ -225,6 +237,15 @@ static inline RetEnum debug_log_h(ProgPos& p, int i, int j)
 	\
 	IMPL(debug_log,		MACRO_QUOTE({ return debug_log_h(p, Data1, Data2);								}),		(ProgPos& p, int Data1, int Data2),		"Display debug informations") \
 
+/**
+ * Macro defining operations created only by optimizer from sequences of other operations.
+ * They are not available by name in scripts.
+ * @param IMPL macro function that access data. Take same args as in MACRO_PROC_DEFINITION.
+ */
+#define MACRO_PROC_FUSED_DEFINITION(IMPL) \
+	/*	Name,		Implementation,													End excecution,				Args,					Description */ \
+	IMPL(set_exit,	MACRO_QUOTE({ Reg0 = Data1;										return RetEnd;		}),		(ScriptWorkerBase& c, int& Reg0, int Data1),	"set followed by exit") \
+
 
 ////////////////////////////////////////////////////////////
 //					function definition
@@ -250,6 +271,7 @@ namespace
 	};
 
 MACRO_PROC_DEFINITION(MACRO_CREATE_FUNC)
+MACRO_PROC_FUSED_DEFINITION(MACRO_CREATE_FUNC)
 
 #undef MACRO_CREATE_FUNC
 
@@ -288,31 +310,46 @@ struct Func_test_eq_null
 enum ProcEnum : Uint8
 {
 	MACRO_PROC_DEFINITION(MACRO_CREATE_PROC_ENUM)
+	MACRO_PROC_FUSED_DEFINITION(MACRO_CREATE_PROC_ENUM)
 	Proc_EnumMax,
 };
 
 #undef MACRO_CREATE_PROC_ENUM
 
+/**
+ * Macro used for creating list of all version of all operations.
+ */
+#define MACRO_FUNC_ARRAY(NAME, ...) + helper::FuncGroup<MACRO_FUNC_ID(NAME)>::FuncList{}
+
+/**
+ * List of all operations, position on it is equal to operation id.
+ */
+using ProcFuncList = decltype(MACRO_PROC_DEFINITION(MACRO_FUNC_ARRAY) MACRO_PROC_FUSED_DEFINITION(MACRO_FUNC_ARRAY));
+
+#undef MACRO_FUNC_ARRAY
+
 ////////////////////////////////////////////////////////////
 //					core loop function
 ////////////////////////////////////////////////////////////
 
 /**
  * Core function in script engine used to executing scripts
+ * @tparam Profile if true then number of executed operations is added to `ops`.
  * @param proc array storing operation of script
+ * @param ops counter of executed operations.
  * @return Result of executing script
  */
-static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc)
+template<bool Profile>
+static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc, Uint64& ops)
 {
 	ProgPos curr = ProgPos::Start;
 	//--------------------------------------------------
 	//			helper macros for this function
 	//--------------------------------------------------
-	#define MACRO_FUNC_ARRAY(NAME, ...) + helper::FuncGroup<MACRO_FUNC_ID(NAME)>::FuncList{}
-	#define MACRO_FUNC_ARRAY_LOOP(POS) \
-		case (POS): \
+	#define MACRO_FUNC_ARRAY_BODY(POS) \
 		{ \
-			using currType = helper::GetType<func, POS>; \
+			using currType = helper::GetType<ProcFuncList, POS>; \
+			if (Profile) ++ops; \
 			const auto p = proc + (int)curr; \
 			curr += currType::offset; \
 			const auto ret = currType::func(data, p, curr); \
@@ -326,12 +363,33 @@ static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc)
 					goto errorLabel; \
 				} \
 			} \
-			else \
-				continue; \
 		}
 	//--------------------------------------------------
 
-	using func = decltype(MACRO_PROC_DEFINITION(MACRO_FUNC_ARRAY));
+#if defined(__GNUC__) || defined(__clang__)
+	// direct threaded code, every operation jump to next one by itself,
+	// this give CPU separate branch prediction for each operation.
+	#define MACRO_FUNC_ARRAY_ADDRESS(POS) &&op_##POS,
+	#define MACRO_FUNC_ARRAY_LOOP(POS) \
+		op_##POS: \
+		MACRO_FUNC_ARRAY_BODY(POS) \
+		goto *jumpTable[proc[(int)curr++]];
+
+	static const void* const jumpTable[256] =
+	{
+		MACRO_HEX_256(MACRO_FUNC_ARRAY_ADDRESS)
+	};
+
+	goto *jumpTable[proc[(int)curr++]];
+
+	MACRO_HEX_256(MACRO_FUNC_ARRAY_LOOP)
+
+	#undef MACRO_FUNC_ARRAY_ADDRESS
+#else
+	#define MACRO_FUNC_ARRAY_LOOP(POS) \
+		case (POS): \
+		MACRO_FUNC_ARRAY_BODY(POS) \
+		continue;
 
 	while (true)
 	{
@@ -340,12 +398,13 @@ static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc)
 		MACRO_COPY_256(MACRO_FUNC_ARRAY_LOOP, 0)
 		}
 	}
+#endif
 
 	//--------------------------------------------------
 	//			removing helper macros
 	//--------------------------------------------------
 	#undef MACRO_FUNC_ARRAY_LOOP
-	#undef MACRO_FUNC_ARRAY
+	#undef MACRO_FUNC_ARRAY_BODY
 	//--------------------------------------------------
 
 	errorLabel:
@@ -359,6 +418,26 @@ static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc)
 	return;
 }
 
+/**
+ * Version of script core function that count executed operations.
+ * It is not inlined to not bloat every place where scripts are called.
+ */
+[[gnu::noinline]]
+static void scriptExeCount(ScriptWorkerBase& data, const Uint8* proc, Uint64& ops)
+{
+	scriptExe<true>(data, proc, ops);
+}
+
+/**
+ * Add time from given point to statistics of script.
+ * @param profile statistics of script.
+ * @param start time when script was started.
+ */
+static void scriptAddTime(ScriptProfileData& profile, std::chrono::steady_clock::time_point start)
+{
+	profile.time += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
 
 ////////////////////////////////////////////////////////////
 //						Script class
@@ -382,6 +461,14 @@ void ScriptWorkerBlit::executeBlit(Surface* src, Surface* dest, int x, int y, in
 	}
 	if (_proc)
 	{
+		// with profiling time is measured for whole sprite, not for every pixel.
+		ScriptProfileData* profile = Options::scriptProfiling ? _profile : nullptr;
+		std::chrono::steady_clock::time_point start;
+		if (profile)
+		{
+			start = std::chrono::steady_clock::now();
+		}
+		Uint64 ops = 0;
 		ShaderDrawFunc(
 			[&](Uint8& dest, const Uint8& src)
 			{
@@ -389,7 +476,15 @@ void ScriptWorkerBlit::executeBlit(Surface* src, Surface* dest, int x, int y, in
 				{
 					ScriptWorkerBlit::Output arg = { src, dest };
 					set(arg);
-					scriptExe(*this, _proc);
+					if (profile)
+					{
+						scriptExeCount(*this, _proc, profile->ops);
+						++profile->calls;
+					}
+					else
+					{
+						scriptExe<false>(*this, _proc, ops);
+					}
 					get(arg);
 					if (arg.getFirst()) dest = arg.getFirst();
 				}
@@ -397,20 +492,37 @@ void ScriptWorkerBlit::executeBlit(Surface* src, Surface* dest, int x, int y, in
 			ShaderSurface(dest, 0, 0),
 			srcShader
 		);
+		if (profile)
+		{
+			scriptAddTime(*profile, start);
+		}
 	}
 	else
-		ShaderDraw<helper::StandardShade>(ShaderSurface(dest, 0, 0), srcShader, ShaderScalar(shade));
+		ShaderDrawRow<helper::StandardShade>(ShaderSurface(dest, 0, 0), srcShader, ShaderScalar(shade));
 }
 
 /**
  * Execute script with two arguments.
- * @return Result value from script.
+ * @param c script to run.
  */
-void ScriptWorkerBase::executeBase(const Uint8* proc)
+void ScriptWorkerBase::executeBase(const ScriptContainerBase& c)
 {
+	const Uint8* proc = c.data();
 	if (proc)
 	{
-		scriptExe(*this, proc);
+		ScriptProfileData* profile = c.getProfile();
+		if (profile && Options::scriptProfiling)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			scriptExeCount(*this, proc, profile->ops);
+			++profile->calls;
+			scriptAddTime(*profile, start);
+		}
+		else
+		{
+			Uint64 ops = 0;
+			scriptExe<false>(*this, proc, ops);
+		}
 	}
 }
 
@@ -421,6 +533,141 @@ void ScriptWorkerBase::executeBase(const Uint8* proc)
 namespace
 {
 
+/**
+ * Get size of operation in proc vector, including its id.
+ */
+size_t getProcSize(Uint8 procId)
+{
+	#define MACRO_PROC_SIZE(POS) 1 + helper::GetType<ProcFuncList, POS>::offset,
+	static const Uint8 sizes[256] =
+	{
+		MACRO_COPY_256(MACRO_PROC_SIZE, 0)
+	};
+	#undef MACRO_PROC_SIZE
+	return sizes[procId];
+}
+
+/**
+ * Count operations in script code.
+ */
+size_t countProcOps(const std::vector<Uint8>& proc)
+{
+	size_t count = 0;
+	for (size_t pos = 0; pos < proc.size(); pos += getProcSize(proc[pos]))
+	{
+		++count;
+	}
+	return count;
+}
+
+/**
+ * Position of arguments of one version of `test_eq` or `test_le` operation.
+ */
+struct ProcTestLayout
+{
+	bool constA, constB;
+	size_t offsetA, offsetB, offsetTrue, offsetFalse;
+};
+
+/**
+ * Create layout of given version of `test_eq` or `test_le` operation.
+ */
+template<typename Func, int Ver>
+ProcTestLayout createTestLayout()
+{
+	using args = helper::GetArgs<Func>;
+	using curr = helper::FuncVer<Func, Ver>;
+	return ProcTestLayout
+	{
+		std::is_same<typename curr::template GetTypeAt<1>, helper::ArgValueDef<int>>::value,
+		std::is_same<typename curr::template GetTypeAt<2>, helper::ArgValueDef<int>>::value,
+		1 + (size_t)args::offset(Ver, 1),
+		1 + (size_t)args::offset(Ver, 2),
+		1 + (size_t)args::offset(Ver, 3),
+		1 + (size_t)args::offset(Ver, 4),
+	};
+}
+
+/**
+ * Get layout of condition operation.
+ * @param procId Id of operation.
+ * @param layout Position of arguments.
+ * @param equal Set to true if operation test for equality.
+ * @return True if operation is `test_eq` or `test_le`.
+ */
+bool getTestLayout(Uint8 procId, ProcTestLayout& layout, bool& equal)
+{
+	static_assert(helper::FuncGroup<Func_test_le>::ver() == 4, "Invalid number of versions");
+	static_assert(helper::FuncGroup<Func_test_eq>::ver() == 4, "Invalid number of versions");
+	static const ProcTestLayout testLe[4] =
+	{
+		createTestLayout<Func_test_le, 0>(), createTestLayout<Func_test_le, 1>(),
+		createTestLayout<Func_test_le, 2>(), createTestLayout<Func_test_le, 3>(),
+	};
+	static const ProcTestLayout testEq[4] =
+	{
+		createTestLayout<Func_test_eq, 0>(), createTestLayout<Func_test_eq, 1>(),
+		createTestLayout<Func_test_eq, 2>(), createTestLayout<Func_test_eq, 3>(),
+	};
+
+	if (procId >= Proc_test_le && procId <= Proc_test_le_end)
+	{
+		layout = testLe[procId - Proc_test_le];
+		equal = false;
+		return true;
+	}
+	if (procId >= Proc_test_eq && procId <= Proc_test_eq_end)
+	{
+		layout = testEq[procId - Proc_test_eq];
+		equal = true;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * One operation of script in optimizer.
+ */
+struct OptimizerOp
+{
+	/// Id and arguments of operation.
+	std::vector<Uint8> code;
+	/// Offsets in code of label arguments and used label indexes.
+	std::vector<std::pair<size_t, int>> labels;
+	/// Operation is still part of script.
+	bool keep;
+
+	/// Get label index used by argument at given offset.
+	int getLabel(size_t offset) const
+	{
+		for (auto& l : labels)
+		{
+			if (l.first == offset)
+			{
+				return l.second;
+			}
+		}
+		return -1;
+	}
+
+	/// Replace operation by unconditional jump to label.
+	void setGoto(int label)
+	{
+		static_assert(helper::FuncGroup<Func_goto>::ver() == 1, "Invalid number of versions");
+		static_assert(helper::GetType<ProcFuncList, Proc_goto>::offset == sizeof(ProgPos), "Invalid size of goto");
+		code.assign(1 + sizeof(ProgPos), 0);
+		code[0] = Proc_goto;
+		labels.assign(1, std::make_pair(size_t{ 1 }, label));
+	}
+
+	/// Replace operation by end of script.
+	void setExit()
+	{
+		code.assign(1, Proc_exit);
+		labels.clear();
+	}
+};
+
 /**
  * Test for validaty of arguments.
  */
@@ -1444,12 +1691,199 @@ ParserWriter::ParserWriter(
 void ParserWriter::relese()
 {
 	pushProc(Proc_exit);
+	optimize();
 	for (auto& p : refLabelsUses)
 	{
 		updateReserved<ProgPos>(p.first, refLabelsList[p.second]);
 	}
 }
 
+/**
+ * Simplify script code before writing labels to it.
+ * Conditions with constant arguments are replaced by jumps, jumps to other jumps
+ * or to end of script are shortcut, some sequences of operations are fused together
+ * and unreachable operations or jumps to next operation are removed.
+ */
+void ParserWriter::optimize()
+{
+	auto& proc = container._proc;
+
+	// split code into separate operations
+	std::vector<OptimizerOp> ops;
+	std::vector<int> opIndex(proc.size(), -1);
+	for (size_t pos = 0; pos < proc.size(); )
+	{
+		const Uint8 procId = proc[pos];
+		const size_t size = getProcSize(procId);
+		if (procId >= Proc_EnumMax || pos + size > proc.size())
+		{
+			return;
+		}
+		opIndex[pos] = ops.size();
+		ops.push_back(OptimizerOp{ std::vector<Uint8>(proc.begin() + pos, proc.begin() + pos + size), { }, true });
+		pos += size;
+	}
+	if (ops.empty())
+	{
+		return;
+	}
+	for (auto& use : refLabelsUses)
+	{
+		const size_t pos = static_cast<size_t>(use.first.getPos());
+		size_t begin = pos;
+		while (opIndex[begin] == -1)
+		{
+			--begin;
+		}
+		ops[opIndex[begin]].labels.push_back(std::make_pair(pos - begin, use.second));
+	}
+
+	// index of operation where label point to
+	std::vector<int> labelTarget(refLabelsList.size(), -1);
+	for (size_t i = 0; i < refLabelsList.size(); ++i)
+	{
+		const size_t pos = static_cast<size_t>(refLabelsList[i]);
+		if (pos < proc.size())
+		{
+			labelTarget[i] = opIndex[pos];
+		}
+	}
+	for (auto& use : refLabelsUses)
+	{
+		if (labelTarget[use.second] == -1)
+		{
+			return;
+		}
+	}
+
+	// fold conditions
+	for (auto& op : ops)
+	{
+		ProcTestLayout layout;
+		bool equal = false;
+		if (getTestLayout(op.code[0], layout, equal) && layout.constA && layout.constB)
+		{
+			int a = 0, b = 0;
+			memcpy(&a, &op.code[layout.offsetA], sizeof(int));
+			memcpy(&b, &op.code[layout.offsetB], sizeof(int));
+			const auto label = op.getLabel((equal ? a == b : a <= b) ? layout.offsetTrue : layout.offsetFalse);
+			if (label != -1)
+			{
+				op.setGoto(label);
+			}
+		}
+	}
+
+	// jump threading
+	for (auto& target : labelTarget)
+	{
+		for (size_t i = 0; target != -1 && i < ops.size() && ops[target].code[0] == Proc_goto; ++i)
+		{
+			target = labelTarget[ops[target].labels[0].second];
+		}
+	}
+	for (auto& op : ops)
+	{
+		if (op.code[0] == Proc_goto && ops[labelTarget[op.labels[0].second]].code[0] == Proc_exit)
+		{
+			op.setExit();
+		}
+	}
+
+	// fuse operations
+	static_assert(helper::FuncGroup<Func_set>::ver() == helper::FuncGroup<Func_set_exit>::ver(), "Invalid number of versions");
+	for (size_t i = 0; i + 1 < ops.size(); ++i)
+	{
+		auto& op = ops[i];
+		if (op.code[0] >= Proc_set && op.code[0] <= Proc_set_end && ops[i + 1].code[0] == Proc_exit)
+		{
+			op.code[0] += Proc_set_exit - Proc_set;
+		}
+	}
+
+	// remove unreachable operations
+	for (auto& op : ops)
+	{
+		op.keep = false;
+	}
+	std::vector<int> todo = { 0 };
+	while (!todo.empty())
+	{
+		const int i = todo.back();
+		todo.pop_back();
+		auto& op = ops[i];
+		if (op.keep)
+		{
+			continue;
+		}
+		op.keep = true;
+
+		const Uint8 procId = op.code[0];
+		ProcTestLayout layout;
+		bool equal = false;
+		const bool end = procId == Proc_exit || (procId >= Proc_set_exit && procId <= Proc_set_exit_end);
+		const bool jump = procId == Proc_goto || getTestLayout(procId, layout, equal);
+		if (!end && !jump && i + 1 < (int)ops.size())
+		{
+			todo.push_back(i + 1);
+		}
+		for (auto& l : op.labels)
+		{
+			todo.push_back(labelTarget[l.second]);
+		}
+	}
+
+	// remove jumps to next operation
+	int next = ops.size();
+	for (int i = ops.size() - 1; i >= 0; --i)
+	{
+		auto& op = ops[i];
+		if (!op.keep)
+		{
+			continue;
+		}
+		if (op.code[0] == Proc_goto)
+		{
+			int target = labelTarget[op.labels[0].second];
+			while (target < (int)ops.size() && !ops[target].keep)
+			{
+				++target;
+			}
+			if (target == next)
+			{
+				op.keep = false;
+				continue;
+			}
+		}
+		next = i;
+	}
+
+	// create new code
+	std::vector<size_t> newPos(ops.size());
+	proc.clear();
+	refLabelsUses.clear();
+	for (size_t i = 0; i < ops.size(); ++i)
+	{
+		auto& op = ops[i];
+		newPos[i] = proc.size();
+		if (op.keep)
+		{
+			for (auto& l : op.labels)
+			{
+				refLabelsUses.push_back(std::make_pair(ReservedPos<ProgPos>{ static_cast<ProgPos>(proc.size() + l.first) }, l.second));
+			}
+			proc.insert(proc.end(), op.code.begin(), op.code.end());
+		}
+	}
+	for (size_t i = 0; i < refLabelsList.size(); ++i)
+	{
+		if (labelTarget[i] != -1)
+		{
+			refLabelsList[i] = static_cast<ProgPos>(newPos[labelTarget[i]]);
+		}
+	}
+}
+
 /**
  * Returns reference based on name.
  * @param s name of referece.
@@ -2060,6 +2494,10 @@ bool ScriptParserBase::parseBase(ScriptContainerBase& destScript, const std::str
 				Log(LOG_ERROR) << err << "script need to end with return statement";
 			}
 			help.relese();
+			if (_shared)
+			{
+				tempScript._profile = _shared->addProfile(_name, parentName, countProcOps(tempScript._proc));
+			}
 			destScript = std::move(tempScript);
 			return true;
 		}
@@ -2299,6 +2737,23 @@ void ScriptParserBase::logScriptMetadata(bool haveEvents) const
 				refLog.get(LOG_DEBUG) << "Name: " << std::setw(40) << r.name.toString() << std::setw(9) << getTypePrefix(r.type) << " " << std::setw(9) << argType(r.type) << "\n";
 			}
 		}
+		if (_shared)
+		{
+			bool first = true;
+			for (auto& p : _shared->getProfiles())
+			{
+				if (p->hook == _name)
+				{
+					if (first)
+					{
+						refLog.get(LOG_DEBUG) << "\n";
+						refLog.get(LOG_DEBUG) << "Loaded scripts:\n";
+						first = false;
+					}
+					refLog.get(LOG_DEBUG) << "Name: " << std::setw(40) << p->name << "Mod: " << std::setw(20) << p->mod << "Ops: " << p->staticOps << "\n";
+				}
+			}
+		}
 		if (Logger::reportingLevel() != LOG_VERBOSE)
 		{
 			refLog.get(LOG_DEBUG) << "To see const values and custom operations use 'verboseLogging'\n";
@@ -2624,7 +3079,6 @@ ScriptRef ScriptGlobal::addNameRef(const std::string& s)
  */
 void ScriptGlobal::pushParser(ScriptParserBase* parser)
 {
-	parser->logScriptMetadata(false);
 	_parserNames.insert(std::make_pair(parser->getName(), parser));
 }
 
@@ -2633,7 +3087,6 @@ void ScriptGlobal::pushParser(ScriptParserBase* parser)
  */
 void ScriptGlobal::pushParser(ScriptParserEventsBase* parser)
 {
-	parser->logScriptMetadata(true);
 	_parserNames.insert(std::make_pair(parser->getName(), parser));
 	_parserEvents.push_back(parser);
 }
@@ -2668,6 +3121,85 @@ const ScriptRefData* ScriptGlobal::getRef(ScriptRef name, ScriptRef postfix) con
 	return findSortHelper(_refList, name, postfix);
 }
 
+/**
+ * Set name of mod that is currently loaded, it is used by statistics of scripts.
+ * @param name Name of mod.
+ */
+void ScriptGlobal::setModName(const std::string& name)
+{
+	_modName = name;
+}
+
+/**
+ * Add statistics of new script.
+ * @param hook Name of parser that script belongs to.
+ * @param name Name of rule that own script.
+ * @param staticOps Number of operations in script.
+ * @return Statistics of script.
+ */
+ScriptProfileData* ScriptGlobal::addProfile(const std::string& hook, const std::string& name, size_t staticOps)
+{
+	_profiles.push_back(std::unique_ptr<ScriptProfileData>(new ScriptProfileData{ _modName, hook, name, staticOps, 0, 0, 0 }));
+	return _profiles.back().get();
+}
+
+/**
+ * Reset counters of all scripts.
+ */
+void ScriptGlobal::resetProfiles()
+{
+	for (auto& p : _profiles)
+	{
+		p->calls = 0;
+		p->ops = 0;
+		p->time = 0;
+	}
+}
+
+/**
+ * Get report of scripts that used most time.
+ * @param maxScripts Max number of scripts in report.
+ * @return Text of report.
+ */
+std::string ScriptGlobal::getProfileReport(size_t maxScripts) const
+{
+	std::vector<const ScriptProfileData*> list;
+	for (auto& p : _profiles)
+	{
+		if (p->calls)
+		{
+			list.push_back(p.get());
+		}
+	}
+	std::sort(list.begin(), list.end(),
+		[](const ScriptProfileData* a, const ScriptProfileData* b)
+		{
+			return a->time > b->time;
+		}
+	);
+
+	std::ostringstream ss;
+	if (list.empty())
+	{
+		ss << "No scripts were run";
+	}
+	for (size_t i = 0; i < list.size() && i < maxScripts; ++i)
+	{
+		auto& p = *list[i];
+		ss << p.mod << " " << p.hook << " " << p.name << "\n";
+		ss << "  calls: " << p.calls << " ops: " << p.ops << " (" << p.staticOps << " in code) time: " << p.time / 1000 << "us\n";
+	}
+	return ss.str();
+}
+
+/**
+ * Log statistics of all scripts that were run.
+ */
+void ScriptGlobal::logProfiles() const
+{
+	Log(LOG_INFO) << "Script profile:\n" << getProfileReport(_profiles.size());
+}
+
 /**
  * Prepare for loading data.
  */
@@ -2681,6 +3213,12 @@ void ScriptGlobal::beginLoad()
  */
 void ScriptGlobal::endLoad()
 {
+	// log it after loading, this way all scripts are already parsed.
+	for (auto& p : _parserNames)
+	{
+		const bool haveEvents = std::find(_parserEvents.begin(), _parserEvents.end(), p.second) != _parserEvents.end();
+		p.second->logScriptMetadata(haveEvents);
+	}
 	for (auto& p : _parserEvents)
 	{
 		_events.push_back(p->releseEvents());
@@ -23,6 +23,7 @@
 #include <limits>
 #include <vector>
 #include <string>
+#include <memory>
 #include <yaml-cpp/yaml.h>
 #include <SDL_stdinc.h>
 
@@ -230,13 +231,36 @@ enum RetEnum : Uint8
 
 using FuncCommon = RetEnum (*)(ScriptWorkerBase&, const Uint8*, ProgPos&);
 
+/**
+ * Statistics of one script, counters are updated only when `scriptProfiling` option is enabled.
+ */
+struct ScriptProfileData
+{
+	/// Name of mod that defined script.
+	std::string mod;
+	/// Name of hook where script is used.
+	std::string hook;
+	/// Name of rule that own script.
+	std::string name;
+	/// Number of operations in script code.
+	size_t staticOps;
+	/// Number of script executions.
+	Uint64 calls;
+	/// Number of executed operations.
+	Uint64 ops;
+	/// Time used by script in nanoseconds.
+	Uint64 time;
+};
+
 /**
  * Common base of script execution.
  */
 class ScriptContainerBase
 {
 	friend class ParserWriter;
+	friend class ScriptParserBase;
 	std::vector<Uint8> _proc;
+	ScriptProfileData* _profile = nullptr;
 
 public:
 	/// Constructor.
@@ -265,6 +289,11 @@ public:
 	{
 		return *this ? _proc.data() : nullptr;
 	}
+	/// Get statistics of script.
+	ScriptProfileData* getProfile() const
+	{
+		return _profile;
+	}
 };
 
 /**
@@ -302,6 +331,11 @@ public:
 	{
 		return _current.data();
 	}
+	/// Get main script.
+	const ScriptContainerBase& script() const
+	{
+		return _current;
+	}
 	/// Get pointer to proc data.
 	const ScriptContainerBase* dataEvents() const
 	{
@@ -499,7 +533,7 @@ protected:
 	}
 
 	/// Call script.
-	void executeBase(const Uint8* proc);
+	void executeBase(const ScriptContainerBase& c);
 
 public:
 	/// Default constructor.
@@ -551,7 +585,7 @@ public:
 		static_assert(std::is_same<typename Parent::Output, Output>::value, "Incompatible script output type");
 
 		set(arg);
-		executeBase(c.data());
+		executeBase(c);
 		get(arg);
 	}
 
@@ -568,19 +602,19 @@ public:
 			while (*ptr)
 			{
 				reset(arg);
-				executeBase(ptr->data());
+				executeBase(*ptr);
 				++ptr;
 			}
 			++ptr;
 		}
 		reset(arg);
-		executeBase(c.data());
+		executeBase(c.script());
 		if (ptr)
 		{
 			while (*ptr)
 			{
 				reset(arg);
-				executeBase(ptr->data());
+				executeBase(*ptr);
 				++ptr;
 			}
 		}
@@ -595,13 +629,15 @@ class ScriptWorkerBlit : public ScriptWorkerBase
 {
 	/// Current script set in worker.
 	const Uint8* _proc;
+	/// Statistics of current script.
+	ScriptProfileData* _profile;
 
 public:
 	/// Type of output value from script.
 	using Output = ScriptOutputArgs<int&, int>;
 
 	/// Default constructor.
-	ScriptWorkerBlit() : ScriptWorkerBase(), _proc(nullptr)
+	ScriptWorkerBlit() : ScriptWorkerBase(), _proc(nullptr), _profile(nullptr)
 	{
 
 	}
@@ -614,6 +650,7 @@ public:
 		if (c)
 		{
 			_proc = c.data();
+			_profile = c.getProfile();
 			updateBase<Output>(args...);
 		}
 		else
@@ -629,6 +666,7 @@ public:
 	void clear()
 	{
 		_proc = nullptr;
+		_profile = nullptr;
 	}
 };
 
@@ -1374,6 +1412,8 @@ private:
 	std::map<ArgEnum, TagData> _tagNames;
 	std::vector<TagValueType> _tagValueTypes;
 	std::vector<ScriptRefData> _refList;
+	std::string _modName;
+	std::vector<std::unique_ptr<ScriptProfileData>> _profiles;
 
 	/// Get tag value.
 	size_t getTag(ArgEnum type, ScriptRef s) const;
@@ -1407,6 +1447,19 @@ public:
 	/// Get global ref data.
 	const ScriptRefData* getRef(ScriptRef name, ScriptRef postfix = {}) const;
 
+	/// Set name of mod that is currently loaded.
+	void setModName(const std::string& name);
+	/// Add statistics of new script.
+	ScriptProfileData* addProfile(const std::string& hook, const std::string& name, size_t staticOps);
+	/// Get statistics of all scripts.
+	const std::vector<std::unique_ptr<ScriptProfileData>>& getProfiles() const { return _profiles; }
+	/// Reset counters of all scripts.
+	void resetProfiles();
+	/// Get report of most expensive scripts.
+	std::string getProfileReport(size_t maxScripts) const;
+	/// Log statistics of all executed scripts.
+	void logProfiles() const;
+
 	/// Get tag based on it name.
 	template<typename Tag>
 	Tag getTag(ScriptRef s) const
@@ -95,6 +95,8 @@ struct ParserWriter
 
 	/// Finall fixes of data.
 	void relese();
+	/// Simplify script code.
+	void optimize();
 
 	/// Get referece based on name.
 	ScriptRefData getReferece(const ScriptRef& s) const;
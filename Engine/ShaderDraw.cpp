@@ -0,0 +1,292 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ShaderDraw.h"
+#include "ShaderSimd.h"
+#include <assert.h>
+#include <string.h>
+
+namespace OpenXcom
+{
+
+namespace helper
+{
+
+namespace
+{
+
+/**
+ * Type of function that shade (and optionally recolor) one row of pixels.
+ * `color` is new color group, or negative to keep the color group of source pixel.
+ */
+typedef void (*ShadeRowFunc)(Uint8* dest, const Uint8* src, int size, int shade, int color);
+
+/**
+ * Reference implementation, every vector version need give exactly same results.
+ */
+void shadeRowScalar(Uint8* dest, const Uint8* src, int size, int shade, int color)
+{
+	if (color < 0)
+	{
+		for (int i = 0; i < size; ++i)
+		{
+			StandardShade::func(dest[i], src[i], shade);
+		}
+	}
+	else
+	{
+		for (int i = 0; i < size; ++i)
+		{
+			ColorReplace::func(dest[i], src[i], shade, color);
+		}
+	}
+}
+
+#ifdef SHADER_SIMD_X86
+
+/**
+ * SSE2 version, do 16 pixels at once.
+ * Require `shade` in range [0, 16].
+ */
+SHADER_TARGET("sse2")
+void shadeRowSSE2(Uint8* dest, const Uint8* src, int size, int shade, int color)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i shadeMask = _mm_set1_epi8(ColorShade);
+	const __m128i groupMask = _mm_set1_epi8((char)(color < 0 ? ColorGroup : 0));
+	const __m128i newGroup = _mm_set1_epi8((char)(color < 0 ? 0 : color));
+	const __m128i shadeVec = _mm_set1_epi8((char)shade);
+
+	int i = 0;
+	for (; i + 16 <= size; i += 16)
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dest + i));
+		const __m128i group = _mm_or_si128(_mm_and_si128(s, groupMask), newGroup);
+		const __m128i newShade = _mm_add_epi8(_mm_and_si128(s, shadeMask), shadeVec);
+		// pixels that would flip over to another color become black instead
+		const __m128i keep = _mm_cmpeq_epi8(_mm_subs_epu8(newShade, shadeMask), zero);
+		const __m128i shaded = _mm_or_si128(_mm_and_si128(keep, _mm_or_si128(group, newShade)), _mm_andnot_si128(keep, shadeMask));
+		// pixel 0 is transparent
+		const __m128i empty = _mm_cmpeq_epi8(s, zero);
+		_mm_storeu_si128((__m128i*)(dest + i), _mm_or_si128(_mm_and_si128(empty, d), _mm_andnot_si128(empty, shaded)));
+	}
+	shadeRowScalar(dest + i, src + i, size - i, shade, color);
+}
+
+/**
+ * AVX2 version, do 32 pixels at once.
+ * Require `shade` in range [0, 16].
+ */
+SHADER_TARGET("avx2")
+void shadeRowAVX2(Uint8* dest, const Uint8* src, int size, int shade, int color)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i shadeMask = _mm256_set1_epi8(ColorShade);
+	const __m256i groupMask = _mm256_set1_epi8((char)(color < 0 ? ColorGroup : 0));
+	const __m256i newGroup = _mm256_set1_epi8((char)(color < 0 ? 0 : color));
+	const __m256i shadeVec = _mm256_set1_epi8((char)shade);
+
+	int i = 0;
+	for (; i + 32 <= size; i += 32)
+	{
+		const __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+		const __m256i d = _mm256_loadu_si256((const __m256i*)(dest + i));
+		const __m256i group = _mm256_or_si256(_mm256_and_si256(s, groupMask), newGroup);
+		const __m256i newShade = _mm256_add_epi8(_mm256_and_si256(s, shadeMask), shadeVec);
+		// pixels that would flip over to another color become black instead
+		const __m256i keep = _mm256_cmpeq_epi8(_mm256_subs_epu8(newShade, shadeMask), zero);
+		const __m256i shaded = _mm256_blendv_epi8(shadeMask, _mm256_or_si256(group, newShade), keep);
+		// pixel 0 is transparent
+		const __m256i empty = _mm256_cmpeq_epi8(s, zero);
+		_mm256_storeu_si256((__m256i*)(dest + i), _mm256_blendv_epi8(shaded, d, empty));
+	}
+	// avoid penalty of mixing AVX and SSE code
+	_mm256_zeroupper();
+	shadeRowSSE2(dest + i, src + i, size - i, shade, color);
+}
+
+#endif
+
+/**
+ * Compares row shader with reference implementation, for every source pixel value,
+ * every shade and color group and rows that are not multiple of vector size.
+ * @return True if both give same pixels.
+ */
+bool checkShadeRow(ShadeRowFunc func)
+{
+	const int maxSize = 300;
+	const int sizes[] = { 0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, maxSize };
+	Uint8 src[maxSize], dest[maxSize], expected[maxSize];
+	for (int i = 0; i < maxSize; ++i)
+	{
+		// 7 is odd, so first 256 pixels have all values, including transparent 0
+		src[i] = (Uint8)(i * 7);
+	}
+	for (int color = -1; color < 16; ++color)
+	{
+		for (int shade = 0; shade <= 16; ++shade)
+		{
+			for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+			{
+				for (int i = 0; i < maxSize; ++i)
+				{
+					dest[i] = expected[i] = (Uint8)(i * 13 + 5);
+				}
+				shadeRowScalar(expected, src, sizes[s], shade, color < 0 ? -1 : color << 4);
+				func(dest, src, sizes[s], shade, color < 0 ? -1 : color << 4);
+				if (memcmp(dest, expected, maxSize) != 0)
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * Pick best version of row shader for current CPU.
+ */
+ShadeRowFunc selectShadeRow()
+{
+	ShadeRowFunc func = shadeRowScalar;
+#ifdef SHADER_SIMD_X86
+	switch (getCpuVectorLevel())
+	{
+	case CPU_AVX2:
+		func = shadeRowAVX2;
+		break;
+	case CPU_SSE2:
+		func = shadeRowSSE2;
+		break;
+	default:
+		break;
+	}
+#endif
+#ifndef NDEBUG
+	// debug builds check that vector version give exactly same pixels as reference one
+	assert(checkShadeRow(func) && "Vector row shader differs from scalar one");
+#endif
+	return func;
+}
+
+/// Row shader used by `ShaderDrawRow`, selected once at startup.
+const ShadeRowFunc shadeRow = selectShadeRow();
+
+/**
+ * Run row shader, vector versions only handle usual range of shades.
+ */
+inline void callShadeRow(Uint8* dest, const Uint8* src, int size, int shade, int color)
+{
+	if (shade < 0)
+	{
+		shadeRowScalar(dest, src, size, shade, color);
+	}
+	else
+	{
+		// every shade above 15 turns all pixels black, no need to handle bigger values
+		shadeRow(dest, src, size, shade > 16 ? 16 : shade, color);
+	}
+}
+
+} //namespace
+
+/**
+ * Checks every version of row shader that current CPU can run
+ * against the reference one, used by debug test screen.
+ * @return One line with name and result for every version.
+ */
+std::string checkShadeRows()
+{
+	std::string report = std::string("Scalar: ") + (checkShadeRow(shadeRowScalar) ? "OK" : "FAILED");
+#ifdef SHADER_SIMD_X86
+	const CpuVectorLevel level = getCpuVectorLevel();
+	if (level >= CPU_SSE2)
+	{
+		report += std::string("\nSSE2: ") + (checkShadeRow(shadeRowSSE2) ? "OK" : "FAILED");
+	}
+	if (level >= CPU_AVX2)
+	{
+		report += std::string("\nAVX2: ") + (checkShadeRow(shadeRowAVX2) ? "OK" : "FAILED");
+	}
+#endif
+	return report;
+}
+
+/**
+ * Check what vector instructions are supported by CPU and OS.
+ * @return Best usable set of instructions.
+ */
+CpuVectorLevel getCpuVectorLevel()
+{
+#if !defined(SHADER_SIMD_X86)
+	return CPU_SCALAR;
+#elif defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	const int maxLeaf = info[0];
+	__cpuid(info, 1);
+	const bool sse2 = (info[3] & (1 << 26)) != 0;
+	const bool osYmm = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+	bool avx2 = false;
+	if (osYmm && maxLeaf >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+	}
+	return avx2 ? CPU_AVX2 : sse2 ? CPU_SSE2 : CPU_SCALAR;
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return CPU_AVX2;
+	if (__builtin_cpu_supports("sse2"))
+		return CPU_SSE2;
+	return CPU_SCALAR;
+#endif
+}
+
+/**
+ * Shades a row of pixels, same as `StandardShade::func` for each of them.
+ * With shade 0 this is plain copy of all not transparent pixels.
+ * @param dest first destination pixel.
+ * @param src first source pixel.
+ * @param size number of pixels.
+ * @param shade value of shade.
+ */
+void StandardShadeRow(Uint8* dest, const Uint8* src, int size, int shade)
+{
+	callShadeRow(dest, src, size, shade, -1);
+}
+
+/**
+ * Shades and recolors a row of pixels, same as `ColorReplace::func` for each of them.
+ * @param dest first destination pixel.
+ * @param src first source pixel.
+ * @param size number of pixels.
+ * @param shade value of shade.
+ * @param newColor new color group (it should be offseted by 4).
+ */
+void ColorReplaceRow(Uint8* dest, const Uint8* src, int size, int shade, int newColor)
+{
+	callShadeRow(dest, src, size, shade, newColor & 0xFF);
+}
+
+} //namespace helper
+
+} //namespace OpenXcom
@@ -20,16 +20,45 @@
 #include "ShaderDrawHelper.h"
 #include "HelperMeta.h"
 #include <tuple>
+#include <type_traits>
 
 namespace OpenXcom
 {
 
 /**
- * Universal blit function implementation.
+ * Calls `f` for every pixel of the current row.
+ * @param f called function.
+ * @param size number of pixels in row.
+ * @param src source surfaces control objects.
+ */
+template<typename Func, typename... SrcType>
+static inline void ShaderDrawRowImpl(std::false_type, Func&& f, int size, helper::controler<SrcType>&... src)
+{
+	for (int x = size; x>0; --x, (void)helper::DummySeq{ (src.inc_x(), 0)... })
+	{
+		f(src.get_ref()...);
+	}
+}
+
+/**
+ * Calls `f` once for the current row, with first pixel of row and number of pixels.
  * @param f called function.
+ * @param size number of pixels in row.
  * @param src source surfaces control objects.
  */
 template<typename Func, typename... SrcType>
+static inline void ShaderDrawRowImpl(std::true_type, Func&& f, int size, helper::controler<SrcType>&... src)
+{
+	f(size, src.get_ref()...);
+}
+
+/**
+ * Universal blit function implementation.
+ * @tparam Rows if `std::true_type` then `f` is called once per row instead of per pixel.
+ * @param f called function.
+ * @param src source surfaces control objects.
+ */
+template<typename Rows, typename Func, typename... SrcType>
 static inline void ShaderDrawImpl(Func&& f, helper::controler<SrcType>... src)
 {
 	//get basic draw range in 2d space
@@ -83,10 +112,7 @@ static inline void ShaderDrawImpl(Func&& f, helper::controler<SrcType>... src)
 		};
 
 		//iteration on x-axis
-		for (int x = end_x-begin_x; x>0; --x, (void)helper::DummySeq{ (src.inc_x(), 0)... })
-		{
-			f(src.get_ref()...);
-		}
+		ShaderDrawRowImpl(Rows{}, f, end_x-begin_x, src...);
 	}
 
 };
@@ -100,7 +126,20 @@ static inline void ShaderDrawImpl(Func&& f, helper::controler<SrcType>... src)
 template<typename ColorFunc, typename... SrcType>
 static inline void ShaderDraw(const SrcType&... src_frame)
 {
-	ShaderDrawImpl(ColorFunc::func, helper::controler<SrcType>(src_frame)...);
+	ShaderDrawImpl<std::false_type>(ColorFunc::func, helper::controler<SrcType>(src_frame)...);
+}
+
+/**
+ * Universal blit function working on whole rows.
+ * @tparam ColorFunc class that contains static function `row`,
+ * it get number of pixels in row and first pixel of row of every argument.
+ * Can only be used with surfaces that store pixels of row one after another.
+ * @param src_frame destination and source surfaces modified by function.
+ */
+template<typename ColorFunc, typename... SrcType>
+static inline void ShaderDrawRow(const SrcType&... src_frame)
+{
+	ShaderDrawImpl<std::true_type>(ColorFunc::row, helper::controler<SrcType>(src_frame)...);
 }
 
 /**
@@ -111,7 +150,7 @@ static inline void ShaderDraw(const SrcType&... src_frame)
 template<typename Func, typename... SrcType>
 static inline void ShaderDrawFunc(Func&& f, const SrcType&... src_frame)
 {
-	ShaderDrawImpl(std::forward<Func>(f), helper::controler<SrcType>(src_frame)...);
+	ShaderDrawImpl<std::false_type>(std::forward<Func>(f), helper::controler<SrcType>(src_frame)...);
 }
 
 namespace helper
@@ -120,6 +159,11 @@ namespace helper
 const Uint8 ColorGroup = 0xF0;
 const Uint8 ColorShade = 0x0F;
 
+/// Shades a row of pixels, same as `StandardShade::func` for each of them.
+void StandardShadeRow(Uint8* dest, const Uint8* src, int size, int shade);
+/// Shades and recolors a row of pixels, same as `ColorReplace::func` for each of them.
+void ColorReplaceRow(Uint8* dest, const Uint8* src, int size, int shade, int newColor);
+
 /**
  * help class used for Surface::blitNShade
  */
@@ -146,6 +190,20 @@ struct ColorReplace
 		}
 	}
 
+	/**
+	* Function used by ShaderDrawRow in Surface::blitNShade
+	* set shade and replace color in whole row
+	* @param size number of pixels in row
+	* @param dest first destination pixel
+	* @param src first source pixel
+	* @param shade value of shade of this surface
+	* @param newColor new color to set (it should be offseted by 4)
+	*/
+	static inline void row(int size, Uint8& dest, const Uint8& src, const int& shade, const int& newColor)
+	{
+		ColorReplaceRow(&dest, &src, size, shade, newColor);
+	}
+
 };
 
 /**
@@ -175,6 +233,19 @@ struct StandardShade
 		}
 	}
 
+	/**
+	* Function used by ShaderDrawRow in Surface::blitNShade
+	* set shade in whole row
+	* @param size number of pixels in row
+	* @param dest first destination pixel
+	* @param src first source pixel
+	* @param shade value of shade of this surface
+	*/
+	static inline void row(int size, Uint8& dest, const Uint8& src, const int& shade)
+	{
+		StandardShadeRow(&dest, &src, size, shade);
+	}
+
 };
 /**
  * helper class used for bliting dying unit with overkill
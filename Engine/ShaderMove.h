@@ -130,25 +130,37 @@ inline ShaderMove<Uint8> ShaderSurface(Surface* s, int x, int y)
 }
 
 /**
- * Create warper from cropped Surface and provided offset
+ * Create warper from part of Surface and provided offset, without touching crop of surface
  * @param s standard 8bit OpenXcom surface
+ * @param s_crop part of surface to use, empty rect mean whole surface
  * @param x offset on x
  * @param y offset on y
  * @return
  */
-inline ShaderMove<Uint8> ShaderCrop(Surface* s, int x, int y)
+inline ShaderMove<Uint8> ShaderCrop(Surface* s, const SDL_Rect& s_crop, int x, int y)
 {
 	ShaderMove<Uint8> ret(s, x, y);
-	SDL_Rect* s_crop = s->getCrop();
-	if (s_crop->w && s_crop->h)
+	if (s_crop.w && s_crop.h)
 	{
-		GraphSubset crop(std::make_pair(s_crop->x, s_crop->x + s_crop->w), std::make_pair(s_crop->y, s_crop->y + s_crop->h));
+		GraphSubset crop(std::make_pair(s_crop.x, s_crop.x + s_crop.w), std::make_pair(s_crop.y, s_crop.y + s_crop.h));
 		ret.setDomain(crop);
-		ret.addMove(-s_crop->x, -s_crop->y);
+		ret.addMove(-s_crop.x, -s_crop.y);
 	}
 	return ret;
 }
 
+/**
+ * Create warper from cropped Surface and provided offset
+ * @param s standard 8bit OpenXcom surface
+ * @param x offset on x
+ * @param y offset on y
+ * @return
+ */
+inline ShaderMove<Uint8> ShaderCrop(Surface* s, int x, int y)
+{
+	return ShaderCrop(s, *s->getCrop(), x, y);
+}
+
 /**
  * Create warper from cropped Surface
  * @param s standard 8bit OpenXcom surface
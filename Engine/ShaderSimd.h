@@ -0,0 +1,62 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Support for vector versions of shaders. Include it only in .cpp files,
+ * functions marked with `SHADER_TARGET` can only be called after checking
+ * `helper::getCpuVectorLevel()`.
+ */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SHADER_SIMD_X86
+#define SHADER_TARGET(x) __attribute__((target(x)))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define SHADER_SIMD_X86
+#define SHADER_TARGET(x)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#include <string>
+
+namespace OpenXcom
+{
+
+namespace helper
+{
+
+/**
+ * Best set of vector instructions that can be used.
+ */
+enum CpuVectorLevel
+{
+	CPU_SCALAR,
+	CPU_SSE2,
+	CPU_AVX2
+};
+
+/// Gets best set of vector instructions supported by CPU and OS.
+CpuVectorLevel getCpuVectorLevel();
+
+/// Checks all row shaders usable on this CPU against the reference one.
+std::string checkShadeRows();
+
+} //namespace helper
+
+} //namespace OpenXcom
@@ -21,6 +21,7 @@
 #include "Options.h"
 #include "Logger.h"
 #include "Language.h"
+#include "FileMap.h"
 
 namespace OpenXcom
 {
@@ -46,6 +47,17 @@ Sound::~Sound()
  */
 void Sound::load(const std::string &filename)
 {
+	if (FileMap::isInArchive(filename))
+	{
+		std::string data;
+		if (!FileMap::readFile(filename, data))
+		{
+			throw Exception(filename + " not found");
+		}
+		load(data.data(), data.size());
+		return;
+	}
+
 	// SDL only takes UTF-8 filenames
 	// so here's an ugly hack to match this ugly reasoning
 	std::string utf8 = Language::wstrToUtf8(Language::fsToWstr(filename));
@@ -26,6 +26,7 @@
 #include "../lodepng.h"
 #include "Palette.h"
 #include "Exception.h"
+#include "FileMap.h"
 #include "Logger.h"
 #include "ShaderMove.h"
 #include <stdlib.h>
@@ -221,13 +222,13 @@ Surface::~Surface()
 void Surface::loadScr(const std::string &filename)
 {
 	// Load file and put pixels in surface
-	std::ifstream imgFile(filename.c_str(), std::ios::binary);
-	if (!imgFile)
+	std::unique_ptr<std::istream> imgFile = FileMap::openFile(filename);
+	if (!*imgFile)
 	{
 		throw Exception(filename + " not found");
 	}
 
-	std::vector<char> buffer((std::istreambuf_iterator<char>(imgFile)), (std::istreambuf_iterator<char>()));
+	std::vector<char> buffer((std::istreambuf_iterator<char>(*imgFile)), (std::istreambuf_iterator<char>()));
 
 	// Lock the surface
 	lock();
@@ -258,44 +259,45 @@ void Surface::loadImage(const std::string &filename)
 
 	Log(LOG_VERBOSE) << "Loading image: " << filename;
 
+	std::string data;
+	if (!FileMap::readFile(filename, data))
+	{
+		throw Exception(filename + " not found");
+	}
+
 	// Try loading with LodePNG first
-	std::vector<unsigned char> png;
-	unsigned error = lodepng::load_file(png, filename);
+	std::vector<unsigned char> image;
+	unsigned width, height;
+	lodepng::State state;
+	state.decoder.color_convert = 0;
+	unsigned error = lodepng::decode(image, width, height, state, (const unsigned char*)data.data(), data.size());
 	if (!error)
 	{
-		std::vector<unsigned char> image;
-		unsigned width, height;
-		lodepng::State state;
-		state.decoder.color_convert = 0;
-		error = lodepng::decode(image, width, height, state, png);
-		if (!error)
+		LodePNGColorMode *color = &state.info_png.color;
+		unsigned bpp = lodepng_get_bpp(color);
+		if (bpp == 8)
 		{
-			LodePNGColorMode *color = &state.info_png.color;
-			unsigned bpp = lodepng_get_bpp(color);
-			if (bpp == 8)
+			_alignedBuffer = NewAligned(bpp, width, height);
+			_surface = SDL_CreateRGBSurfaceFrom(_alignedBuffer, width, height, bpp, GetPitch(bpp, width), 0, 0, 0, 0);
+			if (_surface)
 			{
-				_alignedBuffer = NewAligned(bpp, width, height);
-				_surface = SDL_CreateRGBSurfaceFrom(_alignedBuffer, width, height, bpp, GetPitch(bpp, width), 0, 0, 0, 0);
-				if (_surface)
+				int x = 0, y = 0;
+				for (std::vector<unsigned char>::const_iterator i = image.begin(); i != image.end(); ++i)
 				{
-					int x = 0, y = 0;
-					for (std::vector<unsigned char>::const_iterator i = image.begin(); i != image.end(); ++i)
-					{
-						setPixelIterative(&x, &y, *i);
-					}
-					setPalette((SDL_Color*)color->palette, 0, color->palettesize);
-					int transparent = 0;
-					for (int c = 0; c < _surface->format->palette->ncolors; ++c)
+					setPixelIterative(&x, &y, *i);
+				}
+				setPalette((SDL_Color*)color->palette, 0, color->palettesize);
+				int transparent = 0;
+				for (int c = 0; c < _surface->format->palette->ncolors; ++c)
+				{
+					SDL_Color *palColor = _surface->format->palette->colors + c;
+					if (palColor->unused == 0)
 					{
-						SDL_Color *palColor = _surface->format->palette->colors + c;
-						if (palColor->unused == 0)
-						{
-							transparent = c;
-							break;
-						}
+						transparent = c;
+						break;
 					}
-					SDL_SetColorKey(_surface, SDL_SRCCOLORKEY, transparent);
 				}
+				SDL_SetColorKey(_surface, SDL_SRCCOLORKEY, transparent);
 			}
 		}
 	}
@@ -303,10 +305,9 @@ void Surface::loadImage(const std::string &filename)
 	// Otherwise default to SDL_Image
 	if (!_surface)
 	{
-		// SDL only takes UTF-8 filenames
-		// so here's an ugly hack to match this ugly reasoning
-		std::string utf8 = Language::wstrToUtf8(Language::fsToWstr(filename));
-		_surface = IMG_Load(utf8.c_str());
+		// file can be in mod archive, so load it from memory, extension tells the format
+		std::string ext = filename.substr(filename.find_last_of('.') + 1);
+		_surface = IMG_LoadTyped_RW(SDL_RWFromConstMem(data.data(), data.size()), 1, const_cast<char*>(ext.c_str()));
 	}
 
 	if (!_surface)
@@ -326,8 +327,8 @@ void Surface::loadImage(const std::string &filename)
 void Surface::loadSpk(const std::string &filename)
 {
 	// Load file and put pixels in surface
-	std::ifstream imgFile (filename.c_str(), std::ios::in | std::ios::binary);
-	if (!imgFile)
+	std::unique_ptr<std::istream> imgFile = FileMap::openFile(filename);
+	if (!*imgFile)
 	{
 		throw Exception(filename + " not found");
 	}
@@ -339,13 +340,13 @@ void Surface::loadSpk(const std::string &filename)
 	Uint8 value;
 	int x = 0, y = 0;
 
-	while (imgFile.read((char*)&flag, sizeof(flag)))
+	while (imgFile->read((char*)&flag, sizeof(flag)))
 	{
 		flag = SDL_SwapLE16(flag);
 
 		if (flag == 65535)
 		{
-			imgFile.read((char*)&flag, sizeof(flag));
+			imgFile->read((char*)&flag, sizeof(flag));
 			flag = SDL_SwapLE16(flag);
 
 			for (int i = 0; i < flag * 2; ++i)
@@ -355,12 +356,12 @@ void Surface::loadSpk(const std::string &filename)
 		}
 		else if (flag == 65534)
 		{
-			imgFile.read((char*)&flag, sizeof(flag));
+			imgFile->read((char*)&flag, sizeof(flag));
 			flag = SDL_SwapLE16(flag);
 
 			for (int i = 0; i < flag * 2; ++i)
 			{
-				imgFile.read((char*)&value, 1);
+				imgFile->read((char*)&value, 1);
 				setPixelIterative(&x, &y, value);
 			}
 		}
@@ -368,8 +369,6 @@ void Surface::loadSpk(const std::string &filename)
 
 	// Unlock the surface
 	unlock();
-
-	imgFile.close();
 }
 
 /**
@@ -382,8 +381,8 @@ void Surface::loadSpk(const std::string &filename)
 void Surface::loadBdy(const std::string &filename)
 {
 	// Load file and put pixels in surface
-	std::ifstream imgFile (filename.c_str(), std::ios::in | std::ios::binary);
-	if (!imgFile)
+	std::unique_ptr<std::istream> imgFile = FileMap::openFile(filename);
+	if (!*imgFile)
 	{
 		throw Exception(filename + " not found");
 	}
@@ -396,12 +395,12 @@ void Surface::loadBdy(const std::string &filename)
 	int x = 0, y = 0;
 	int currentRow = 0;
 
-	while (imgFile.read((char*)&dataByte, sizeof(dataByte)))
+	while (imgFile->read((char*)&dataByte, sizeof(dataByte)))
 	{
 		if (dataByte >= 129)
 		{
 			pixelCnt = 257 - (int)dataByte;
-			imgFile.read((char*)&dataByte, sizeof(dataByte));
+			imgFile->read((char*)&dataByte, sizeof(dataByte));
 			currentRow = y;
 			for (int i = 0; i < pixelCnt; ++i)
 			{
@@ -415,7 +414,7 @@ void Surface::loadBdy(const std::string &filename)
 			currentRow = y;
 			for (int i = 0; i < pixelCnt; ++i)
 			{
-				imgFile.read((char*)&dataByte, sizeof(dataByte));
+				imgFile->read((char*)&dataByte, sizeof(dataByte));
 				if (currentRow == y) // avoid overscan into next row
 					setPixelIterative(&x, &y, dataByte);
 			}
@@ -424,8 +423,6 @@ void Surface::loadBdy(const std::string &filename)
 
 	// Unlock the surface
 	unlock();
-
-	imgFile.close();
 }
 
 
@@ -876,10 +873,10 @@ void Surface::blitNShade(Surface *surface, int x, int y, int off, bool half, int
 	{
 		--newBaseColor;
 		newBaseColor <<= 4;
-		ShaderDraw<helper::ColorReplace>(ShaderSurface(surface), src, ShaderScalar(off), ShaderScalar(newBaseColor));
+		ShaderDrawRow<helper::ColorReplace>(ShaderSurface(surface), src, ShaderScalar(off), ShaderScalar(newBaseColor));
 	}
 	else
-		ShaderDraw<helper::StandardShade>(ShaderSurface(surface), src, ShaderScalar(off));
+		ShaderDrawRow<helper::StandardShade>(ShaderSurface(surface), src, ShaderScalar(off));
 }
 
 /**
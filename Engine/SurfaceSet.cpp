@@ -20,6 +20,7 @@
 #include <fstream>
 #include "Surface.h"
 #include "Exception.h"
+#include "FileMap.h"
 
 namespace OpenXcom
 {
@@ -82,17 +83,17 @@ void SurfaceSet::loadPck(const std::string &pck, const std::string &tab)
 	// Load TAB and get image offsets
 	if (!tab.empty())
 	{
-		std::ifstream offsetFile(tab.c_str(), std::ios::in | std::ios::binary);
-		if (!offsetFile)
+		std::unique_ptr<std::istream> offsetFile = FileMap::openFile(tab);
+		if (!*offsetFile)
 		{
 			throw Exception(tab + " not found");
 		}
 		std::streampos begin, end;
-		begin = offsetFile.tellg();
+		begin = offsetFile->tellg();
 		int off;
-		offsetFile.read((char*)&off, sizeof(off));
-		offsetFile.seekg(0, std::ios::end);
-		end = offsetFile.tellg();
+		offsetFile->read((char*)&off, sizeof(off));
+		offsetFile->seekg(0, std::ios::end);
+		end = offsetFile->tellg();
 		int size = end - begin;
 		// 16-bit offsets
 		if (off != 0)
@@ -104,7 +105,6 @@ void SurfaceSet::loadPck(const std::string &pck, const std::string &tab)
 		{
 			nframes = size / 4;
 		}
-		offsetFile.close();
 		for (int frame = 0; frame < nframes; ++frame)
 		{
 			_frames.push_back(new Surface(_width, _height));
@@ -117,8 +117,8 @@ void SurfaceSet::loadPck(const std::string &pck, const std::string &tab)
 	}
 
 	// Load PCK and put pixels in surfaces
-	std::ifstream imgFile (pck.c_str(), std::ios::in | std::ios::binary);
-	if (!imgFile)
+	std::unique_ptr<std::istream> imgFile = FileMap::openFile(pck);
+	if (!*imgFile)
 	{
 		throw Exception(pck + " not found");
 	}
@@ -132,7 +132,7 @@ void SurfaceSet::loadPck(const std::string &pck, const std::string &tab)
 		// Lock the surface
 		_frames[frame]->lock();
 
-		imgFile.read((char*)&value, 1);
+		imgFile->read((char*)&value, 1);
 		for (int i = 0; i < value; ++i)
 		{
 			for (int j = 0; j < _width; ++j)
@@ -141,11 +141,11 @@ void SurfaceSet::loadPck(const std::string &pck, const std::string &tab)
 			}
 		}
 
-		while (imgFile.read((char*)&value, 1) && value != 255)
+		while (imgFile->read((char*)&value, 1) && value != 255)
 		{
 			if (value == 254)
 			{
-				imgFile.read((char*)&value, 1);
+				imgFile->read((char*)&value, 1);
 				for (int i = 0; i < value; ++i)
 				{
 					_frames[frame]->setPixelIterative(&x, &y, 0);
@@ -160,8 +160,6 @@ void SurfaceSet::loadPck(const std::string &pck, const std::string &tab)
 		// Unlock the surface
 		_frames[frame]->unlock();
 	}
-
-	imgFile.close();
 }
 
 /**
@@ -177,15 +175,15 @@ void SurfaceSet::loadDat(const std::string &filename)
 	int nframes = 0;
 
 	// Load file and put pixels in surface
-	std::ifstream imgFile (filename.c_str(), std::ios::in | std::ios::binary);
-	if (!imgFile)
+	std::unique_ptr<std::istream> imgFile = FileMap::openFile(filename);
+	if (!*imgFile)
 	{
 		throw Exception(filename + " not found");
 	}
 
-	imgFile.seekg(0, std::ios::end);
-	std::streamoff size = imgFile.tellg();
-	imgFile.seekg(0, std::ios::beg);
+	imgFile->seekg(0, std::ios::end);
+	std::streamoff size = imgFile->tellg();
+	imgFile->seekg(0, std::ios::beg);
 
 	nframes = (int)size / (_width * _height);
 
@@ -201,7 +199,7 @@ void SurfaceSet::loadDat(const std::string &filename)
 	// Lock the surface
 	_frames[frame]->lock();
 
-	while (imgFile.read((char*)&value, 1))
+	while (imgFile->read((char*)&value, 1))
 	{
 		_frames[frame]->setPixelIterative(&x, &y, value);
 
@@ -220,8 +218,6 @@ void SurfaceSet::loadDat(const std::string &filename)
 				_frames[frame]->lock();
 		}
 	}
-
-	imgFile.close();
 }
 
 /**
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ThreadPool.h"
+#include <algorithm>
+#include "CrossPlatform.h"
+#include "Logger.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Creates a pool and starts its worker threads.
+ * The thread calling run() also does its share of work,
+ * so with zero workers everything is done serially.
+ * @param workers Number of additional threads.
+ */
+ThreadPool::ThreadPool(int workers) : _func(0), _data(0), _size(0), _chunk(1), _next(0), _finished(0), _generation(0), _quit(false)
+{
+	_mutex = SDL_CreateMutex();
+	_start = SDL_CreateCond();
+	_done = SDL_CreateCond();
+	if (!_mutex || !_start || !_done)
+	{
+		return;
+	}
+	for (int i = 0; i < workers; ++i)
+	{
+		SDL_Thread *thread = SDL_CreateThread(worker, this);
+		if (thread == 0)
+		{
+			Log(LOG_WARNING) << "Failed to create worker thread: " << SDL_GetError();
+			break;
+		}
+		_threads.push_back(thread);
+	}
+}
+
+/**
+ * Tells all workers to quit and waits for them.
+ */
+ThreadPool::~ThreadPool()
+{
+	if (_mutex)
+	{
+		SDL_LockMutex(_mutex);
+		_quit = true;
+		SDL_CondBroadcast(_start);
+		SDL_UnlockMutex(_mutex);
+	}
+	for (std::vector<SDL_Thread*>::iterator i = _threads.begin(); i != _threads.end(); ++i)
+	{
+		SDL_WaitThread(*i, 0);
+	}
+	if (_done) SDL_DestroyCond(_done);
+	if (_start) SDL_DestroyCond(_start);
+	if (_mutex) SDL_DestroyMutex(_mutex);
+}
+
+/**
+ * Gets the pool shared by the whole game, with one
+ * worker for every processor beside the main one.
+ * @return Thread pool.
+ */
+ThreadPool &ThreadPool::getShared()
+{
+	static ThreadPool pool(std::min(CrossPlatform::getProcessorCount(), 16) - 1);
+	return pool;
+}
+
+/**
+ * Gets number of threads that work on a job,
+ * including the one that calls run().
+ * @return Number of threads.
+ */
+int ThreadPool::getThreadCount() const
+{
+	return (int)_threads.size() + 1;
+}
+
+/**
+ * Waits for jobs and works on them until the pool is destroyed.
+ * @param pool Thread pool.
+ * @return Always 0.
+ */
+int ThreadPool::worker(void *pool)
+{
+	ThreadPool *self = (ThreadPool*)pool;
+	SDL_LockMutex(self->_mutex);
+	Uint32 seen = self->_generation;
+	while (true)
+	{
+		while (!self->_quit && self->_generation == seen)
+		{
+			SDL_CondWait(self->_start, self->_mutex);
+		}
+		if (self->_quit)
+		{
+			break;
+		}
+		seen = self->_generation;
+		self->work();
+	}
+	SDL_UnlockMutex(self->_mutex);
+	return 0;
+}
+
+/**
+ * Takes parts of the current job one by one and processes them.
+ * Needs to be called with the mutex locked, it's unlocked
+ * only while a part is processed.
+ */
+void ThreadPool::work()
+{
+	while (_next < _size)
+	{
+		const int begin = _next;
+		const int end = std::min(_size, begin + _chunk);
+		TaskFunc func = _func;
+		void *data = _data;
+		_next = end;
+
+		SDL_UnlockMutex(_mutex);
+		func(data, begin, end);
+		SDL_LockMutex(_mutex);
+
+		_finished += end - begin;
+		if (_finished == _size)
+		{
+			SDL_CondBroadcast(_done);
+		}
+	}
+}
+
+/**
+ * Splits range [0, size) in parts of `chunk` elements,
+ * calls `func` for each part on all threads of the pool
+ * and waits until everything is done.
+ * When the pool is already busy (call from inside a job
+ * or from another thread), the job is done serially.
+ * @param func Function that processes one part.
+ * @param data Data passed to the function.
+ * @param size Size of job.
+ * @param chunk Size of one part.
+ */
+void ThreadPool::run(TaskFunc func, void *data, int size, int chunk)
+{
+	if (size <= 0)
+	{
+		return;
+	}
+	chunk = std::max(chunk, 1);
+	if (_threads.empty() || size <= chunk)
+	{
+		func(data, 0, size);
+		return;
+	}
+
+	SDL_LockMutex(_mutex);
+	if (_func)
+	{
+		SDL_UnlockMutex(_mutex);
+		func(data, 0, size);
+		return;
+	}
+	_func = func;
+	_data = data;
+	_size = size;
+	_chunk = chunk;
+	_next = 0;
+	_finished = 0;
+	++_generation;
+	SDL_CondBroadcast(_start);
+
+	work();
+	while (_finished < _size)
+	{
+		SDL_CondWait(_done, _mutex);
+	}
+	_func = 0;
+	_data = 0;
+	SDL_UnlockMutex(_mutex);
+}
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include <SDL.h>
+#include <SDL_thread.h>
+
+namespace OpenXcom
+{
+
+/**
+ * Set of worker threads kept alive for whole game,
+ * used to split heavy per-frame work (like screen scaling)
+ * into parts that are processed at the same time.
+ */
+class ThreadPool
+{
+public:
+	/// Function processing part [begin, end) of a job.
+	typedef void (*TaskFunc)(void *data, int begin, int end);
+
+private:
+	std::vector<SDL_Thread*> _threads;
+	SDL_mutex *_mutex;
+	SDL_cond *_start, *_done;
+	TaskFunc _func;
+	void *_data;
+	int _size, _chunk, _next, _finished;
+	Uint32 _generation;
+	bool _quit;
+
+	/// Main loop of worker thread.
+	static int worker(void *pool);
+	/// Processes parts of the current job until none is left.
+	void work();
+	/// Calls functor with part of job.
+	template<typename Func>
+	static void call(void *data, int begin, int end)
+	{
+		(*static_cast<Func*>(data))(begin, end);
+	}
+public:
+	/// Creates pool with given number of workers.
+	ThreadPool(int workers);
+	/// Stops all workers.
+	~ThreadPool();
+	/// Gets the pool shared by the whole game.
+	static ThreadPool &getShared();
+	/// Gets number of threads that work on a job.
+	int getThreadCount() const;
+	/// Splits job in parts and waits until every part is done.
+	void run(TaskFunc func, void *data, int size, int chunk);
+	/// Calls `f(begin, end)` for parts of range [0, size), in parallel.
+	template<typename Func>
+	void parallelFor(int size, int chunk, Func &f)
+	{
+		run(&call<Func>, &f, size, chunk);
+	}
+};
+
+}
@@ -19,6 +19,9 @@
 #include "Timer.h"
 #include "Game.h"
 #include "Options.h"
+#include "CrossPlatform.h"
+#include <algorithm>
+#include <limits>
 
 namespace OpenXcom
 {
@@ -27,11 +30,14 @@ namespace
 {
 	
 const Uint32 accurate = 4;
-Uint32 slowTick()
+/**
+ * Gets the game time in microseconds, running slower by `Timer::gameSlowSpeed`.
+ */
+Sint64 slowTick()
 {
-	static Uint32 old_time = SDL_GetTicks();
-	static Uint64 false_time = static_cast<Uint64>(old_time) << accurate;
-	Uint64 new_time = ((Uint64)SDL_GetTicks()) << accurate;
+	static Uint64 old_time = CrossPlatform::getMonotonicTime() << accurate;
+	static Uint64 false_time = old_time;
+	Uint64 new_time = CrossPlatform::getMonotonicTime() << accurate;
 	false_time += (new_time - old_time) / Timer::gameSlowSpeed;
 	old_time = new_time;
 	return false_time >> accurate;
@@ -40,6 +46,7 @@ Uint32 slowTick()
 }//namespace
 
 Uint32 Timer::gameSlowSpeed = 1;
+Uint64 Timer::_nextDeadline = std::numeric_limits<Uint64>::max();
 int Timer::maxFrameSkip = 8; // this is a pretty good default at 60FPS. 
 
 
@@ -48,7 +55,7 @@ int Timer::maxFrameSkip = 8; // this is a pretty good default at 60FPS.
  * @param interval Time interval in milliseconds.
  * @param frameSkipping Use frameskipping.
  */
-Timer::Timer(Uint32 interval, bool frameSkipping) : _start(0), _interval(interval), _running(false), _frameSkipping(frameSkipping), _state(0), _surface(0)
+Timer::Timer(Uint32 interval, bool frameSkipping) : _start(0), _frameSkipStart(0), _interval(interval), _running(false), _frameSkipping(frameSkipping), _state(0), _surface(0)
 {
 	Timer::maxFrameSkip = Options::maxFrameSkip;
 }
@@ -86,7 +93,7 @@ Uint32 Timer::getTime() const
 {
 	if (_running)
 	{
-		return slowTick() - _start;
+		return (slowTick() - _start) / 1000;
 	}
 	return 0;
 }
@@ -111,18 +118,19 @@ void Timer::think(State* state, Surface* surface)
 	Sint64 now = slowTick(); // must be signed to permit negative numbers
 	Game *game = state ? state->_game : 0; // this is used to make sure we stop calling *_state on *state in the loop once *state has been popped and deallocated
 	//assert(!game || game->isState(state));
+	const Sint64 interval = (Sint64)_interval * 1000;
 
 	if (_running)
 	{
-		if ((now - _frameSkipStart) >= _interval)
+		if ((now - _frameSkipStart) >= interval)
 		{
-			for (int i = 0; i <= maxFrameSkip && isRunning() && (now - _frameSkipStart) >= _interval; ++i)
+			for (int i = 0; i <= maxFrameSkip && isRunning() && (now - _frameSkipStart) >= interval; ++i)
 			{
 				if (state != 0 && _state != 0)
 				{
 					(state->*_state)();
 				}
-				_frameSkipStart += _interval;
+				_frameSkipStart += interval;
 				// breaking here after one iteration effectively returns this function to its old functionality:
 				if (!game || !_frameSkipping || !game->isState(state)) break; // if game isn't set, we can't verify *state
 			}
@@ -135,6 +143,12 @@ void Timer::think(State* state, Surface* surface)
 			if (_start > _frameSkipStart) _frameSkipStart = _start; // don't play animations in ffwd to catch up :P
 		}
 	}
+	if (_running)
+	{
+		// tell the game loop how long it can sleep, slowed time passes slower than real time
+		const Sint64 wait = std::max<Sint64>(0, _frameSkipStart + interval - slowTick()) * gameSlowSpeed;
+		_nextDeadline = std::min<Uint64>(_nextDeadline, CrossPlatform::getMonotonicTime() + wait);
+	}
 }
 
 /**
@@ -173,4 +187,16 @@ void Timer::setFrameSkipping(bool skip)
 	_frameSkipping = skip;
 }
 
+/**
+ * Gets the earliest time any running timer needs to be advanced again,
+ * as seen by the timers that were advanced since the last call.
+ * @return Time of `CrossPlatform::getMonotonicTime`, or the maximum value if no timer is running.
+ */
+Uint64 Timer::takeNextDeadline()
+{
+	Uint64 deadline = _nextDeadline;
+	_nextDeadline = std::numeric_limits<Uint64>::max();
+	return deadline;
+}
+
 }
@@ -31,6 +31,7 @@ typedef void (Surface::* SurfaceHandler)();
  * Timer used to run code in fixed intervals.
  * Used for code that should run at the same fixed interval
  * in various machines, based on miliseconds instead of CPU cycles.
+ * Time is tracked internally with microsecond precision.
  */
 class Timer
 {
@@ -39,8 +40,9 @@ public:
 	static Uint32 gameSlowSpeed;
 	
 private:
-	Uint32 _start;
-	Uint32 _frameSkipStart;
+	static Uint64 _nextDeadline;
+	Sint64 _start;
+	Sint64 _frameSkipStart;
 	int _interval;
 	bool _running;
 	bool _frameSkipping;
@@ -69,6 +71,8 @@ public:
 	void onTimer(SurfaceHandler handler);
 	/// Turns frame skipping on or off
 	void setFrameSkipping(bool skip);
+	/// Gets when the earliest running timer is due again and forgets it.
+	static Uint64 takeNextDeadline();
 };
 
 }
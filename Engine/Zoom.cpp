@@ -18,6 +18,7 @@
  */
 
 #include "Zoom.h"
+#include <algorithm>
 
 #include "Surface.h"
 #include "Logger.h"
@@ -25,6 +26,7 @@
 #include "Screen.h"
 
 #include "OpenGL.h"
+#include "ThreadPool.h"
 
 // Scale2X
 #include "Scalers/scalebit.h"
@@ -647,6 +649,55 @@ bool Zoom::haveSSE2()
 
 #endif
 
+/**
+ * Gets the number of rows in one band of work given to the thread pool.
+ * @param rows Number of rows of the whole image.
+ * @return Number of rows in band.
+ */
+static int getBandSize(int rows)
+{
+	// few bands per thread so a slow one doesn't stall the others
+	return std::max(8, rows / (ThreadPool::getShared().getThreadCount() * 4));
+}
+
+/**
+ * Converts 8-bit palette surface to 32-bit one, using all threads.
+ * Equivalent of SDL_BlitSurface() for that case.
+ * @param src The 8-bit surface (input).
+ * @param dst The 32-bit surface (output).
+ */
+static void convertTo32bit(SDL_Surface *src, SDL_Surface *dst)
+{
+	if (src->format->BytesPerPixel != 1 || src->format->palette == 0 || dst->format->BytesPerPixel != 4)
+	{
+		SDL_BlitSurface(src, 0, dst, 0);
+		return;
+	}
+
+	Uint32 colors[256] = { };
+	const SDL_Palette *palette = src->format->palette;
+	for (int i = 0; i < palette->ncolors && i < 256; ++i)
+	{
+		colors[i] = SDL_MapRGB(dst->format, palette->colors[i].r, palette->colors[i].g, palette->colors[i].b);
+	}
+
+	const int width = std::min(src->w, dst->w);
+	auto band = [&](int begin, int end)
+	{
+		for (int y = begin; y < end; ++y)
+		{
+			const Uint8 *sp = (const Uint8*)src->pixels + y * src->pitch;
+			Uint32 *dp = (Uint32*)((Uint8*)dst->pixels + y * dst->pitch);
+			for (int x = 0; x < width; ++x)
+			{
+				dp[x] = colors[sp[x]];
+			}
+		}
+	};
+	const int height = std::min(src->h, dst->h);
+	ThreadPool::getShared().parallelFor(height, getBandSize(height), band);
+}
+
 /**
  * Wrapper around various software and OpenGL screen buffer pushing functions which zoom.
  * Basically called just from Screen::flip()
@@ -658,15 +709,16 @@ bool Zoom::haveSSE2()
  * @param leftBlackBand Size of left black band in pixels (letterboxing).
  * @param rightBlackBand Size of right black band in pixels (letterboxing).
  * @param glOut OpenGL output.
+ * @param buffer Intermediate surface used for letterboxing, kept by the caller between frames.
  */
-void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, int bottomBlackBand, int leftBlackBand, int rightBlackBand, OpenGL *glOut)
+void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, int bottomBlackBand, int leftBlackBand, int rightBlackBand, OpenGL *glOut, SDL_Surface *&buffer)
 {
 	if (Screen::isOpenGLEnabled())
 	{
 #ifndef __NO_OPENGL
 		if (glOut->buffer_surface)
 		{
-			SDL_BlitSurface(src, 0, glOut->buffer_surface->getSurface(), 0); // TODO; this is less than ideal...
+			convertTo32bit(src, glOut->buffer_surface->getSurface());
 
 			glOut->refresh(glOut->linear, glOut->iwidth, glOut->iheight, dst->w, dst->h, topBlackBand, bottomBlackBand, leftBlackBand, rightBlackBand);
 			SDL_GL_SwapBuffers();
@@ -684,7 +736,19 @@ void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, in
 	}
 	else
 	{
-		SDL_Surface *tmp = SDL_CreateRGBSurface(dst->flags, dst->w - leftBlackBand - rightBlackBand, dst->h - topBlackBand - bottomBlackBand, dst->format->BitsPerPixel, 0, 0, 0, 0);
+		// reused between frames, only recreated when the window changes
+		const int w = dst->w - leftBlackBand - rightBlackBand;
+		const int h = dst->h - topBlackBand - bottomBlackBand;
+		if (buffer == 0 || buffer->w != w || buffer->h != h || buffer->format->BitsPerPixel != dst->format->BitsPerPixel)
+		{
+			SDL_FreeSurface(buffer);
+			buffer = SDL_CreateRGBSurface(dst->flags, w, h, dst->format->BitsPerPixel, 0, 0, 0, 0);
+			if (buffer == 0)
+			{
+				return;
+			}
+		}
+		SDL_Surface *tmp = buffer;
 		_zoomSurfaceY(src, tmp, 0, 0);
 		if (src->format->palette != NULL)
 		{
@@ -692,7 +756,6 @@ void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, in
 		}
 		SDL_Rect dstrect = {(Sint16)leftBlackBand, (Sint16)topBlackBand, (Uint16)tmp->w, (Uint16)tmp->h};
 		SDL_BlitSurface(tmp, NULL, dst, &dstrect);
-		SDL_FreeSurface(tmp);
 	}
 }
 
@@ -704,6 +767,7 @@ void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, in
  * Zooms 8bit palette/Y 'src' surface to 'dst' surface.
  * Assumes src and dst surfaces are of 8-bit depth.
  * Assumes dst surface was allocated with the correct dimensions.
+ * Filters that support it are run in horizontal bands on all threads.
  *
  * @param src The surface to zoom (input).
  * @param dst The zoomed surface (output).
@@ -714,12 +778,13 @@ void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, in
 int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int flipy)
 {
 	int x, y;
-	static Uint32 *sax, *say;
-	Uint32 *csax, *csay;
-	int csx, csy;
-	Uint8 *sp, *dp, *csp;
-	int dgap;
+	static Sint32 *sax, *say;
+	Sint32 *csax, *csay;
+	int csx, csy, rowInc, offset;
+	Uint8 *csp;
 	static bool proclaimed = false;
+	ThreadPool &pool = ThreadPool::getShared();
+	const int band = getBandSize(src->h);
 
 	if (Screen::is32bitEnabled())
 	{
@@ -730,7 +795,11 @@ int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int fli
 			{
 				if (dst->w == src->w * (int)factor && dst->h == src->h * (int)factor)
 				{
-					xbrz::scale(factor, (uint32_t*)src->pixels, (uint32_t*)dst->pixels, src->w, src->h);
+					auto slice = [&](int begin, int end)
+					{
+						xbrz::scale(factor, (uint32_t*)src->pixels, (uint32_t*)dst->pixels, src->w, src->h, xbrz::ScalerCfg(), begin, end);
+					};
+					pool.parallelFor(src->h, band, slice);
 					return 0;
 				}
 			}
@@ -746,23 +815,35 @@ int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int fli
 				initDone = true;
 			}
 
-			// HQX_API void HQX_CALLCONV hq2x_32_rb( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height );
+			// HQX_API void HQX_CALLCONV hq2x_32_rb_slice( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height, int yFirst, int yLast );
 
 			if (dst->w == src->w * 2 && dst->h == src->h * 2)
 			{
-				hq2x_32_rb((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h);
+				auto slice = [&](int begin, int end)
+				{
+					hq2x_32_rb_slice((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h, begin, end);
+				};
+				pool.parallelFor(src->h, band, slice);
 				return 0;
 			}
 
 			if (dst->w == src->w * 3 && dst->h == src->h * 3)
 			{
-				hq3x_32_rb((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h);
+				auto slice = [&](int begin, int end)
+				{
+					hq3x_32_rb_slice((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h, begin, end);
+				};
+				pool.parallelFor(src->h, band, slice);
 				return 0;
 			}
 
 			if (dst->w == src->w * 4 && dst->h == src->h * 4)
 			{
-				hq4x_32_rb((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h);
+				auto slice = [&](int begin, int end)
+				{
+					hq4x_32_rb_slice((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h, begin, end);
+				};
+				pool.parallelFor(src->h, band, slice);
 				return 0;
 			}
 		}
@@ -829,6 +910,7 @@ int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int fli
 		else if (dst->w == src->w * 2) return zoomSurface2X_XAxis_32bit(src, dst);
 	}
 	*/
+
 	if (!proclaimed)
 	{
 		Log(LOG_INFO) << "Using software scaling routine. For best results, try an OpenGL filter.";
@@ -838,11 +920,11 @@ int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int fli
 	/*
 	* Allocate memory for row increments
 	*/
-	if ((sax = (Uint32 *) realloc(sax, (dst->w + 1) * sizeof(Uint32))) == NULL) {
+	if ((sax = (Sint32 *) realloc(sax, (dst->w + 1) * sizeof(Sint32))) == NULL) {
 		sax = 0;
 		return (-1);
 	}
-	if ((say = (Uint32 *) realloc(say, (dst->h + 1) * sizeof(Uint32))) == NULL) {
+	if ((say = (Sint32 *) realloc(say, (dst->h + 1) * sizeof(Sint32))) == NULL) {
 		say = 0;
 		//free(sax);
 		return (-1);
@@ -851,15 +933,13 @@ int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int fli
 	/*
 	* Pointer setup
 	*/
-	sp = csp = (Uint8 *) src->pixels;
-	dp = (Uint8 *) dst->pixels;
-	dgap = dst->pitch - dst->w;
+	csp = (Uint8 *) src->pixels;
 
 	if (flipx) csp += (src->w-1);
 	if (flipy) csp  = ( (Uint8*)csp + src->pitch*(src->h-1) );
 
 	/*
-	* Precalculate row increments
+	* Precalculate column increments
 	*/
 	csx = 0;
 	csax = sax;
@@ -873,51 +953,50 @@ int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int fli
 		(*csax) *= (flipx ? -1 : 1);
 		csax++;
 	}
+	/*
+	* Precalculate row offsets, so every band can start on its own
+	*/
 	csy = 0;
+	offset = 0;
 	csay = say;
 	for (y = 0; y < dst->h; y++) {
+		*csay = offset;
 		csy += src->h;
-		*csay = 0;
+		rowInc = 0;
 		while (csy >= dst->h) {
 			csy -= dst->h;
-			(*csay)++;
+			rowInc++;
 		}
-		(*csay) *= src->pitch * (flipy ? -1 : 1);
+		offset += rowInc * src->pitch * (flipy ? -1 : 1);
 		csay++;
 	}
 	/*
 	* Draw
 	*/
-	csay = say;
-	for (y = 0; y < dst->h; y++) {
-		csax = sax;
-		sp = csp;
-		for (x = 0; x < dst->w; x++) {
-			/*
-			* Draw
-			*/
-			*dp = *sp;
-			/*
-			* Advance source pointers
-			*/
-			sp += (*csax);
-			csax++;
-			/*
-			* Advance destination pointer
-			*/
-			dp++;
+	auto rows = [&](int begin, int end)
+	{
+		for (int row = begin; row < end; row++) {
+			const Sint32 *inc = sax;
+			const Uint8 *sp = csp + say[row];
+			Uint8 *dp = (Uint8 *) dst->pixels + row * dst->pitch;
+			for (int col = 0; col < dst->w; col++) {
+				/*
+				* Draw
+				*/
+				*dp = *sp;
+				/*
+				* Advance source pointers
+				*/
+				sp += (*inc);
+				inc++;
+				/*
+				* Advance destination pointer
+				*/
+				dp++;
+			}
 		}
-		/*
-		* Advance source pointer (for row)
-		*/
-		csp += (*csay);
-		csay++;
-
-		/*
-		* Advance destination pointers
-		*/
-		dp += dgap;
-	}
+	};
+	pool.parallelFor(dst->h, getBandSize(dst->h), rows);
 
 	/*
 	* Never remove temp arrays
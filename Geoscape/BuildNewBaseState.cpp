@@ -208,7 +208,7 @@ void BuildNewBaseState::hoverRedraw(void)
 	{
 		_oldlat=lat;
 		_oldlon=lon;
-		_globe->invalidate();
+		_globe->draw();
 	}
 }
 
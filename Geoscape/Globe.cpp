@@ -18,6 +18,7 @@
  */
 #include "Globe.h"
 #include <algorithm>
+#include <cstring>
 #include "../fmath.h"
 #include "../Engine/Action.h"
 #include "../Engine/SurfaceSet.h"
@@ -42,7 +43,8 @@
 #include "../Savegame/Craft.h"
 #include "../Savegame/Waypoint.h"
 #include "../Engine/ShaderMove.h"
-#include "../Engine/ShaderRepeat.h"
+#include "../Engine/ShaderSimd.h"
+#include "../Engine/ThreadPool.h"
 #include "../Engine/Options.h"
 #include "../Savegame/MissionSite.h"
 #include "../Savegame/AlienBase.h"
@@ -72,8 +74,8 @@ namespace
 ///helper class for `Globe` for drawing earth globe with shadows
 struct GlobeStaticData
 {
-	///array of shading gradient
-	Sint16 shade_gradient[240];
+	///array of shading gradient, last entry is for distance exactly equal 120
+	int shade_gradient[241];
 	///size of x & y of noise surface
 	const int random_surf_size;
 
@@ -114,7 +116,7 @@ struct GlobeStaticData
 	GlobeStaticData() : random_surf_size(60)
 	{
 		//filling terminator gradient LUT
-		for (int i=0; i<240; ++i)
+		for (int i=0; i<=240; ++i)
 		{
 			int j = i - 120;
 
@@ -176,7 +178,10 @@ struct Ocean
 
 struct CreateShadow
 {
-	static inline Uint8 getShadowValue(const Uint8& dest, const Cord& earth, const Cord& sun, const Sint16& noise)
+	/**
+	 * Scaled distance between point on earth and the sun, in range [-250, 250].
+	 */
+	static inline double getDistance(const Cord& earth, const Cord& sun)
 	{
 		Cord temp = earth;
 		//diff
@@ -190,52 +195,58 @@ struct CreateShadow
 
 		temp.x -= 2;
 		temp.x *= 125.;
+		return temp.x;
+	}
 
-		if (temp.x < -110)
-			temp.x = -31;
-		else if (temp.x > 120)
-			temp.x = 50;
+	/**
+	 * Shadow for given distance from the sun, in range [0, 31].
+	 */
+	static inline Uint8 getShade(double distance, Sint16 noise)
+	{
+		int value;
+		if (distance < -110)
+			value = -31;
+		else if (distance > 120)
+			value = 50;
 		else
-			temp.x = static_data.shade_gradient[(Sint16)temp.x + 120];
+			value = static_data.shade_gradient[(Sint16)distance + 120];
 
-		temp.x -= noise;
+		value -= noise;
+
+		if (value > 0)
+			return (value > 31)? 31 : value;
+		else
+			return 0;
+	}
 
-		if (temp.x > 0.)
+	/**
+	 * Applies shadow to pixel of ocean or land.
+	 */
+	static inline Uint8 applyShade(const Uint8& dest, Uint8 shade)
+	{
+		const int d = dest & helper::ColorGroup;
+		if (d ==  Globe::OCEAN_COLOR || d == Globe::OCEAN_COLOR + 16)
 		{
-			const Sint16 val = (temp.x> 31)? 31 : (Sint16)temp.x;
-			const int d = dest & helper::ColorGroup;
-			if (d ==  Globe::OCEAN_COLOR || d == Globe::OCEAN_COLOR + 16)
-			{
-				//this pixel is ocean
-				return Globe::OCEAN_COLOR + val;
-			}
-			else
-			{
-				//this pixel is land
-				if (dest==0) return val;
-				const int s = val / 3;
-				const int e = dest+s;
-				if (e > d + helper::ColorShade)
-					return d + helper::ColorShade;
-				return e;
-			}
+			//this pixel is ocean
+			return Globe::OCEAN_COLOR + shade;
 		}
 		else
 		{
-			const int d = dest & helper::ColorGroup;
-			if (d ==  Globe::OCEAN_COLOR || d ==  Globe::OCEAN_COLOR + 16)
-			{
-				//this pixel is ocean
-				return Globe::OCEAN_COLOR;
-			}
-			else
-			{
-				//this pixel is land
-				return dest;
-			}
+			//this pixel is land
+			if (dest==0) return shade;
+			const int s = shade / 3;
+			const int e = dest+s;
+			if (e > d + helper::ColorShade)
+				return d + helper::ColorShade;
+			return e;
 		}
 	}
 
+	static inline Uint8 getShadowValue(const Uint8& dest, const Cord& earth, const Cord& sun, const Sint16& noise)
+	{
+		return applyShade(dest, getShade(getDistance(earth, sun), noise));
+	}
+
 	static inline void func(Uint8& dest, const Cord& earth, const Cord& sun, const Sint16& noise)
 	{
 		if (dest && earth.z)
@@ -245,6 +256,151 @@ struct CreateShadow
 	}
 };
 
+/**
+ * Shade of pixels outside of earth.
+ */
+const Uint8 NO_EARTH = 0xFF;
+
+/**
+ * Sun movement that can change scaled distance of any pixel by at most one,
+ * smaller movements do not need the globe to be shaded again.
+ */
+const double SHADOW_SUN_STEP = 1. / 500.;
+
+/**
+ * Type of function that calculates shade of one row of globe pixels.
+ * Result is in range [0, 31] or `NO_EARTH`.
+ */
+typedef void (*ShadowRowFunc)(Uint8* shade, const Cord* earth, const Sint16* noise, int size, const Cord& sun);
+
+/**
+ * Reference implementation, every vector version need give exactly same results.
+ */
+void shadowRowScalar(Uint8* shade, const Cord* earth, const Sint16* noise, int size, const Cord& sun)
+{
+	for (int i = 0; i < size; ++i)
+	{
+		shade[i] = earth[i].z ? CreateShadow::getShade(CreateShadow::getDistance(earth[i], sun), noise[i]) : NO_EARTH;
+	}
+}
+
+#ifdef SHADER_SIMD_X86
+
+/**
+ * SSE2 version, calculate distance for 2 pixels at once.
+ */
+SHADER_TARGET("sse2")
+void shadowRowSSE2(Uint8* shade, const Cord* earth, const Sint16* noise, int size, const Cord& sun)
+{
+	const __m128d sunX = _mm_set1_pd(sun.x);
+	const __m128d sunY = _mm_set1_pd(sun.y);
+	const __m128d sunZ = _mm_set1_pd(sun.z);
+	const __m128d two = _mm_set1_pd(2.);
+	const __m128d scale = _mm_set1_pd(125.);
+
+	int i = 0;
+	for (; i + 2 <= size; i += 2)
+	{
+		const Cord* e = earth + i;
+		__m128d x = _mm_sub_pd(_mm_set_pd(e[1].x, e[0].x), sunX);
+		__m128d y = _mm_sub_pd(_mm_set_pd(e[1].y, e[0].y), sunY);
+		__m128d z = _mm_sub_pd(_mm_set_pd(e[1].z, e[0].z), sunZ);
+		x = _mm_mul_pd(x, x);
+		y = _mm_mul_pd(y, y);
+		z = _mm_mul_pd(z, z);
+		__m128d distance = _mm_add_pd(x, _mm_add_pd(z, y));
+		distance = _mm_mul_pd(_mm_sub_pd(distance, two), scale);
+
+		double d[2];
+		_mm_storeu_pd(d, distance);
+		shade[i] = e[0].z ? CreateShadow::getShade(d[0], noise[i]) : NO_EARTH;
+		shade[i + 1] = e[1].z ? CreateShadow::getShade(d[1], noise[i + 1]) : NO_EARTH;
+	}
+	shadowRowScalar(shade + i, earth + i, noise + i, size - i, sun);
+}
+
+/**
+ * AVX2 version, do 4 pixels at once.
+ */
+SHADER_TARGET("avx2")
+void shadowRowAVX2(Uint8* shade, const Cord* earth, const Sint16* noise, int size, const Cord& sun)
+{
+	const __m256d sunX = _mm256_set1_pd(sun.x);
+	const __m256d sunY = _mm256_set1_pd(sun.y);
+	const __m256d sunZ = _mm256_set1_pd(sun.z);
+	const __m256d two = _mm256_set1_pd(2.);
+	const __m256d scale = _mm256_set1_pd(125.);
+	const __m256d low = _mm256_set1_pd(-110.);
+	const __m256d high = _mm256_set1_pd(120.);
+	const __m256d zero = _mm256_setzero_pd();
+	// picks lower half of every 64bit mask
+	const __m256i halfMask = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+
+	int i = 0;
+	for (; i + 4 <= size; i += 4)
+	{
+		const Cord* e = earth + i;
+		const __m256d earthZ = _mm256_set_pd(e[3].z, e[2].z, e[1].z, e[0].z);
+		__m256d x = _mm256_sub_pd(_mm256_set_pd(e[3].x, e[2].x, e[1].x, e[0].x), sunX);
+		__m256d y = _mm256_sub_pd(_mm256_set_pd(e[3].y, e[2].y, e[1].y, e[0].y), sunY);
+		__m256d z = _mm256_sub_pd(earthZ, sunZ);
+		x = _mm256_mul_pd(x, x);
+		y = _mm256_mul_pd(y, y);
+		z = _mm256_mul_pd(z, z);
+		__m256d distance = _mm256_add_pd(x, _mm256_add_pd(z, y));
+		distance = _mm256_mul_pd(_mm256_sub_pd(distance, two), scale);
+
+		// masks with 64bit lanes shrunk to 32bit lanes
+		const __m128i isLow = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(_mm256_cmp_pd(distance, low, _CMP_LT_OQ)), halfMask));
+		const __m128i isHigh = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(_mm256_cmp_pd(distance, high, _CMP_GT_OQ)), halfMask));
+		const __m128i isOut = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(_mm256_cmp_pd(earthZ, zero, _CMP_EQ_OQ)), halfMask));
+
+		// index clamped to keep masked out lanes inside table
+		__m128i index = _mm256_cvttpd_epi32(distance);
+		index = _mm_min_epi32(_mm_max_epi32(index, _mm_set1_epi32(-120)), _mm_set1_epi32(120));
+		__m128i value = _mm_i32gather_epi32(static_data.shade_gradient + 120, index, 4);
+		value = _mm_blendv_epi8(value, _mm_set1_epi32(-31), isLow);
+		value = _mm_blendv_epi8(value, _mm_set1_epi32(50), isHigh);
+
+		__m128i n;
+		std::memcpy(&n, noise + i, 4 * sizeof(Sint16));
+		value = _mm_sub_epi32(value, _mm_cvtepi16_epi32(n));
+		value = _mm_min_epi32(_mm_max_epi32(value, _mm_setzero_si128()), _mm_set1_epi32(31));
+		value = _mm_blendv_epi8(value, _mm_set1_epi32(NO_EARTH), isOut);
+
+		value = _mm_packus_epi16(_mm_packus_epi32(value, value), value);
+		const int result = _mm_cvtsi128_si32(value);
+		std::memcpy(shade + i, &result, 4);
+	}
+	// avoid penalty of mixing AVX and SSE code
+	_mm256_zeroupper();
+	shadowRowSSE2(shade + i, earth + i, noise + i, size - i, sun);
+}
+
+#endif
+
+/**
+ * Pick best version of shadow row function for current CPU.
+ */
+ShadowRowFunc selectShadowRow()
+{
+#ifdef SHADER_SIMD_X86
+	switch (helper::getCpuVectorLevel())
+	{
+	case helper::CPU_AVX2:
+		return shadowRowAVX2;
+	case helper::CPU_SSE2:
+		return shadowRowSSE2;
+	default:
+		break;
+	}
+#endif
+	return shadowRowScalar;
+}
+
+/// Shadow row function used by `Globe::drawShadow`, selected once at startup.
+const ShadowRowFunc shadowRow = selectShadowRow();
+
 }//namespace
 
 
@@ -259,6 +415,7 @@ struct CreateShadow
  * @param y Y position in pixels.
  */
 Globe::Globe(Game* game, int cenX, int cenY, int width, int height, int x, int y) : InteractiveSurface(width, height, x, y), _rotLon(0.0), _rotLat(0.0), _hoverLon(0.0), _hoverLat(0.0), _cenX(cenX), _cenY(cenY), _game(game), _hover(false), _blink(-1),
+																					_viewVersion(0), _shadowValid(false), _radarVersion(0), _detailVersion(0), _detailEnabled(false), _detailDebug(false),
 																					_isMouseScrolling(false), _isMouseScrolled(false), _xBeforeMouseScrolling(0), _yBeforeMouseScrolling(0), _lonBeforeMouseScrolling(0.0), _latBeforeMouseScrolling(0.0), _mouseScrollingStartTime(0), _totalMouseMoveX(0), _totalMouseMoveY(0), _mouseMovedOverThreshold(false)
 {
 	_rules = game->getMod()->getGlobe();
@@ -268,6 +425,10 @@ Globe::Globe(Game* game, int cenX, int cenY, int width, int height, int x, int y
 	_countries = new Surface(width, height, x, y);
 	_markers = new Surface(width, height, x, y);
 	_radars = new Surface(width, height, x, y);
+	_land = new Surface(width, height, x, y);
+	_label = new Text(100, 9, 0, 0);
+	_label->initText(_game->getMod()->getFont("FONT_BIG"), _game->getMod()->getFont("FONT_SMALL"), _game->getLanguage());
+	_label->setAlign(ALIGN_CENTER);
 	_clipper = new FastLineClip(x, x+width, y, y+height);
 
 	// Animation timers
@@ -281,6 +442,8 @@ Globe::Globe(Game* game, int cenX, int cenY, int width, int height, int x, int y
 	_cenLat = _game->getSavedGame()->getGlobeLatitude();
 	_zoom = _game->getSavedGame()->getGlobeZoom();
 	_zoomOld = _zoom;
+	_landView = View();
+	_landView.width = -1; // never match any real view
 
 	setupRadii(width, height);
 	setZoom(_zoom);
@@ -305,9 +468,11 @@ Globe::~Globe()
 	delete _texture;
 	delete _markerSet;
 	delete _radars;
+	delete _land;
+	delete _label;
 	delete _clipper;
 
-	for (std::list<Polygon*>::iterator i = _cacheLand.begin(); i != _cacheLand.end(); ++i)
+	for (std::vector<Polygon*>::iterator i = _cacheLand.begin(); i != _cacheLand.end(); ++i)
 	{
 		delete *i;
 	}
@@ -400,46 +565,7 @@ double Globe::lastVisibleLat(double lon) const
 
 Polygon* Globe::getPolygonFromLonLat(double lon, double lat) const
 {
-	const double zDiscard=0.75f;
-	double coslat = cos(lat);
-	double sinlat = sin(lat);
-
-	for (std::list<Polygon*>::iterator i = _rules->getPolygons()->begin(); i != _rules->getPolygons()->end(); ++i)
-	{
-		double x, y, z, x2, y2;
-		double clat, clon;
-		z = 0;
-		for (int j = 0; j < (*i)->getPoints(); ++j)
-		{
-			z = coslat * cos((*i)->getLatitude(j)) * cos((*i)->getLongitude(j) - lon) + sinlat * sin((*i)->getLatitude(j));
-			if (z<zDiscard) break; //discarded
-		}
-		if (z<zDiscard) continue; //discarded
-
-		bool odd = false;
-
-		clat = (*i)->getLatitude(0); //initial point
-		clon = (*i)->getLongitude(0);
-		x = cos(clat) * sin(clon - lon);
-		y = coslat * sin(clat) - sinlat * cos(clat) * cos(clon - lon);
-
-		for (int j = 0; j < (*i)->getPoints(); ++j)
-		{
-			int k = (j + 1) % (*i)->getPoints(); //index of next point in poly
-			clat = (*i)->getLatitude(k);
-			clon = (*i)->getLongitude(k);
-
-			x2 = cos(clat) * sin(clon - lon);
-			y2 = coslat * sin(clat) - sinlat * cos(clat) * cos(clon - lon);
-			if ( ((y>0)!=(y2>0)) && (0 < (x2-x)*(0-y)/(y2-y)+x) )
-				odd = !odd;
-			x = x2;
-			y = y2;
-
-		}
-		if (odd) return *i;
-	}
-	return NULL;
+	return _rules->getPolygonFromLonLat(lon, lat);
 }
 
 /**
@@ -769,25 +895,36 @@ std::vector<Target*> Globe::getTargets(int x, int y, bool craft) const
  */
 void Globe::cachePolygons()
 {
-	cache(_rules->getPolygons(), &_cacheLand);
+	cache(_rules->getPolygons(), &_cacheLand, &_visibleLand);
 }
 
 /**
- * Caches a set of polygons.
+ * Caches a set of polygons. Copies of polygons are kept between
+ * calls and only their projected coordinates are updated.
  * @param polygons Pointer to list of polygons.
- * @param cache Pointer to cache.
+ * @param cache Pointer to cache with copy of every polygon.
+ * @param visible Pointer to list of polygons visible in current view.
  */
-void Globe::cache(std::list<Polygon*> *polygons, std::list<Polygon*> *cache)
+void Globe::cache(std::list<Polygon*> *polygons, std::vector<Polygon*> *cache, std::vector<Polygon*> *visible)
 {
-	// Clear existing cache
-	for (std::list<Polygon*>::iterator i = cache->begin(); i != cache->end(); ++i)
+	// Copy polygons only once, rules do not change during game
+	if (cache->size() != polygons->size())
 	{
-		delete *i;
+		for (std::vector<Polygon*>::iterator i = cache->begin(); i != cache->end(); ++i)
+		{
+			delete *i;
+		}
+		cache->clear();
+		cache->reserve(polygons->size());
+		for (std::list<Polygon*>::iterator i = polygons->begin(); i != polygons->end(); ++i)
+		{
+			cache->push_back(new Polygon(**i));
+		}
 	}
-	cache->clear();
+	visible->clear();
 
 	// Pre-calculate values to cache
-	for (std::list<Polygon*>::iterator i = polygons->begin(); i != polygons->end(); ++i)
+	for (std::vector<Polygon*>::iterator i = cache->begin(); i != cache->end(); ++i)
 	{
 		// Is quad on the back face?
 		double closest = 0.0;
@@ -804,7 +941,7 @@ void Globe::cache(std::list<Polygon*> *polygons, std::list<Polygon*> *cache)
 		if (-furthest > closest)
 			continue;
 
-		Polygon* p = new Polygon(**i);
+		Polygon* p = *i;
 
 		// Convert coordinates
 		for (int j = 0; j < p->getPoints(); ++j)
@@ -815,7 +952,7 @@ void Globe::cache(std::list<Polygon*> *polygons, std::list<Polygon*> *cache)
 			p->setY(j, y);
 		}
 
-		cache->push_back(p);
+		visible->push_back(p);
 	}
 }
 
@@ -835,6 +972,7 @@ void Globe::setPalette(SDL_Color *colors, int firstcolor, int ncolors)
 	_countries->setPalette(colors, firstcolor, ncolors);
 	_markers->setPalette(colors, firstcolor, ncolors);
 	_radars->setPalette(colors, firstcolor, ncolors);
+	_land->setPalette(colors, firstcolor, ncolors);
 }
 
 /**
@@ -876,21 +1014,79 @@ void Globe::rotate()
 	invalidate();
 }
 
+/**
+ * Copies all pixels between two surfaces of the same size.
+ * @param dest Destination surface.
+ * @param src Source surface.
+ */
+static void copyPixels(Surface *dest, Surface *src)
+{
+	src->lock();
+	dest->lock();
+	std::memcpy(dest->getSurface()->pixels, src->getSurface()->pixels, (size_t)dest->getSurface()->pitch * dest->getHeight());
+	dest->unlock();
+	src->unlock();
+}
+
+/**
+ * Gets the parameters of the current view of the globe.
+ * @return Current view.
+ */
+Globe::View Globe::getView() const
+{
+	View view;
+	view.lon = _cenLon;
+	view.lat = _cenLat;
+	view.radius = _radius;
+	view.x = _cenX;
+	view.y = _cenY;
+	view.width = getWidth();
+	view.height = getHeight();
+	view.zoom = _zoom;
+	return view;
+}
+
 /**
  * Draws the whole globe, part by part.
+ * Every layer is cached and only rebuilt when the state it
+ * depends on has changed: land when the view moves, shading
+ * when the sun moves by more than one shading step, detail
+ * when the view or bases change.
  */
 void Globe::draw()
 {
-	if (_redraw)
+	const View view = getView();
+	const bool viewChanged = _redraw || !(view == _landView);
+	if (viewChanged)
 	{
 		cachePolygons();
+		Surface::draw();
+		drawOcean();
+		drawLand();
+		copyPixels(_land, this);
+		_landView = view;
+		++_viewVersion;
+		_shadowValid = false;
+	}
+	_redraw = false;
+
+	const Cord sun = getSunDirection(_cenLon, _cenLat);
+	Cord sunMove = sun;
+	sunMove -= _shadowSun;
+	if (!_shadowValid || sunMove.norm() > SHADOW_SUN_STEP)
+	{
+		if (!viewChanged)
+		{
+			// restore unshaded land
+			copyPixels(this, _land);
+		}
+		drawShadow();
+		_shadowSun = sun;
+		_shadowValid = true;
 	}
-	Surface::draw();
-	drawOcean();
-	drawLand();
+
 	drawRadars();
 	drawFlights();
-	drawShadow();
 	drawMarkers();
 	drawDetail();
 }
@@ -919,7 +1115,7 @@ void Globe::drawLand()
 	Sint16 x[4], y[4];
 	int aaa = 0;
 
-	for (std::list<Polygon*>::iterator i = _cacheLand.begin(); i != _cacheLand.end(); ++i)
+	for (std::vector<Polygon*>::iterator i = _visibleLand.begin(); i != _visibleLand.end(); ++i)
 	{
 		// Convert coordinates
 		for (int j = 0; j < (*i)->getPoints(); ++j)
@@ -993,17 +1189,56 @@ Cord Globe::getSunDirection(double lon, double lat) const
 }
 
 
+/**
+ * Shades the globe according to the time of day.
+ * Rows of the globe are split between all threads.
+ */
 void Globe::drawShadow()
 {
-	ShaderMove<Cord> earth = ShaderMove<Cord>(_earthData[_zoom], getWidth(), getHeight());
-	ShaderRepeat<Sint16> noise = ShaderRepeat<Sint16>(_randomNoiseData, static_data.random_surf_size, static_data.random_surf_size);
-
-	earth.setMove(_cenX-getWidth()/2, _cenY-getHeight()/2);
+	const Cord sun = getSunDirection(_cenLon, _cenLat);
+	const std::vector<Cord> &earth = _earthData[_zoom];
+	const std::vector<Sint16> &noise = _randomNoiseData;
+	const int noiseSize = static_data.random_surf_size;
+	const int width = getWidth();
+	const int height = getHeight();
+
+	// earth and noise are placed the same way as `ShaderMove` and `ShaderRepeat` would do it
+	const int moveX = _cenX - width/2;
+	const int moveY = _cenY - height/2;
+	const int beginX = std::max((int)getX(), moveX);
+	const int endX = std::min(getX() + width, moveX + width);
+	const int beginY = std::max((int)getY(), moveY);
+	const int endY = std::min(getY() + height, moveY + height);
+	if (beginX >= endX || beginY >= endY)
+		return;
 
 	lock();
-	ShaderDraw<CreateShadow>(ShaderSurface(this), earth, ShaderScalar(getSunDirection(_cenLon, _cenLat)), noise);
-	unlock();
+	SDL_Surface *surface = getSurface();
+	auto band = [&](int begin, int end)
+	{
+		const int size = endX - beginX;
+		std::vector<Sint16> noiseRow(size);
+		std::vector<Uint8> shade(size);
+		for (int y = beginY + begin; y < beginY + end; ++y)
+		{
+			const Sint16 *n = &noise[((y % noiseSize + noiseSize) % noiseSize) * noiseSize];
+			for (int x = 0; x < size; ++x)
+			{
+				noiseRow[x] = n[((beginX + x) % noiseSize + noiseSize) % noiseSize];
+			}
 
+			shadowRow(&shade[0], &earth[(y - moveY) * width + (beginX - moveX)], &noiseRow[0], size, sun);
+
+			Uint8 *dest = (Uint8*)surface->pixels + (y - getY()) * surface->pitch + (beginX - getX());
+			for (int x = 0; x < size; ++x)
+			{
+				dest[x] = (dest[x] && shade[x] != NO_EARTH) ? CreateShadow::applyShade(dest[x], shade[x]) : 0;
+			}
+		}
+	};
+	ThreadPool &pool = ThreadPool::getShared();
+	pool.parallelFor(endY - beginY, std::max(8, (endY - beginY) / (pool.getThreadCount() * 4)), band);
+	unlock();
 }
 
 
@@ -1076,6 +1311,8 @@ void Globe::XuLine(Surface* surface, Surface* src, double x1, double y1, double
 
 /**
  * Draws the radar ranges of player bases on the globe.
+ * Circles are only projected again when the view or
+ * the radar ranges of bases and craft have changed.
  */
 void Globe::drawRadars()
 {
@@ -1086,8 +1323,7 @@ void Globe::drawRadars()
 	double tr, range;
 	double lat, lon;
 	std::vector<double> ranges;
-
-	_radars->lock();
+	std::vector<Circle> circles;
 
 	if (_hover)
 	{
@@ -1096,7 +1332,8 @@ void Globe::drawRadars()
 		{
 			range=_game->getMod()->getBaseFacility(*i)->getRadarRange();
 			range = range * (1 / 60.0) * (M_PI / 180);
-			drawGlobeCircle(_hoverLat,_hoverLon,range,48);
+			Circle circle = { _hoverLat, _hoverLon, range, 48 };
+			circles.push_back(circle);
 			if (Options::globeAllRadarsOnBaseBuild) ranges.push_back(range);
 		}
 	}
@@ -1112,7 +1349,11 @@ void Globe::drawRadars()
 		{
 			if (_hover && Options::globeAllRadarsOnBaseBuild)
 			{
-				for (size_t j=0; j<ranges.size(); j++) drawGlobeCircle(lat,lon,ranges[j],48);
+				for (size_t j=0; j<ranges.size(); j++)
+				{
+					Circle circle = { lat, lon, ranges[j], 48 };
+					circles.push_back(circle);
+				}
 			}
 			else
 			{
@@ -1127,7 +1368,11 @@ void Globe::drawRadars()
 				}
 				range = range * (1 / 60.0) * (M_PI / 180);
 
-				if (range>0) drawGlobeCircle(lat,lon,range,48);
+				if (range>0)
+				{
+					Circle circle = { lat, lon, range, 48 };
+					circles.push_back(circle);
+				}
 			}
 
 		}
@@ -1141,21 +1386,44 @@ void Globe::drawRadars()
 			range = (*j)->getCraftStats().radarRange;
 			range = range * (1 / 60.0) * (M_PI / 180);
 
-			if (range>0) drawGlobeCircle(lat,lon,range,24);
+			if (range>0)
+			{
+				Circle circle = { lat, lon, range, 24 };
+				circles.push_back(circle);
+			}
+		}
+	}
+
+	if (_radarVersion != _viewVersion || circles != _radarCircles)
+	{
+		_radarSegments.clear();
+		for (std::vector<Circle>::const_iterator i = circles.begin(); i != circles.end(); ++i)
+		{
+			cacheGlobeCircle(*i);
 		}
+		_radarCircles.swap(circles);
+		_radarVersion = _viewVersion;
 	}
 
+	// lines take their colors from the unshaded globe, same as when radars were drawn before the shadow
+	_radars->lock();
+	for (std::vector<Segment>::const_iterator i = _radarSegments.begin(); i != _radarSegments.end(); ++i)
+	{
+		XuLine(_radars, _land, i->x1, i->y1, i->x2, i->y2, 6);
+	}
 	_radars->unlock();
 }
 
 /**
- *	Draw globe range circle
+ *	Projects globe range circle to visible line segments.
+ *	@param circle Circle to project.
  */
-void Globe::drawGlobeCircle(double lat, double lon, double radius, int segments)
+void Globe::cacheGlobeCircle(const Circle &circle)
 {
+	const double lat = circle.lat, lon = circle.lon, radius = circle.radius;
 	double x, y, x2 = 0, y2 = 0;
 	double lat1, lon1;
-	double seg = M_PI / (static_cast<double>(segments) / 2);
+	double seg = M_PI / (static_cast<double>(circle.segments) / 2);
 	for (double az = 0; az <= M_PI*2+0.01; az+=seg) //48 circle segments
 	{
 		//calculating sphere-projected circle
@@ -1169,7 +1437,10 @@ void Globe::drawGlobeCircle(double lat, double lon, double radius, int segments)
 			continue;
 		}
 		if (!pointBack(lon1,lat1))
-			XuLine(_radars, this, x, y, x2, y2, 6);
+		{
+			Segment segment = { x, y, x2, y2 };
+			_radarSegments.push_back(segment);
+		}
 		x2=x; y2=y;
 	}
 }
@@ -1238,10 +1509,30 @@ void Globe::drawVHLine(Surface *surface, double lon1, double lat1, double lon2,
 
 /**
  * Draws the details of the countries on the globe,
- * based on the current zoom level.
+ * based on the current zoom level. The layer is kept
+ * as long as the view and the names of bases do not change.
  */
 void Globe::drawDetail()
 {
+	const bool debug = _game->getSavedGame()->getDebugMode();
+	std::vector<BaseLabel> bases;
+	if (Options::globeDetail && _zoom >= 3)
+	{
+		for (std::vector<Base*>::iterator j = _game->getSavedGame()->getBases()->begin(); j != _game->getSavedGame()->getBases()->end(); ++j)
+		{
+			BaseLabel base = { (*j)->getLongitude(), (*j)->getLatitude(), (*j)->getMarker(), (*j)->getName() };
+			bases.push_back(base);
+		}
+	}
+	if (!debug && !_detailDebug && _detailVersion == _viewVersion && _detailEnabled == Options::globeDetail && bases == _detailBases)
+	{
+		return;
+	}
+	_detailVersion = _viewVersion;
+	_detailEnabled = Options::globeDetail;
+	_detailDebug = debug;
+	_detailBases.swap(bases);
+
 	_countries->clear();
 
 	if (!Options::globeDetail)
@@ -1277,10 +1568,8 @@ void Globe::drawDetail()
 	// Draw the country names
 	if (_zoom >= 2)
 	{
-		Text *label = new Text(100, 9, 0, 0);
+		Text *label = _label;
 		label->setPalette(getPalette());
-		label->initText(_game->getMod()->getFont("FONT_BIG"), _game->getMod()->getFont("FONT_SMALL"), _game->getLanguage());
-		label->setAlign(ALIGN_CENTER);
 		label->setColor(COUNTRY_LABEL_COLOR);
 
 		Sint16 x, y;
@@ -1298,17 +1587,13 @@ void Globe::drawDetail()
 			label->setText(_game->getLanguage()->getString((*i)->getRules()->getType()));
 			label->blit(_countries);
 		}
-
-		delete label;
 	}
 
 	// Draw the city and base markers
 	if (_zoom >= 3)
 	{
-		Text *label = new Text(100, 9, 0, 0);
+		Text *label = _label;
 		label->setPalette(getPalette());
-		label->initText(_game->getMod()->getFont("FONT_BIG"), _game->getMod()->getFont("FONT_SMALL"), _game->getLanguage());
-		label->setAlign(ALIGN_CENTER);
 		label->setColor(CITY_LABEL_COLOR);
 
 		Sint16 x, y;
@@ -1332,19 +1617,17 @@ void Globe::drawDetail()
 			}
 		}
 		// Draw bases names
-		for (std::vector<Base*>::iterator j = _game->getSavedGame()->getBases()->begin(); j != _game->getSavedGame()->getBases()->end(); ++j)
+		for (std::vector<BaseLabel>::const_iterator j = _detailBases.begin(); j != _detailBases.end(); ++j)
 		{
-			if ((*j)->getMarker() == -1 || pointBack((*j)->getLongitude(), (*j)->getLatitude()))
+			if (j->marker == -1 || pointBack(j->lon, j->lat))
 				continue;
-			polarToCart((*j)->getLongitude(), (*j)->getLatitude(), &x, &y);
+			polarToCart(j->lon, j->lat, &x, &y);
 			label->setX(x - 50);
 			label->setY(y + 2);
 			label->setColor(BASE_LABEL_COLOR);
-			label->setText((*j)->getName());
+			label->setText(j->name);
 			label->blit(_countries);
 		}
-
-		delete label;
 	}
 
 	static int debugType = 0;
@@ -1844,11 +2127,11 @@ void Globe::toggleRadarLines()
  */
 void Globe::resize()
 {
-	Surface *surfaces[4] = {this, _markers, _countries, _radars};
+	Surface *surfaces[5] = {this, _markers, _countries, _radars, _land};
 	int width = Options::baseXGeoscape - 64;
 	int height = Options::baseYGeoscape;
 
-	for (int i = 0; i < 4; ++i)
+	for (int i = 0; i < 5; ++i)
 	{
 		surfaces[i]->setWidth(width);
 		surfaces[i]->setHeight(height);
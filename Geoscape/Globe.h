@@ -19,6 +19,7 @@
  */
 #include <vector>
 #include <list>
+#include <string>
 #include "../Engine/InteractiveSurface.h"
 #include "../Engine/FastLineClip.h"
 #include "Cord.h"
@@ -33,6 +34,7 @@ class Timer;
 class Target;
 class LocalizedText;
 class RuleGlobe;
+class Text;
 
 /**
  * Interactive globe view of the world.
@@ -61,7 +63,10 @@ private:
 	bool _hover;
 	int _blink;
 	Timer *_blinkTimer, *_rotTimer;
-	std::list<Polygon*> _cacheLand;
+	///copy of every land polygon, used as buffer of projected vertices
+	std::vector<Polygon*> _cacheLand;
+	///land polygons facing the viewer in the current view
+	std::vector<Polygon*> _visibleLand;
 	FastLineClip *_clipper;
 	double _radius, _radiusStep;
 	///normal of each pixel in earth globe per zoom level
@@ -71,6 +76,74 @@ private:
 	///list of dimension of earth on screen per zoom level
 	std::vector<double> _zoomRadius;
 
+	/**
+	 * Parameters of a view of the globe, cached layers are valid only for the view they were drawn for.
+	 */
+	struct View
+	{
+		double lon, lat, radius;
+		Sint16 x, y;
+		int width, height;
+		size_t zoom;
+
+		bool operator==(const View &other) const
+		{
+			return lon == other.lon && lat == other.lat && radius == other.radius && x == other.x && y == other.y && width == other.width && height == other.height && zoom == other.zoom;
+		}
+	};
+	/**
+	 * Radar range circle on the globe.
+	 */
+	struct Circle
+	{
+		double lat, lon, radius;
+		int segments;
+
+		bool operator==(const Circle &other) const
+		{
+			return lat == other.lat && lon == other.lon && radius == other.radius && segments == other.segments;
+		}
+	};
+	/**
+	 * Projected segment of a radar range circle.
+	 */
+	struct Segment
+	{
+		double x1, y1, x2, y2;
+	};
+	/**
+	 * Name of a player base drawn on the detail layer.
+	 */
+	struct BaseLabel
+	{
+		double lon, lat;
+		int marker;
+		std::wstring name;
+
+		bool operator==(const BaseLabel &other) const
+		{
+			return lon == other.lon && lat == other.lat && marker == other.marker && name == other.name;
+		}
+	};
+	///unshaded ocean and land of the current view
+	Surface *_land;
+	///reusable label for country, city and base names
+	Text *_label;
+	///view of land layer, version is bumped each time view changes
+	View _landView;
+	unsigned _viewVersion;
+	///sun direction used to shade current content of globe
+	Cord _shadowSun;
+	bool _shadowValid;
+	///radar circles and their projection
+	std::vector<Circle> _radarCircles;
+	std::vector<Segment> _radarSegments;
+	unsigned _radarVersion;
+	///state of detail layer
+	std::vector<BaseLabel> _detailBases;
+	unsigned _detailVersion;
+	bool _detailEnabled, _detailDebug;
+
 	bool _isMouseScrolling, _isMouseScrolled;
 	int _xBeforeMouseScrolling, _yBeforeMouseScrolling;
 	double _lonBeforeMouseScrolling, _latBeforeMouseScrolling;
@@ -89,11 +162,13 @@ private:
 	/// Checks if a target is near a point.
 	bool targetNear(Target* target, int x, int y) const;
 	/// Caches a set of polygons.
-	void cache(std::list<Polygon*> *polygons, std::list<Polygon*> *cache);
+	void cache(std::list<Polygon*> *polygons, std::vector<Polygon*> *cache, std::vector<Polygon*> *visible);
 	/// Get position of sun relative to given position in polar cords and date.
 	Cord getSunDirection(double lon, double lat) const;
-	/// Draw globe range circle.
-	void drawGlobeCircle(double lat, double lon, double radius, int segments);
+	/// Gets current view of the globe.
+	View getView() const;
+	/// Projects globe range circle.
+	void cacheGlobeCircle(const Circle &circle);
 	/// Special "transparent" line.
 	void XuLine(Surface* surface, Surface* src, double x1, double y1, double x2, double y2, int shade);
 	/// Draw line on globe surface.
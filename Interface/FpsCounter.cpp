@@ -18,10 +18,12 @@
  */
 
 #include "FpsCounter.h"
+#include <algorithm>
 #include <cmath>
 #include "../Engine/Action.h"
 #include "../Engine/Timer.h"
 #include "../Engine/Options.h"
+#include "../Engine/CrossPlatform.h"
 #include "NumberText.h"
 
 namespace OpenXcom
@@ -29,12 +31,13 @@ namespace OpenXcom
 
 /**
  * Creates a FPS counter of the specified size.
+ * The frame time deviation is shown in a second row below the FPS.
  * @param width Width in pixels.
  * @param height Height in pixels.
  * @param x X position in pixels.
  * @param y Y position in pixels.
  */
-FpsCounter::FpsCounter(int width, int height, int x, int y) : Surface(width, height, x, y), _frames(0)
+FpsCounter::FpsCounter(int width, int height, int x, int y) : Surface(width, height, x, y), _frames(0), _intervals(0), _lastFrame(0), _intervalSum(0), _intervalSquares(0)
 {
 	_visible = Options::fpsCounter;
 
@@ -43,6 +46,7 @@ FpsCounter::FpsCounter(int width, int height, int x, int y) : Surface(width, hei
 	_timer->start();
 
 	_text = new NumberText(width, height, x, y);
+	_deviation = new NumberText(width, height - 6, x, y + 6);
 }
 
 /**
@@ -51,6 +55,7 @@ FpsCounter::FpsCounter(int width, int height, int x, int y) : Surface(width, hei
 FpsCounter::~FpsCounter()
 {
 	delete _text;
+	delete _deviation;
 	delete _timer;
 }
 
@@ -64,6 +69,7 @@ void FpsCounter::setPalette(SDL_Color *colors, int firstcolor, int ncolors)
 {
 	Surface::setPalette(colors, firstcolor, ncolors);
 	_text->setPalette(colors, firstcolor, ncolors);
+	_deviation->setPalette(colors, firstcolor, ncolors);
 }
 
 /**
@@ -73,6 +79,7 @@ void FpsCounter::setPalette(SDL_Color *colors, int firstcolor, int ncolors)
 void FpsCounter::setColor(Uint8 color)
 {
 	_text->setColor(color);
+	_deviation->setColor(color);
 }
 
 /**
@@ -97,13 +104,25 @@ void FpsCounter::think()
 }
 
 /**
- * Updates the amount of Frames per Second.
+ * Updates the amount of Frames per Second
+ * and the standard deviation of frame times in milliseconds.
  */
 void FpsCounter::update()
 {
 	int fps = (int)floor((double)_frames / _timer->getTime() * 1000);
+	int deviation = 0;
+	if (_intervals > 0)
+	{
+		const double mean = _intervalSum / _intervals;
+		fps = (int)floor(1000000.0 / mean + 0.5);
+		deviation = (int)floor(sqrt(std::max(0.0, _intervalSquares / _intervals - mean * mean)) / 1000.0 + 0.5);
+	}
 	_text->setValue(fps);
+	_deviation->setValue(deviation);
 	_frames = 0;
+	_intervals = 0;
+	_intervalSum = 0;
+	_intervalSquares = 0;
 	_redraw = true;
 }
 
@@ -114,10 +133,23 @@ void FpsCounter::draw()
 {
 	Surface::draw();
 	_text->blit(this);
+	_deviation->blit(this);
 }
 
+/**
+ * Records a new frame and the time passed since the previous one.
+ */
 void FpsCounter::addFrame()
 {
+	const Uint64 now = CrossPlatform::getMonotonicTime();
+	if (_lastFrame != 0)
+	{
+		const double interval = (double)(now - _lastFrame);
+		_intervalSum += interval;
+		_intervalSquares += interval * interval;
+		_intervals++;
+	}
+	_lastFrame = now;
 	_frames++;
 }
 
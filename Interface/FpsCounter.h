@@ -28,14 +28,17 @@ class Action;
 
 /**
  * Counts the amount of frames each second
- * and displays them in a NumberText surface.
+ * and displays them in a NumberText surface,
+ * along with how much the time between frames varies.
  */
 class FpsCounter : public Surface
 {
 private:
-	NumberText *_text;
+	NumberText *_text, *_deviation;
 	Timer *_timer;
-	int _frames;
+	int _frames, _intervals;
+	Uint64 _lastFrame;
+	double _intervalSum, _intervalSquares;
 public:
 	/// Creates a new FPS counter linked to a game.
 	FpsCounter(int width, int height, int x, int y);
@@ -53,6 +56,7 @@ public:
 	void update();
 	/// Draws the FPS counter.
 	void draw();
+	/// Records a new frame.
 	void addFrame();
 };
 
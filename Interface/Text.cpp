@@ -35,7 +35,7 @@ namespace OpenXcom
  * @param x X position in pixels.
  * @param y Y position in pixels.
  */
-Text::Text(int width, int height, int x, int y) : InteractiveSurface(width, height, x, y), _big(0), _small(0), _font(0), _lang(0), _wrap(false), _invert(false), _contrast(false), _indent(false), _align(ALIGN_LEFT), _valign(ALIGN_TOP), _color(0), _color2(0)
+Text::Text(int width, int height, int x, int y) : InteractiveSurface(width, height, x, y), _big(0), _small(0), _font(0), _lang(0), _wrap(false), _invert(false), _contrast(false), _indent(false), _layoutFont(0), _layoutWidth(-1), _align(ALIGN_LEFT), _valign(ALIGN_TOP), _color(0), _color2(0)
 {
 }
 
@@ -151,6 +151,7 @@ void Text::initText(Font *big, Font *small, Language *lang)
 	_small = small;
 	_lang = lang;
 	_font = _small;
+	_layoutFont = 0;
 	processText();
 }
 
@@ -161,6 +162,7 @@ void Text::initText(Font *big, Font *small, Language *lang)
 void Text::setText(const std::wstring &text)
 {
 	_text = text;
+	_layoutFont = 0;
 	processText();
 	// If big text won't fit the space, try small text
 	if (_font == _big && (getTextWidth() > getWidth() || getTextHeight() > getHeight()) && _text[_text.size()-1] != L'.')
@@ -191,6 +193,7 @@ void Text::setWordWrap(bool wrap, bool indent)
 	{
 		_wrap = wrap;
 		_indent = indent;
+		_layoutFont = 0;
 		processText();
 	}
 }
@@ -357,6 +360,8 @@ int Text::getTextWidth(int line) const
 /**
  * Takes care of any text post-processing like calculating
  * line metrics for alignment and wordwrapping if necessary.
+ * The layout is only redone when the text, font, wrapping
+ * or width changed since the last call.
  */
 void Text::processText()
 {
@@ -364,19 +369,39 @@ void Text::processText()
 	{
 		return;
 	}
+	int width = _wrap ? getWidth() : 0;
+	if (_font == _layoutFont && width == _layoutWidth)
+	{
+		return;
+	}
+	_layoutFont = _font;
+	_layoutWidth = width;
 
-	std::wstring *str = &_text;
-
+	_lineWidth.clear();
+	_lineHeight.clear();
 	// Use a separate string for wordwrapping text
 	if (_wrap)
 	{
 		_wrappedText = _text;
-		str = &_wrappedText;
+		layoutText(&_wrappedText, _lineWidth, _lineHeight);
+	}
+	else
+	{
+		layoutText(&_text, _lineWidth, _lineHeight);
 	}
 
-	_lineWidth.clear();
-	_lineHeight.clear();
+	_redraw = true;
+}
 
+/**
+ * Calculates line metrics of the text, replacing unknown characters
+ * and inserting line breaks for wordwrapping if it's enabled.
+ * @param str Text to process, modified in place.
+ * @param lineWidth Width of each line.
+ * @param lineHeight Height of each line.
+ */
+void Text::layoutText(std::wstring *str, std::vector<int> &lineWidth, std::vector<int> &lineHeight) const
+{
 	int width = 0, word = 0;
 	size_t space = 0, textIndentation = 0;
 	bool start = true;
@@ -389,8 +414,8 @@ void Text::processText()
 		if (c == str->size() || Font::isLinebreak((*str)[c]))
 		{
 			// Add line measurements for alignment later
-			_lineWidth.push_back(width);
-			_lineHeight.push_back(font->getCharSize(L'\n').h);
+			lineWidth.push_back(width);
+			lineHeight.push_back(font->getCharSize(L'\n').h);
 			width = 0;
 			word = 0;
 			start = true;
@@ -417,7 +442,7 @@ void Text::processText()
 		// Keep track of the width of the last line and word
 		else if ((*str)[c] != 1)
 		{
-			if (font->getChar((*str)[c]) == 0)
+			if (font->getGlyph((*str)[c]) == 0)
 			{
 				(*str)[c] = L'?';
 			}
@@ -466,8 +491,8 @@ void Text::processText()
 					width += font->getCharSize(L' ').w + font->getCharSize(L'\xA0').w;
 				}
 
-				_lineWidth.push_back(width);
-				_lineHeight.push_back(font->getCharSize(L'\n').h);
+				lineWidth.push_back(width);
+				lineHeight.push_back(font->getCharSize(L'\n').h);
 				if (_lang->getTextWrapping() == WRAP_WORDS)
 				{
 					width = word;
@@ -480,8 +505,6 @@ void Text::processText()
 			}
 		}
 	}
-
-	_redraw = true;
 }
 
 namespace
@@ -642,10 +665,11 @@ void Text::draw()
 		{
 			if (dir < 0)
 				x += dir * font->getCharSize(*c).w;
-			Surface* chr = font->getChar(*c);
-			chr->setX(x);
-			chr->setY(y);
-			ShaderDraw<PaletteShift>(ShaderSurface(this, 0, 0), ShaderCrop(chr), ShaderScalar(color), ShaderScalar(mul), ShaderScalar(mid));
+			const FontGlyph *glyph = font->getGlyph(*c);
+			if (glyph != 0)
+			{
+				ShaderDraw<PaletteShift>(ShaderSurface(this, 0, 0), ShaderCrop(glyph->surface, glyph->rect, x, y), ShaderScalar(color), ShaderScalar(mul), ShaderScalar(mid));
+			}
 			if (dir > 0)
 				x += dir * font->getCharSize(*c).w;
 		}
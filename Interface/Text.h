@@ -45,12 +45,16 @@ private:
 	std::wstring _text, _wrappedText;
 	std::vector<int> _lineWidth, _lineHeight;
 	bool _wrap, _invert, _contrast, _indent;
+	Font *_layoutFont;
+	int _layoutWidth;
 	TextHAlign _align;
 	TextVAlign _valign;
 	Uint8 _color, _color2;
 
 	/// Processes the contained text.
 	void processText();
+	/// Calculates line breaks and metrics of a string.
+	void layoutText(std::wstring *str, std::vector<int> &lineWidth, std::vector<int> &lineHeight) const;
 	/// Gets the X position of a text line.
 	int getLineX(int line) const;
 public:
@@ -339,12 +339,12 @@ void TextList::addRow(int cols, ...)
 			{
 				if (_align[i] != ALIGN_RIGHT)
 				{
-					w += _font->getChar('.')->getCrop()->w + _font->getSpacing();
+					w += _font->getGlyph('.')->rect.w + _font->getSpacing();
 					buf += '.';
 				}
 				if (_align[i] != ALIGN_LEFT)
 				{
-					w += _font->getChar('.')->getCrop()->w + _font->getSpacing();
+					w += _font->getGlyph('.')->rect.w + _font->getSpacing();
 					buf.insert(0, 1, '.');
 				}
 			}
@@ -943,7 +943,8 @@ void TextList::draw()
 		{
 			y -= _font->getHeight() + _font->getSpacing();
 		}
-		for (size_t i = _rows[_scroll]; i < _texts.size() && i < _rows[_scroll] + _visibleRows; ++i)
+		// only rows that end up on the surface get drawn, no matter how long the list is
+		for (size_t i = _rows[_scroll]; i < _texts.size() && i < _rows[_scroll] + _visibleRows && y < getHeight(); ++i)
 		{
 			for (std::vector<Text*>::iterator j = _texts[i].begin(); j < _texts[i].end(); ++j)
 			{
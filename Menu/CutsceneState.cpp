@@ -78,12 +78,12 @@ void CutsceneState::init()
 	if (!videoRule->getVideos()->empty())
 	{
 		std::string file = FileMap::getFilePath(videoRule->getVideos()->front());
-		fmv = CrossPlatform::fileExists(file);
+		fmv = FileMap::fileExists(file);
 	}
 	if (!videoRule->getSlides()->empty())
 	{
 		std::string file = FileMap::getFilePath(videoRule->getSlides()->front().imagePath);
-		slide = CrossPlatform::fileExists(file);
+		slide = FileMap::fileExists(file);
 	}
 
 	if (fmv && (!slide || Options::preferredVideo == VIDEO_FMV))
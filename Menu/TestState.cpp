@@ -28,6 +28,9 @@
 #include "../Engine/SurfaceSet.h"
 #include "../Engine/Surface.h"
 #include "../Engine/Exception.h"
+#include "../Engine/Language.h"
+#include "../Engine/Logger.h"
+#include "../Engine/ShaderSimd.h"
 #include "../Interface/TextButton.h"
 #include "../Interface/Window.h"
 #include "../Interface/Text.h"
@@ -82,6 +85,11 @@ TestState::TestState()
 	_text->setVerticalAlign(ALIGN_MIDDLE);
 	//_text->setText(tr("STR_COUNCIL_TERMINATED"));
 
+	// check that all vector versions of shaders this CPU can run draw same pixels as the plain one
+	std::string shaders = helper::checkShadeRows();
+	Log(LOG_INFO) << "Row shaders:\n" << shaders;
+	_text->setText(Language::utf8ToWstr(shaders));
+
 	_list->setColor(Palette::blockOffset(15)+1);
 	_list->setColumns(3, 100, 50, 100);
 	_list->addRow(2, L"a", L"b");
@@ -325,7 +325,14 @@ static struct AudioSequence
 	FlcPlayer *_flcPlayer;
 
 	AudioSequence(Mod *mod, FlcPlayer *flcPlayer) : mod(mod), m(0), s(0), trackPosition(0), _flcPlayer(flcPlayer)
-	{ }
+	{
+#ifndef __NO_MUSIC
+		// music is loaded on demand, don't let it stall the video
+		mod->getMusic("GMINTRO1", false);
+		mod->getMusic("GMINTRO2", false);
+		mod->getMusic("GMINTRO3", false);
+#endif
+	}
 
 	void operator()()
 	{
@@ -431,7 +438,7 @@ void VideoState::init()
 	{
 		std::string videoFileName = FileMap::getFilePath(*it);
 
-		if (!CrossPlatform::fileExists(videoFileName))
+		if (!FileMap::fileExists(videoFileName))
 		{
 			continue;
 		}
@@ -21,6 +21,7 @@
 #include "MapBlock.h"
 #include "../Battlescape/Position.h"
 #include "../Engine/Exception.h"
+#include "../Engine/FileMap.h"
 
 namespace YAML
 {
@@ -57,7 +58,7 @@ namespace OpenXcom
 /**
  * MapBlock construction.
  */
-MapBlock::MapBlock(const std::string &name):_name(name), _size_x(10), _size_y(10), _size_z(4)
+MapBlock::MapBlock(const std::string &name):_name(name), _size_x(10), _size_y(10), _size_z(4), _mapSizeX(0), _mapSizeY(0), _mapSizeZ(0), _mapLoaded(false), _routesLoaded(false)
 {
 	_groups.push_back(0);
 }
@@ -203,4 +204,129 @@ const std::map<std::string, std::pair<int, int> > *MapBlock::getItemsFuseTimers(
 	return &_itemsFuseTimer;
 }
 
+/**
+ * Reads all whole records of a file.
+ * @param file Opened file.
+ * @param size Size of one record.
+ * @param data Records are appended to it.
+ */
+static void readRecords(std::istream &file, size_t size, std::vector<unsigned char> &data)
+{
+	unsigned char record[24];
+	while (file.read((char*)record, size))
+	{
+		data.insert(data.end(), record, record + size);
+	}
+}
+
+/**
+ * Gets the content of the MAP file of this block. The file is only read the first time,
+ * later battles reuse the data kept in memory.
+ * @param sizeX Set to the width stored in the file.
+ * @param sizeY Set to the length stored in the file.
+ * @param sizeZ Set to the height stored in the file.
+ * @return Four terrain object IDs per tile, starting from the top level.
+ * @sa http://www.ufopaedia.org/index.php?title=MAPS
+ */
+const std::vector<unsigned char> &MapBlock::getMapData(int *sizeX, int *sizeY, int *sizeZ)
+{
+	if (!_mapLoaded)
+	{
+		std::string filename = "MAPS/" + _name + ".MAP";
+		std::unique_ptr<std::istream> mapFile = FileMap::openFile(FileMap::getFilePath(filename));
+		if (!*mapFile)
+		{
+			throw Exception(filename + " not found");
+		}
+
+		char size[3];
+		std::vector<unsigned char> data;
+		mapFile->read((char*)&size, sizeof(size));
+		readRecords(*mapFile, 4, data);
+		if (!mapFile->eof())
+		{
+			throw Exception("Invalid MAP file: " + filename);
+		}
+		_mapSizeY = (int)size[0];
+		_mapSizeX = (int)size[1];
+		_mapSizeZ = (int)size[2];
+		_mapData.swap(data);
+		_mapLoaded = true;
+	}
+	*sizeX = _mapSizeX;
+	*sizeY = _mapSizeY;
+	*sizeZ = _mapSizeZ;
+	return _mapData;
+}
+
+/**
+ * Gets the content of the RMP file of this block. The file is only read the first time,
+ * later battles reuse the data kept in memory.
+ * @return Records of 24 bytes, one for each node.
+ * @sa http://www.ufopaedia.org/index.php?title=ROUTES
+ */
+const std::vector<unsigned char> &MapBlock::getRouteData()
+{
+	if (!_routesLoaded)
+	{
+		std::string filename = "ROUTES/" + _name + ".RMP";
+		std::unique_ptr<std::istream> mapFile = FileMap::openFile(FileMap::getFilePath(filename));
+		if (!*mapFile)
+		{
+			throw Exception(filename + " not found");
+		}
+
+		std::vector<unsigned char> data;
+		readRecords(*mapFile, 24, data);
+		if (!mapFile->eof())
+		{
+			throw Exception("Invalid RMP file: " + filename);
+		}
+		_routeData.swap(data);
+		_routesLoaded = true;
+	}
+	return _routeData;
+}
+
+/**
+ * Reads the MAP and RMP files of this block ahead of time.
+ * Safe to call from a worker thread as long as no other thread
+ * uses this block. Errors are ignored here, they are reported
+ * again when the map generator asks for the data.
+ */
+void MapBlock::preload()
+{
+	try
+	{
+		int sizeX, sizeY, sizeZ;
+		getMapData(&sizeX, &sizeY, &sizeZ);
+		getRouteData();
+	}
+	catch (Exception &)
+	{
+		// thrown again by the generator, with the same message
+	}
+}
+
+/**
+ * Frees the data read from the MAP and RMP files,
+ * they are read again the next time they're needed.
+ */
+void MapBlock::unloadData()
+{
+	std::vector<unsigned char>().swap(_mapData);
+	std::vector<unsigned char>().swap(_routeData);
+	_mapLoaded = false;
+	_routesLoaded = false;
+}
+
+/**
+ * Gets the amount of memory used by the data read from the MAP and RMP files.
+ * @return Size in bytes, zero if nothing is loaded.
+ */
+size_t MapBlock::getMemoryUsage() const
+{
+	return _mapData.capacity() + _routeData.capacity();
+}
+
 }
@@ -52,6 +52,9 @@ private:
 	std::map<std::string, std::vector<Position> > _items;
 	std::vector<RandomizedItems> _randomizedItems;
 	std::map<std::string, std::pair<int, int> > _itemsFuseTimer;
+	std::vector<unsigned char> _mapData, _routeData;
+	int _mapSizeX, _mapSizeY, _mapSizeZ;
+	bool _mapLoaded, _routesLoaded;
 public:
 	MapBlock(const std::string &name);
 	~MapBlock();
@@ -77,6 +80,16 @@ public:
 	const std::vector<RandomizedItems> *getRandomizedItems() const;
 	/// Gets the fuse timer for any items that belong in this map block.
 	const std::map<std::string, std::pair<int, int> > *getItemsFuseTimers() const;
+	/// Gets the tiles from the MAP file, reading it only once.
+	const std::vector<unsigned char> &getMapData(int *sizeX, int *sizeY, int *sizeZ);
+	/// Gets the nodes from the RMP file, reading it only once.
+	const std::vector<unsigned char> &getRouteData();
+	/// Reads the MAP and RMP files ahead of time.
+	void preload();
+	/// Frees the data read from the MAP and RMP files.
+	void unloadData();
+	/// Gets the memory used by the MAP and RMP data.
+	size_t getMemoryUsage() const;
 
 };
 
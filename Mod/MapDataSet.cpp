@@ -160,13 +160,13 @@ void MapDataSet::loadData()
 
 	// Load Terrain Data from MCD file
 	std::string fname = "TERRAIN/" + _name + ".MCD";
-	std::ifstream mapFile(FileMap::getFilePath(fname).c_str(), std::ios::in | std::ios::binary);
-	if (!mapFile)
+	std::unique_ptr<std::istream> mapFile = FileMap::openFile(FileMap::getFilePath(fname));
+	if (!*mapFile)
 	{
 		throw Exception(fname + " not found");
 	}
 
-	while (mapFile.read((char*)&mcd, sizeof(MCD)))
+	while (mapFile->read((char*)&mcd, sizeof(MCD)))
 	{
 		MapData *to = new MapData(this);
 		_objects.push_back(to);
@@ -213,12 +213,11 @@ void MapDataSet::loadData()
 	}
 
 
-	if (!mapFile.eof())
+	if (!mapFile->eof())
 	{
 		throw Exception("Invalid MCD file");
 	}
 
-	mapFile.close();
 
 	// Load terrain sprites/surfaces/PCK files into a surfaceset
 	_surfaceSet = new SurfaceSet(32, 40);
@@ -239,10 +238,29 @@ void MapDataSet::unloadData()
 			i = _objects.erase(i);
 		}
 		delete _surfaceSet;
+		_surfaceSet = 0;
 		_loaded = false;
 	}
 }
 
+/**
+ * Gets approximate amount of memory used by the loaded terrain data.
+ * @return Size in bytes, zero if the data is not loaded.
+ */
+size_t MapDataSet::getMemoryUsage() const
+{
+	if (!_loaded)
+	{
+		return 0;
+	}
+	size_t size = _objects.size() * sizeof(MapData);
+	if (_surfaceSet)
+	{
+		size += _surfaceSet->getTotalFrames() * _surfaceSet->getWidth() * _surfaceSet->getHeight();
+	}
+	return size;
+}
+
 /**
  * Loads the LOFTEMPS.DAT into the ruleset voxeldata.
  * @param filename Filename of the DAT file.
@@ -251,26 +269,24 @@ void MapDataSet::unloadData()
 void MapDataSet::loadLOFTEMPS(const std::string &filename, std::vector<Uint16> *voxelData)
 {
 	// Load file
-	std::ifstream mapFile (filename.c_str(), std::ios::in | std::ios::binary);
-	if (!mapFile)
+	std::unique_ptr<std::istream> mapFile = FileMap::openFile(filename);
+	if (!*mapFile)
 	{
 		throw Exception(filename + " not found");
 	}
 
 	Uint16 value;
 
-	while (mapFile.read((char*)&value, sizeof(value)))
+	while (mapFile->read((char*)&value, sizeof(value)))
 	{
 		value = SDL_SwapLE16(value);
 		voxelData->push_back(value);
 	}
 
-	if (!mapFile.eof())
+	if (!mapFile->eof())
 	{
 		throw Exception("Invalid LOFTEMPS");
 	}
-
-	mapFile.close();
 }
 
 /**
@@ -62,6 +62,8 @@ public:
 	void loadData();
 	///	Unloads to free memory.
 	void unloadData();
+	/// Gets memory used by loaded data.
+	size_t getMemoryUsage() const;
 	/// Gets a blank floor tile.
 	static MapData *getBlankFloorTile();
 	/// Gets a scorched earth tile.
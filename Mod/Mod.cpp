@@ -49,6 +49,7 @@
 #include "../fmath.h"
 #include "../Engine/RNG.h"
 #include "../Engine/Options.h"
+#include "../Engine/ThreadPool.h"
 #include "../Battlescape/Pathfinding.h"
 #include "RuleCountry.h"
 #include "RuleRegion.h"
@@ -131,6 +132,9 @@ std::string Mod::DEBRIEF_MUSIC_BAD;
 int Mod::DIFFICULTY_COEFFICIENT[5];
 int Mod::DIFFICULTY_BASED_RETAL_DELAY[5];
 
+/// File extensions of music formats: MUSIC_AUTO, MUSIC_FLAC, MUSIC_OGG, MUSIC_MP3, MUSIC_MOD, MUSIC_WAV, MUSIC_ADLIB, MUSIC_MIDI
+static const std::string musicExtensions[] = { "", ".flac", ".ogg", ".mp3", ".mod", ".wav", "", ".mid" };
+
 void Mod::resetGlobalStatics()
 {
 	DOOR_OPEN = 3;
@@ -286,6 +290,9 @@ Mod::Mod() :
 {
 	_muteMusic = new Music();
 	_muteSound = new Sound();
+	_adlibCat = _aintroCat = 0;
+	_gmCat = 0;
+	_musicCatsOpen = false;
 	_globe = new RuleGlobe();
 	_scriptGlobal = new ModScriptGlobal();
 
@@ -405,6 +412,7 @@ Mod::Mod() :
  */
 Mod::~Mod()
 {
+	Music::clearPrefetch();
 	delete _muteMusic;
 	delete _muteSound;
 	delete _globe;
@@ -430,6 +438,9 @@ Mod::~Mod()
 	{
 		delete i->second;
 	}
+	delete _adlibCat;
+	delete _aintroCat;
+	delete _gmCat;
 	for (std::map<std::string, SoundSet*>::iterator i = _sounds.begin(); i != _sounds.end(); ++i)
 	{
 		delete i->second;
@@ -656,7 +667,17 @@ Music *Mod::getMusic(const std::string &name, bool error) const
 	}
 	else
 	{
-		return getRule(name, "Music", _musics, error);
+		// tracks are loaded the first time they are needed
+		std::map<std::string, Music*>::const_iterator i = _musics.find(name);
+		if (i == _musics.end())
+		{
+			i = _musics.insert(std::make_pair(name, loadMusicTrack(name))).first;
+		}
+		if (i->second == 0 && error)
+		{
+			throw Exception("Music " + name + " not found");
+		}
+		return i->second;
 	}
 }
 
@@ -673,23 +694,53 @@ Music *Mod::getRandomMusic(const std::string &name) const
 	}
 	else
 	{
-		std::vector<Music*> music;
-		for (std::map<std::string, Music*>::const_iterator i = _musics.begin(); i != _musics.end(); ++i)
+		std::vector<std::string> tracks = getMusicTracks(name);
+		std::string track;
+		std::map<std::string, std::string>::iterator next = _nextMusic.find(name);
+		if (next != _nextMusic.end())
 		{
-			if (i->first.find(name) != std::string::npos)
-			{
-				music.push_back(i->second);
-			}
+			// already picked by prefetchMusic
+			track = next->second;
+			_nextMusic.erase(next);
 		}
-		if (music.empty())
+		while (!tracks.empty())
 		{
-			return _muteMusic;
+			if (track.empty())
+			{
+				track = tracks[RNG::seedless(0, tracks.size() - 1)];
+			}
+			Music *music = getMusic(track, false);
+			if (music)
+			{
+				return music;
+			}
+			std::vector<std::string>::iterator i = std::find(tracks.begin(), tracks.end(), track);
+			if (i != tracks.end())
+			{
+				tracks.erase(i);
+			}
+			track.clear();
 		}
-		else
+		return _muteMusic;
+	}
+}
+
+/**
+ * Returns the names of all music tracks containing the given name.
+ * @param name Name of the music.
+ * @return List of track names.
+ */
+std::vector<std::string> Mod::getMusicTracks(const std::string &name) const
+{
+	std::vector<std::string> tracks;
+	for (std::map<std::string, RuleMusic *>::const_iterator i = _musicDefs.begin(); i != _musicDefs.end(); ++i)
+	{
+		if (i->first.find(name) != std::string::npos)
 		{
-			return music[RNG::seedless(0, music.size() - 1)];
+			tracks.push_back(i->first);
 		}
 	}
+	return tracks;
 }
 
 /**
@@ -727,6 +778,56 @@ void Mod::playMusic(const std::string &name, int id)
 	}
 }
 
+/**
+ * Picks the track that will be played the next time the given music
+ * is requested and starts reading it in the background, so switching
+ * to it doesn't stall on the disk.
+ * @param name Name of the music.
+ */
+void Mod::prefetchMusic(const std::string &name)
+{
+#ifndef __NO_MUSIC
+	if (Options::mute || Options::preferredMusic == MUSIC_ADLIB || Options::preferredMusic == MUSIC_MIDI)
+	{
+		return;
+	}
+	std::string track;
+	std::map<std::string, std::string>::const_iterator next = _nextMusic.find(name);
+	if (next != _nextMusic.end())
+	{
+		track = next->second;
+	}
+	else
+	{
+		std::vector<std::string> tracks = getMusicTracks(name);
+		if (tracks.empty())
+		{
+			return;
+		}
+		track = tracks[RNG::seedless(0, tracks.size() - 1)];
+		_nextMusic[name] = track;
+	}
+	if (_musics.find(track) != _musics.end())
+	{
+		return;
+	}
+
+	// only digital tracks are big enough to be worth it
+	const std::set<std::string> &soundContents = FileMap::getVFolderContents("SOUND");
+	const MusicFormat formats[] = { MUSIC_FLAC, MUSIC_OGG, MUSIC_MP3, MUSIC_WAV };
+	for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); ++i)
+	{
+		std::string fname = track + musicExtensions[formats[i]];
+		std::transform(fname.begin(), fname.end(), fname.begin(), tolower);
+		if (soundContents.find(fname) != soundContents.end())
+		{
+			Music::prefetch(FileMap::getFilePath("SOUND/" + fname));
+			break;
+		}
+	}
+#endif
+}
+
 /**
  * Returns a specific sound set from the mod.
  * @param name Name of the sound set.
@@ -905,6 +1006,7 @@ void Mod::loadAll(const std::vector< std::pair< std::string, std::vector<std::st
 	for (size_t i = 0; mods.size() > i; ++i)
 	{
 		_scriptGlobal->setMod((int)modOffsets[i]);
+		_scriptGlobal->setModName(mods[i].first);
 		try
 		{
 			loadMod(mods[i].second, modOffsets[i], parser);
@@ -1057,7 +1159,7 @@ void Mod::loadMod(const std::vector<std::string> &rulesetFiles, size_t modIdx, M
  */
 void Mod::loadFile(const std::string &filename, ModScript &parsers)
 {
-	YAML::Node doc = YAML::LoadFile(filename);
+	YAML::Node doc = FileMap::loadYaml(filename);
 
 	if (const YAML::Node &extended = doc["extended"])
 	{
@@ -2015,6 +2117,146 @@ MapDataSet *Mod::getMapDataSet(const std::string &name)
 	}
 }
 
+/**
+ * Loads the map data files used by a battle and applies their MCD patches.
+ * Files of all sets (and of the given map blocks) are read at the same time
+ * on the shared thread pool, patches are applied afterwards in list order,
+ * so the result doesn't depend on which set finished loading first.
+ * Every set is pinned until it is released by the battle using it.
+ * @param sets Datafiles used by the battle.
+ * @param blocks Map blocks whose MAP and RMP files can be read ahead.
+ */
+void Mod::loadMapDataSets(const std::vector<MapDataSet*> &sets, const std::vector<MapBlock*> &blocks)
+{
+	// the same set or block can't be loaded by two threads
+	std::vector<MapDataSet*> unique;
+	for (std::vector<MapDataSet*>::const_iterator i = sets.begin(); i != sets.end(); ++i)
+	{
+		if (std::find(unique.begin(), unique.end(), *i) == unique.end())
+		{
+			unique.push_back(*i);
+		}
+	}
+	std::vector<MapBlock*> uniqueBlocks;
+	for (std::vector<MapBlock*>::const_iterator i = blocks.begin(); i != blocks.end(); ++i)
+	{
+		if (std::find(uniqueBlocks.begin(), uniqueBlocks.end(), *i) == uniqueBlocks.end())
+		{
+			uniqueBlocks.push_back(*i);
+		}
+	}
+
+	std::vector<std::string> errors(unique.size());
+	auto load = [&](int begin, int end)
+	{
+		for (int i = begin; i < end; ++i)
+		{
+			if (i < (int)unique.size())
+			{
+				try
+				{
+					unique[i]->loadData();
+				}
+				catch (Exception &e)
+				{
+					errors[i] = e.what();
+				}
+			}
+			else
+			{
+				uniqueBlocks[i - unique.size()]->preload();
+			}
+		}
+	};
+	ThreadPool::getShared().parallelFor(unique.size() + uniqueBlocks.size(), 1, load);
+
+	for (size_t i = 0; i < errors.size(); ++i)
+	{
+		if (!errors[i].empty())
+		{
+			throw Exception(errors[i]);
+		}
+	}
+	for (std::vector<MapDataSet*>::const_iterator i = sets.begin(); i != sets.end(); ++i)
+	{
+		MCDPatch *patch = getMCDPatch((*i)->getName());
+		if (patch)
+		{
+			patch->modifyData(*i);
+		}
+	}
+
+	// sets of a live battle must not be unloaded, even when another battle
+	// (like the one replaced by loading a save) releases them meanwhile
+	for (std::vector<MapDataSet*>::const_iterator i = sets.begin(); i != sets.end(); ++i)
+	{
+		++_mapDataUsers[*i];
+		_mapDataCache.remove(*i);
+	}
+	// blocks are only read while the battle is generated, so they go straight to the cache
+	for (std::vector<MapBlock*>::const_iterator i = uniqueBlocks.begin(); i != uniqueBlocks.end(); ++i)
+	{
+		_mapBlockCache.remove(*i);
+		_mapBlockCache.push_back(*i);
+	}
+}
+
+/**
+ * Releases the map data files used by a finished battle.
+ * They stay loaded for the next battles, the least recently
+ * used ones are unloaded when their total size, together with the
+ * cached map blocks, gets over `Options::mapCacheSize`.
+ * Map blocks go first since their files are small and quick to read again.
+ * Sets still used by another battle are kept out of the cache until it releases them too.
+ * @param sets Datafiles used by the battle, same list as given to loadMapDataSets.
+ */
+void Mod::releaseMapDataSets(const std::vector<MapDataSet*> &sets)
+{
+	for (std::vector<MapDataSet*>::const_iterator i = sets.begin(); i != sets.end(); ++i)
+	{
+		std::map<MapDataSet*, int>::iterator users = _mapDataUsers.find(*i);
+		if (users != _mapDataUsers.end() && --users->second <= 0)
+		{
+			_mapDataUsers.erase(users);
+		}
+	}
+	// most recently used at the end
+	for (std::vector<MapDataSet*>::const_iterator i = sets.begin(); i != sets.end(); ++i)
+	{
+		if (_mapDataUsers.find(*i) == _mapDataUsers.end())
+		{
+			_mapDataCache.remove(*i);
+			_mapDataCache.push_back(*i);
+		}
+	}
+
+	size_t total = 0;
+	for (std::list<MapDataSet*>::const_iterator i = _mapDataCache.begin(); i != _mapDataCache.end(); ++i)
+	{
+		total += (*i)->getMemoryUsage();
+	}
+	for (std::list<MapBlock*>::const_iterator i = _mapBlockCache.begin(); i != _mapBlockCache.end(); ++i)
+	{
+		total += (*i)->getMemoryUsage();
+	}
+
+	const size_t budget = (size_t)std::max(Options::mapCacheSize, 0) * 1024 * 1024;
+	while (total > budget && !_mapBlockCache.empty())
+	{
+		MapBlock *block = _mapBlockCache.front();
+		total -= block->getMemoryUsage();
+		block->unloadData();
+		_mapBlockCache.pop_front();
+	}
+	while (total > budget && !_mapDataCache.empty())
+	{
+		MapDataSet *set = _mapDataCache.front();
+		total -= set->getMemoryUsage();
+		set->unloadData();
+		_mapDataCache.pop_front();
+	}
+}
+
 /**
  * Returns the info about a specific unit.
  * @param name Unit name.
@@ -2039,7 +2281,7 @@ const std::vector<std::string> &Mod::getSoldiersList() const
  * Gets the list of commendations
  * @return The list of commendations.
  */
-std::map<std::string, RuleCommendations *> Mod::getCommendation() const
+const std::map<std::string, RuleCommendations *> &Mod::getCommendation() const
 {
 	return _commendations;
 }
@@ -2684,6 +2926,15 @@ RuleGlobe *Mod::getGlobe() const
 	return _globe;
 }
 
+/**
+ * Gets the data shared by all scripts, like script statistics.
+ * @return Pointer to script global data.
+ */
+ScriptGlobal *Mod::getScriptGlobal() const
+{
+	return _scriptGlobal;
+}
+
 /**
 * Gets the rules for the Save Converter.
 * @return Pointer to converter rules.
@@ -3366,7 +3617,7 @@ void Mod::loadBattlescapeResources()
 void Mod::loadExtraResources()
 {
 	// Load fonts
-	YAML::Node doc = YAML::LoadFile(FileMap::getFilePath("Language/" + _fontName));
+	YAML::Node doc = FileMap::loadYaml(FileMap::getFilePath("Language/" + _fontName));
 	Log(LOG_INFO) << "Loading fonts... " << _fontName;
 	for (YAML::const_iterator i = doc["fonts"].begin(); i != doc["fonts"].end(); ++i)
 	{
@@ -3376,53 +3627,7 @@ void Mod::loadExtraResources()
 		_fonts[id] = font;
 	}
 
-#ifndef __NO_MUSIC
-	// Load musics
-	if (!Options::mute)
-	{
-		const std::set<std::string> &soundFiles(FileMap::getVFolderContents("SOUND"));
-
-		// Check which music version is available
-		CatFile *adlibcat = 0, *aintrocat = 0;
-		GMCatFile *gmcat = 0;
-
-		for (std::set<std::string>::iterator i = soundFiles.begin(); i != soundFiles.end(); ++i)
-		{
-			if (0 == i->compare("adlib.cat"))
-			{
-				adlibcat = new CatFile(FileMap::getFilePath("SOUND/" + *i).c_str());
-			}
-			else if (0 == i->compare("aintro.cat"))
-			{
-				aintrocat = new CatFile(FileMap::getFilePath("SOUND/" + *i).c_str());
-			}
-			else if (0 == i->compare("gm.cat"))
-			{
-				gmcat = new GMCatFile(FileMap::getFilePath("SOUND/" + *i).c_str());
-			}
-		}
-
-		// Try the preferred format first, otherwise use the default priority
-		MusicFormat priority[] = { Options::preferredMusic, MUSIC_FLAC, MUSIC_OGG, MUSIC_MP3, MUSIC_MOD, MUSIC_WAV, MUSIC_ADLIB, MUSIC_MIDI };
-		for (std::map<std::string, RuleMusic *>::const_iterator i = _musicDefs.begin(); i != _musicDefs.end(); ++i)
-		{
-			Music *music = 0;
-			for (size_t j = 0; j < sizeof(priority) / sizeof(priority[0]) && music == 0; ++j)
-			{
-				music = loadMusic(priority[j], (*i).first, (*i).second->getCatPos(), (*i).second->getNormalization(), adlibcat, aintrocat, gmcat);
-			}
-			if (music)
-			{
-				_musics[(*i).first] = music;
-			}
-
-		}
-
-		delete gmcat;
-		delete adlibcat;
-		delete aintrocat;
-	}
-#endif
+	// Musics are loaded on demand, see getMusic()
 
 	Log(LOG_INFO) << "Loading extra resources from ruleset...";
 	for (std::vector< std::pair<std::string, ExtraSprites *> >::const_iterator i = _extraSprites.begin(); i != _extraSprites.end(); ++i)
@@ -3768,6 +3973,66 @@ bool Mod::isImageFile(std::string extension) const
 		extension == "TIFF");
 }
 
+/**
+ * Opens the CAT files that hold music tracks, if the game has them.
+ * Tracks are loaded one at a time when they are first needed,
+ * so the files are kept open for the following tracks.
+ */
+void Mod::openMusicCats() const
+{
+	if (_musicCatsOpen)
+	{
+		return;
+	}
+	_musicCatsOpen = true;
+
+	const std::set<std::string> &soundFiles(FileMap::getVFolderContents("SOUND"));
+	for (std::set<std::string>::iterator i = soundFiles.begin(); i != soundFiles.end(); ++i)
+	{
+		if (0 == i->compare("adlib.cat"))
+		{
+			_adlibCat = new CatFile(FileMap::getFilePath("SOUND/" + *i).c_str());
+		}
+		else if (0 == i->compare("aintro.cat"))
+		{
+			_aintroCat = new CatFile(FileMap::getFilePath("SOUND/" + *i).c_str());
+		}
+		else if (0 == i->compare("gm.cat"))
+		{
+			_gmCat = new GMCatFile(FileMap::getFilePath("SOUND/" + *i).c_str());
+		}
+	}
+}
+
+/**
+ * Loads the specified music track, trying each available format
+ * in order of preference until one works.
+ * @param name Name of the music.
+ * @return Pointer to the music, or NULL if it couldn't be loaded.
+ */
+Music *Mod::loadMusicTrack(const std::string &name) const
+{
+	Music *music = 0;
+#ifndef __NO_MUSIC
+	std::map<std::string, RuleMusic *>::const_iterator rule = _musicDefs.find(name);
+	if (rule == _musicDefs.end())
+	{
+		return 0;
+	}
+
+	// Check which music version is available
+	openMusicCats();
+
+	// Try the preferred format first, otherwise use the default priority
+	MusicFormat priority[] = { Options::preferredMusic, MUSIC_FLAC, MUSIC_OGG, MUSIC_MP3, MUSIC_MOD, MUSIC_WAV, MUSIC_ADLIB, MUSIC_MIDI };
+	for (size_t j = 0; j < sizeof(priority) / sizeof(priority[0]) && music == 0; ++j)
+	{
+		music = loadMusic(priority[j], rule->first, rule->second->getCatPos(), rule->second->getNormalization(), _adlibCat, _aintroCat, _gmCat);
+	}
+#endif
+	return music;
+}
+
 /**
  * Loads the specified music file format.
  * @param fmt Format of the music.
@@ -3781,13 +4046,11 @@ bool Mod::isImageFile(std::string extension) const
  */
 Music *Mod::loadMusic(MusicFormat fmt, const std::string &file, int track, float volume, CatFile *adlibcat, CatFile *aintrocat, GMCatFile *gmcat) const
 {
-	/* MUSIC_AUTO, MUSIC_FLAC, MUSIC_OGG, MUSIC_MP3, MUSIC_MOD, MUSIC_WAV, MUSIC_ADLIB, MUSIC_MIDI */
-	static const std::string exts[] = { "", ".flac", ".ogg", ".mp3", ".mod", ".wav", "", ".mid" };
 	Music *music = 0;
 	std::set<std::string> soundContents = FileMap::getVFolderContents("SOUND");
 	try
 	{
-		std::string fname = file + exts[fmt];
+		std::string fname = file + musicExtensions[fmt];
 		std::transform(fname.begin(), fname.end(), fname.begin(), tolower);
 
 		// Try Adlib music
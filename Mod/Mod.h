@@ -18,6 +18,7 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <map>
+#include <list>
 #include <vector>
 #include <string>
 #include <SDL.h>
@@ -55,6 +56,7 @@ class RuleDamageType;
 class RuleUfo;
 class RuleTerrain;
 class MapDataSet;
+class MapBlock;
 class RuleSoldier;
 class Unit;
 class Armor;
@@ -105,7 +107,11 @@ private:
 	std::map<std::string, Surface*> _surfaces;
 	std::map<std::string, SurfaceSet*> _sets;
 	std::map<std::string, SoundSet*> _sounds;
-	std::map<std::string, Music*> _musics;
+	mutable std::map<std::string, Music*> _musics;
+	mutable std::map<std::string, std::string> _nextMusic;
+	mutable CatFile *_adlibCat, *_aintroCat;
+	mutable GMCatFile *_gmCat;
+	mutable bool _musicCatsOpen;
 	std::vector<Uint16> _voxelData;
 	std::vector<std::vector<Uint8> > _transparencyLUTs;
 
@@ -119,6 +125,9 @@ private:
 	std::map<std::string, RuleUfo*> _ufos;
 	std::map<std::string, RuleTerrain*> _terrains;
 	std::map<std::string, MapDataSet*> _mapDataSets;
+	std::list<MapDataSet*> _mapDataCache;
+	std::map<MapDataSet*, int> _mapDataUsers;
+	std::list<MapBlock*> _mapBlockCache;
 	std::map<std::string, RuleSoldier*> _soldiers;
 	std::map<std::string, Unit*> _units;
 	std::map<std::string, AlienRace*> _alienRaces;
@@ -198,6 +207,12 @@ private:
 	void loadBattlescapeResources();
 	/// Checks if an extension is a valid image file.
 	bool isImageFile(std::string extension) const;
+	/// Gets names of all music tracks matching a name.
+	std::vector<std::string> getMusicTracks(const std::string &name) const;
+	/// Opens the CAT files with music, once for all tracks.
+	void openMusicCats() const;
+	/// Loads a specified music track in the first available format.
+	Music *loadMusicTrack(const std::string &name) const;
 	/// Loads a specified music file.
 	Music *loadMusic(MusicFormat fmt, const std::string &file, int track, float volume, CatFile *adlibcat, CatFile *aintrocat, GMCatFile *gmcat) const;
 	/// Creates a transparency lookup table for a given palette.
@@ -269,6 +284,8 @@ public:
 	Music *getMusic(const std::string &name, bool error = true) const;
 	/// Plays a particular music.
 	void playMusic(const std::string &name, int id = 0);
+	/// Starts reading the next track of a music in the background.
+	void prefetchMusic(const std::string &name);
 	/// Gets a particular sound.
 	Sound *getSound(const std::string &set, unsigned int sound, bool error = true) const;
 	/// Gets a particular palette.
@@ -330,12 +347,16 @@ public:
 	const std::vector<std::string> &getTerrainList() const;
 	/// Gets mapdatafile for battlescape games.
 	MapDataSet *getMapDataSet(const std::string &name);
+	/// Loads mapdatafiles and map blocks needed by a battle.
+	void loadMapDataSets(const std::vector<MapDataSet*> &sets, const std::vector<MapBlock*> &blocks = std::vector<MapBlock*>());
+	/// Releases mapdatafiles used by a finished battle.
+	void releaseMapDataSets(const std::vector<MapDataSet*> &sets);
 	/// Gets soldier unit rules.
 	RuleSoldier *getSoldier(const std::string &name, bool error = false) const;
 	/// Gets the available soldiers.
 	const std::vector<std::string> &getSoldiersList() const;
 	/// Gets commendation rules.
-	std::map<std::string, RuleCommendations *> getCommendation() const;
+	const std::map<std::string, RuleCommendations *> &getCommendation() const;
 	/// Gets generated unit rules.
 	Unit *getUnit(const std::string &name, bool error = false) const;
 	/// Gets alien race rules.
@@ -470,6 +491,8 @@ public:
 	RuleInterface *getInterface(const std::string &id, bool error = true) const;
 	/// Gets the ruleset for the globe.
 	RuleGlobe *getGlobe() const;
+	/// Gets the data shared by all scripts.
+	ScriptGlobal *getScriptGlobal() const;
 	/// Gets the ruleset for the converter.
 	RuleConverter *getConverter() const;
 	/// Gets the list of selective files for insertion into our cat files.
@@ -46,6 +46,77 @@ void RuleCommendations::load(const YAML::Node &node)
 	_criteria = node["criteria"].as< std::map<std::string, std::vector<int> > >(_criteria);
 	_sprite = node["sprite"].as<int>(_sprite);
 	_killCriteria = node["killCriteria"].as<std::vector<std::map<int, std::vector<std::string> > > >(_killCriteria);
+
+	// keep same order as in map, criteria are checked in it
+	_compiledCriteria.clear();
+	for (std::map<std::string, std::vector<int> >::const_iterator i = _criteria.begin(); i != _criteria.end(); ++i)
+	{
+		CommendationCriteria c = { getCriterionType(i->first), &i->second };
+		_compiledCriteria.push_back(c);
+	}
+}
+
+/**
+ * Get the criterion type from its name.
+ * @param name Name of criterion used in rulesets.
+ * @return Criterion type, CC_UNKNOWN if the name is not recognized.
+ */
+CommendationCriterion RuleCommendations::getCriterionType(const std::string &name)
+{
+	static const std::map<std::string, CommendationCriterion> names =
+	{
+		{ "totalKills", CC_TOTAL_KILLS },
+		{ "totalMissions", CC_TOTAL_MISSIONS },
+		{ "totalWins", CC_TOTAL_WINS },
+		{ "totalScore", CC_TOTAL_SCORE },
+		{ "totalStuns", CC_TOTAL_STUNS },
+		{ "totalDaysWounded", CC_TOTAL_DAYS_WOUNDED },
+		{ "totalBaseDefenseMissions", CC_TOTAL_BASE_DEFENSE_MISSIONS },
+		{ "totalTerrorMissions", CC_TOTAL_TERROR_MISSIONS },
+		{ "totalNightMissions", CC_TOTAL_NIGHT_MISSIONS },
+		{ "totalNightTerrorMissions", CC_TOTAL_NIGHT_TERROR_MISSIONS },
+		{ "totalMonthlyService", CC_TOTAL_MONTHLY_SERVICE },
+		{ "totalFellUnconcious", CC_TOTAL_FELL_UNCONCIOUS },
+		{ "totalShotAt10Times", CC_TOTAL_SHOT_AT_10_TIMES },
+		{ "totalHit5Times", CC_TOTAL_HIT_5_TIMES },
+		{ "totalFriendlyFired", CC_TOTAL_FRIENDLY_FIRED },
+		{ "total_lone_survivor", CC_TOTAL_LONE_SURVIVOR },
+		{ "totalIronMan", CC_TOTAL_IRON_MAN },
+		{ "totalImportantMissions", CC_TOTAL_IMPORTANT_MISSIONS },
+		{ "totalLongDistanceHits", CC_TOTAL_LONG_DISTANCE_HITS },
+		{ "totalLowAccuracyHits", CC_TOTAL_LOW_ACCURACY_HITS },
+		{ "totalReactionFire", CC_TOTAL_REACTION_FIRE },
+		{ "totalTimesWounded", CC_TOTAL_TIMES_WOUNDED },
+		{ "totalValientCrux", CC_TOTAL_VALIANT_CRUX },
+		{ "isDead", CC_IS_DEAD },
+		{ "totalTrapKills", CC_TOTAL_TRAP_KILLS },
+		{ "totalAlienBaseAssaults", CC_TOTAL_ALIEN_BASE_ASSAULTS },
+		{ "totalAllAliensKilled", CC_TOTAL_ALL_ALIENS_KILLED },
+		{ "totalAllAliensStunned", CC_TOTAL_ALL_ALIENS_STUNNED },
+		{ "totalWoundsHealed", CC_TOTAL_WOUNDS_HEALED },
+		{ "totalAllUFOs", CC_TOTAL_ALL_UFOS },
+		{ "totalAllMissionTypes", CC_TOTAL_ALL_MISSION_TYPES },
+		{ "totalStatGain", CC_TOTAL_STAT_GAIN },
+		{ "totalRevives", CC_TOTAL_REVIVES },
+		{ "totalWholeMedikit", CC_TOTAL_WHOLE_MEDIKIT },
+		{ "totalBraveryGain", CC_TOTAL_BRAVERY_GAIN },
+		{ "bestOfRank", CC_BEST_OF_RANK },
+		{ "bestSoldier", CC_BEST_SOLDIER },
+		{ "isMIA", CC_IS_MIA },
+		{ "totalMartyrKills", CC_TOTAL_MARTYR_KILLS },
+		{ "totalPostMortemKills", CC_TOTAL_POST_MORTEM_KILLS },
+		{ "globeTrotter", CC_GLOBE_TROTTER },
+		{ "totalSlaveKills", CC_TOTAL_SLAVE_KILLS },
+		{ "totalKillsWithAWeapon", CC_TOTAL_KILLS_WITH_A_WEAPON },
+		{ "totalMissionsInARegion", CC_TOTAL_MISSIONS_IN_A_REGION },
+		{ "totalKillsByRace", CC_TOTAL_KILLS_BY_RACE },
+		{ "totalKillsByRank", CC_TOTAL_KILLS_BY_RANK },
+		{ "killsWithCriteriaCareer", CC_KILLS_WITH_CRITERIA_CAREER },
+		{ "killsWithCriteriaMission", CC_KILLS_WITH_CRITERIA_MISSION },
+		{ "killsWithCriteriaTurn", CC_KILLS_WITH_CRITERIA_TURN },
+	};
+	std::map<std::string, CommendationCriterion>::const_iterator i = names.find(name);
+	return i != names.end() ? i->second : CC_UNKNOWN;
 }
 
 /**
@@ -66,6 +137,16 @@ std::map<std::string, std::vector<int> > *RuleCommendations::getCriteria()
 	return &_criteria;
 }
 
+/**
+ * Get the commendation's award criteria resolved to criterion types,
+ * in the same order as in the criteria map.
+ * @return List of criteria.
+ */
+const std::vector<CommendationCriteria> &RuleCommendations::getCompiledCriteria() const
+{
+	return _compiledCriteria;
+}
+
 /**
  * Get the commendation's award kill criteria.
  * @return vecotr<string> Commendation kill criteria.
@@ -22,6 +22,76 @@
 namespace OpenXcom
 {
 
+/**
+ * Award criteria known by commendations, resolved from their names when ruleset is loaded.
+ */
+enum CommendationCriterion
+{
+	CC_UNKNOWN,
+	// criteria without noun, compared against one total
+	CC_TOTAL_KILLS,
+	CC_TOTAL_MISSIONS,
+	CC_TOTAL_WINS,
+	CC_TOTAL_SCORE,
+	CC_TOTAL_STUNS,
+	CC_TOTAL_DAYS_WOUNDED,
+	CC_TOTAL_BASE_DEFENSE_MISSIONS,
+	CC_TOTAL_TERROR_MISSIONS,
+	CC_TOTAL_NIGHT_MISSIONS,
+	CC_TOTAL_NIGHT_TERROR_MISSIONS,
+	CC_TOTAL_MONTHLY_SERVICE,
+	CC_TOTAL_FELL_UNCONCIOUS,
+	CC_TOTAL_SHOT_AT_10_TIMES,
+	CC_TOTAL_HIT_5_TIMES,
+	CC_TOTAL_FRIENDLY_FIRED,
+	CC_TOTAL_LONE_SURVIVOR,
+	CC_TOTAL_IRON_MAN,
+	CC_TOTAL_IMPORTANT_MISSIONS,
+	CC_TOTAL_LONG_DISTANCE_HITS,
+	CC_TOTAL_LOW_ACCURACY_HITS,
+	CC_TOTAL_REACTION_FIRE,
+	CC_TOTAL_TIMES_WOUNDED,
+	CC_TOTAL_VALIANT_CRUX,
+	CC_IS_DEAD,
+	CC_TOTAL_TRAP_KILLS,
+	CC_TOTAL_ALIEN_BASE_ASSAULTS,
+	CC_TOTAL_ALL_ALIENS_KILLED,
+	CC_TOTAL_ALL_ALIENS_STUNNED,
+	CC_TOTAL_WOUNDS_HEALED,
+	CC_TOTAL_ALL_UFOS,
+	CC_TOTAL_ALL_MISSION_TYPES,
+	CC_TOTAL_STAT_GAIN,
+	CC_TOTAL_REVIVES,
+	CC_TOTAL_WHOLE_MEDIKIT,
+	CC_TOTAL_BRAVERY_GAIN,
+	CC_BEST_OF_RANK,
+	CC_BEST_SOLDIER,
+	CC_IS_MIA,
+	CC_TOTAL_MARTYR_KILLS,
+	CC_TOTAL_POST_MORTEM_KILLS,
+	CC_GLOBE_TROTTER,
+	CC_TOTAL_SLAVE_KILLS,
+	// criteria with noun
+	CC_TOTAL_KILLS_WITH_A_WEAPON,
+	CC_TOTAL_MISSIONS_IN_A_REGION,
+	CC_TOTAL_KILLS_BY_RACE,
+	CC_TOTAL_KILLS_BY_RANK,
+	// criteria using kill criteria list
+	CC_KILLS_WITH_CRITERIA_CAREER,
+	CC_KILLS_WITH_CRITERIA_MISSION,
+	CC_KILLS_WITH_CRITERIA_TURN,
+	CC_MAX
+};
+
+/**
+ * Award criterion with its thresholds for each decoration level.
+ */
+struct CommendationCriteria
+{
+	CommendationCriterion type;
+	const std::vector<int> *levels;
+};
+
 /**
  * Represents a specific type of commendation.
  * Contains constant info about a commendation like
@@ -33,6 +103,7 @@ class RuleCommendations
 private:
 	std::map<std::string, std::vector<int> > _criteria;
     std::vector<std::map<int, std::vector<std::string> > > _killCriteria;
+	std::vector<CommendationCriteria> _compiledCriteria;
 	std::string _description;
 	int _sprite;
 public:
@@ -40,12 +111,20 @@ public:
 	RuleCommendations();
 	/// Cleans up the commendation ruleset.
 	~RuleCommendations();
+	/// Copy constructor, compiled criteria point into this ruleset's own containers.
+	RuleCommendations(const RuleCommendations&) = delete;
+	/// Copy.
+	RuleCommendations &operator=(const RuleCommendations&) = delete;
 	/// Loads commendation data from YAML.
 	void load(const YAML::Node& node);
 	/// Get the commendation's description.
 	std::string getDescription() const;
 	/// Get the commendation's award criteria.
 	std::map<std::string, std::vector<int> > *getCriteria();
+	/// Get the commendation's award criteria resolved to criterion types.
+	const std::vector<CommendationCriteria> &getCompiledCriteria() const;
+	/// Get the criterion type from its name.
+	static CommendationCriterion getCriterionType(const std::string &name);
 	/// Get the commendation's award kill related criteria.
 	std::vector<std::map<int, std::vector<std::string> > > *getKillCriteria();
 	/// Get the commendation's sprite.
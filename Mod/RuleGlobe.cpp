@@ -19,6 +19,7 @@
 #include "RuleGlobe.h"
 #include <SDL_endian.h>
 #include <fstream>
+#include <algorithm>
 #include "../Engine/Exception.h"
 #include "Polygon.h"
 #include "Polyline.h"
@@ -31,6 +32,21 @@
 namespace OpenXcom
 {
 
+namespace
+{
+
+/// Points that are farther from any vertex of polygon than this cosine are never inside it.
+const double POLYGON_DISCARD = 0.75;
+/// Extra space around polygons in index to cover rounding errors.
+const double INDEX_MARGIN = 0.001;
+
+inline double dot(const Cord& a, const Cord& b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+}
+
 /**
  * Creates a blank ruleset for globe contents.
  */
@@ -70,6 +86,7 @@ void RuleGlobe::load(const YAML::Node &node)
 			delete *i;
 		}
 		_polygons.clear();
+		_indexCellBegin.clear();
 		loadDat(FileMap::getFilePath(node["data"].as<std::string>()));
 	}
 	if (node["polygons"])
@@ -79,6 +96,7 @@ void RuleGlobe::load(const YAML::Node &node)
 			delete *i;
 		}
 		_polygons.clear();
+		_indexCellBegin.clear();
 		for (YAML::const_iterator i = node["polygons"].begin(); i != node["polygons"].end(); ++i)
 		{
 			Polygon *polygon = new Polygon(3);
@@ -148,6 +166,157 @@ std::list<Polygon*> *RuleGlobe::getPolygons()
 	return &_polygons;
 }
 
+/**
+ * Builds index of world polygons used by point lookups.
+ * Globe is split into lat/lon cells and every cell gets list of polygons that
+ * can contain any of its points. Polygon can only contain points that are inside
+ * the smallest spherical cap around polygon center that have all its vertices.
+ */
+void RuleGlobe::buildPolygonIndex()
+{
+	const double cellLat = M_PI / INDEX_ROWS;
+	const double cellLon = 2 * M_PI / INDEX_COLS;
+	std::vector<std::vector<int> > cells(INDEX_ROWS * INDEX_COLS);
+
+	_indexPolygons.clear();
+	_indexVertexBegin.clear();
+	_indexVertices.clear();
+	for (std::list<Polygon*>::iterator i = _polygons.begin(); i != _polygons.end(); ++i)
+	{
+		const int index = _indexPolygons.size();
+		Cord center;
+		_indexPolygons.push_back(*i);
+		_indexVertexBegin.push_back(_indexVertices.size());
+		for (int j = 0; j < (*i)->getPoints(); ++j)
+		{
+			Cord vertex = Cord(CordPolar((*i)->getLongitude(j), (*i)->getLatitude(j)));
+			_indexVertices.push_back(vertex);
+			center += vertex;
+		}
+		if ((*i)->getPoints() == 0 || center.norm() < INDEX_MARGIN)
+		{
+			continue;
+		}
+		center /= center.norm();
+
+		double capCos = 1.0;
+		for (size_t j = _indexVertexBegin.back(); j < _indexVertices.size(); ++j)
+		{
+			capCos = std::min(capCos, dot(center, _indexVertices[j]));
+		}
+		if (capCos <= 0.0)
+		{
+			// all vertices of polygon that can be found are close to one point, this one is too big
+			continue;
+		}
+
+		const CordPolar polar(center);
+		const double capRadius = acos(capCos) + INDEX_MARGIN;
+		const int rowBegin = std::max(0, (int)floor((polar.lat - capRadius + M_PI / 2) / cellLat));
+		const int rowEnd = std::min(INDEX_ROWS - 1, (int)floor((polar.lat + capRadius + M_PI / 2) / cellLat));
+		int colBegin = 0;
+		int colEnd = INDEX_COLS - 1;
+		if (std::abs(polar.lat) + capRadius < M_PI / 2)
+		{
+			const double lonRadius = asin(std::min(1.0, sin(capRadius) / cos(polar.lat))) + INDEX_MARGIN;
+			colBegin = (int)floor((polar.lon - lonRadius) / cellLon);
+			colEnd = (int)floor((polar.lon + lonRadius) / cellLon);
+			if (colEnd - colBegin >= INDEX_COLS)
+			{
+				colBegin = 0;
+				colEnd = INDEX_COLS - 1;
+			}
+		}
+		for (int row = rowBegin; row <= rowEnd; ++row)
+		{
+			for (int col = colBegin; col <= colEnd; ++col)
+			{
+				cells[row * INDEX_COLS + ((col % INDEX_COLS) + INDEX_COLS) % INDEX_COLS].push_back(index);
+			}
+		}
+	}
+	_indexVertexBegin.push_back(_indexVertices.size());
+
+	_indexCellBegin.clear();
+	_indexCellPolygons.clear();
+	for (std::vector<std::vector<int> >::const_iterator i = cells.begin(); i != cells.end(); ++i)
+	{
+		_indexCellBegin.push_back(_indexCellPolygons.size());
+		_indexCellPolygons.insert(_indexCellPolygons.end(), i->begin(), i->end());
+	}
+	_indexCellBegin.push_back(_indexCellPolygons.size());
+}
+
+/**
+ * Returns the first world polygon that contains a polar point.
+ * @param lon Longitude of the point.
+ * @param lat Latitude of the point.
+ * @return Pointer to the polygon, or NULL if point is not on land.
+ */
+Polygon *RuleGlobe::getPolygonFromLonLat(double lon, double lat)
+{
+	if (_indexCellBegin.empty())
+	{
+		buildPolygonIndex();
+	}
+
+	const double coslat = cos(lat);
+	const double sinlat = sin(lat);
+	const double coslon = cos(lon);
+	const double sinlon = sin(lon);
+	// point and directions to east and north from it
+	const Cord point = Cord(CordPolar(lon, lat));
+	const Cord east = Cord(coslon, 0.0, -sinlon);
+	const Cord north = Cord(-sinlat * sinlon, coslat, -sinlat * coslon);
+
+	const double cellLat = M_PI / INDEX_ROWS;
+	const double cellLon = 2 * M_PI / INDEX_COLS;
+	const int row = std::max(0, std::min(INDEX_ROWS - 1, (int)floor((lat + M_PI / 2) / cellLat)));
+	const int col = ((int)floor(lon / cellLon) % INDEX_COLS + INDEX_COLS) % INDEX_COLS;
+	const int cell = row * INDEX_COLS + col;
+
+	for (size_t c = _indexCellBegin[cell]; c < _indexCellBegin[cell + 1]; ++c)
+	{
+		const int index = _indexCellPolygons[c];
+		const Cord *begin = &_indexVertices[0] + _indexVertexBegin[index];
+		const Cord *end = &_indexVertices[0] + _indexVertexBegin[index + 1];
+
+		bool discard = false;
+		for (const Cord *v = begin; v != end; ++v)
+		{
+			if (dot(point, *v) < POLYGON_DISCARD)
+			{
+				discard = true;
+				break;
+			}
+		}
+		if (discard)
+		{
+			continue;
+		}
+
+		// test if point is inside polygon projected on plane touching globe at this point
+		bool odd = false;
+		double x = dot(*begin, east);
+		double y = dot(*begin, north);
+		for (const Cord *v = begin; v != end; ++v)
+		{
+			const Cord *next = (v + 1 == end) ? begin : v + 1;
+			const double x2 = dot(*next, east);
+			const double y2 = dot(*next, north);
+			if (((y > 0) != (y2 > 0)) && (0 < (x2 - x) * (0 - y) / (y2 - y) + x))
+				odd = !odd;
+			x = x2;
+			y = y2;
+		}
+		if (odd)
+		{
+			return _indexPolygons[index];
+		}
+	}
+	return NULL;
+}
+
 /**
  * Returns the list of polylines in the globe.
  * @return Pointer to the list of polylines.
@@ -166,15 +335,15 @@ std::list<Polyline*> *RuleGlobe::getPolylines()
 void RuleGlobe::loadDat(const std::string &filename)
 {
 	// Load file
-	std::ifstream mapFile (filename.c_str(), std::ios::in | std::ios::binary);
-	if (!mapFile)
+	std::unique_ptr<std::istream> mapFile = FileMap::openFile(filename);
+	if (!*mapFile)
 	{
 		throw Exception(filename + " not found");
 	}
 
 	short value[10];
 
-	while (mapFile.read((char*)&value, sizeof(value)))
+	while (mapFile->read((char*)&value, sizeof(value)))
 	{
 		Polygon* poly;
 		int points;
@@ -207,13 +376,12 @@ void RuleGlobe::loadDat(const std::string &filename)
 
 		_polygons.push_back(poly);
 	}
+	_indexCellBegin.clear();
 
-	if (!mapFile.eof())
+	if (!mapFile->eof())
 	{
 		throw Exception("Invalid globe map");
 	}
-
-	mapFile.close();
 }
 
 /**
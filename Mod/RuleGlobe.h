@@ -19,7 +19,9 @@
  */
 #include <list>
 #include <string>
+#include <vector>
 #include <yaml-cpp/yaml.h>
+#include "../Geoscape/Cord.h"
 
 namespace OpenXcom
 {
@@ -36,9 +38,25 @@ class Texture;
 class RuleGlobe
 {
 private:
+	static const int INDEX_ROWS = 90;
+	static const int INDEX_COLS = 180;
+
 	std::list<Polygon*> _polygons;
 	std::list<Polyline*> _polylines;
 	std::map<int, Texture*> _textures;
+	/// Polygons in index, in same order as in polygon list.
+	std::vector<Polygon*> _indexPolygons;
+	/// Position of first vertex of each polygon in index, with extra end position.
+	std::vector<size_t> _indexVertexBegin;
+	/// Vertices of all polygons as unit vectors.
+	std::vector<Cord> _indexVertices;
+	/// Position of first candidate of each lat/lon cell, with extra end position.
+	std::vector<size_t> _indexCellBegin;
+	/// Polygons that can contain points of each cell.
+	std::vector<int> _indexCellPolygons;
+
+	/// Builds lookup index of world polygons.
+	void buildPolygonIndex();
 public:
 	/// Creates a blank globe ruleset.
 	RuleGlobe();
@@ -48,6 +66,8 @@ public:
 	void load(const YAML::Node& node);
 	/// Gets the list of world polygons.
 	std::list<Polygon*> *getPolygons();
+	/// Gets the world polygon at a given point.
+	Polygon *getPolygonFromLonLat(double lon, double lat);
 	/// Gets the list of world polylines.
 	std::list<Polyline*> *getPolylines();
 	/// Loads a set of polygons from a DAT file.
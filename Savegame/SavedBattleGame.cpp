@@ -18,6 +18,7 @@
  */
 #include <assert.h>
 #include <vector>
+#include <algorithm>
 #include "BattleItem.h"
 #include "ItemContainer.h"
 #include "SavedBattleGame.h"
@@ -25,7 +26,6 @@
 #include "Tile.h"
 #include "Node.h"
 #include "../Mod/MapDataSet.h"
-#include "../Mod/MCDPatch.h"
 #include "../Battlescape/Pathfinding.h"
 #include "../Battlescape/TileEngine.h"
 #include "../Battlescape/BattlescapeState.h"
@@ -69,10 +69,8 @@ SavedBattleGame::SavedBattleGame(Mod *rule) :
  */
 SavedBattleGame::~SavedBattleGame()
 {
-	for (std::vector<MapDataSet*>::iterator i = _mapDataSets.begin(); i != _mapDataSets.end(); ++i)
-	{
-		(*i)->unloadData();
-	}
+	// sets stay loaded in the mod unless another live battle still pins them
+	_rule->releaseMapDataSets(_mapDataSets);
 
 	for (std::vector<Node*>::iterator i = _nodes.begin(); i != _nodes.end(); ++i)
 	{
@@ -346,14 +344,7 @@ void SavedBattleGame::load(const YAML::Node &node, Mod *mod, SavedGame* savedGam
  */
 void SavedBattleGame::loadMapResources(Mod *mod)
 {
-	for (std::vector<MapDataSet*>::const_iterator i = _mapDataSets.begin(); i != _mapDataSets.end(); ++i)
-	{
-		(*i)->loadData();
-		if (mod->getMCDPatch((*i)->getName()))
-		{
-			mod->getMCDPatch((*i)->getName())->modifyData(*i);
-		}
-	}
+	mod->loadMapDataSets(_mapDataSets);
 
 	int mdsID, mdID;
 
@@ -490,6 +481,7 @@ void SavedBattleGame::initMap(int mapsize_x, int mapsize_y, int mapsize_z)
 	if (!_nodes.empty())
 	{
 		_tiles.clear();
+		_enviTiles.clear();
 
 		for (std::vector<Node*>::iterator i = _nodes.begin(); i != _nodes.end(); ++i)
 		{
@@ -497,18 +489,22 @@ void SavedBattleGame::initMap(int mapsize_x, int mapsize_y, int mapsize_z)
 		}
 
 		_nodes.clear();
+		// next stage loads its own sets
+		_rule->releaseMapDataSets(_mapDataSets);
 		_mapDataSets.clear();
 	}
 	_mapsize_x = mapsize_x;
 	_mapsize_y = mapsize_y;
 	_mapsize_z = mapsize_z;
 	_tiles.reserve(_mapsize_z * _mapsize_y * _mapsize_x);
+	_tileStorage.resize(_mapsize_z * _mapsize_y * _mapsize_x);
 	/* create tile objects */
 	for (int i = 0; i < _mapsize_z * _mapsize_y * _mapsize_x; ++i)
 	{
 		Position pos;
 		getTileCoords(i, &pos.x, &pos.y, &pos.z);
-		_tiles.push_back(Tile(pos));
+		_tiles.push_back(Tile(pos, &_tileStorage, i));
+		_tiles.back().setEnviList(&_enviTiles);
 	}
 
 }
@@ -1008,10 +1004,7 @@ void SavedBattleGame::endTurn()
  */
 void SavedBattleGame::setDebugMode()
 {
-	for (int i = 0; i < _mapsize_z * _mapsize_y * _mapsize_x; ++i)
-	{
-		_tiles[i].setDiscovered(true, 2);
-	}
+	_tileStorage.setDiscovered(7);
 
 	_debugMode = true;
 }
@@ -1713,12 +1706,15 @@ void SavedBattleGame::prepareNewTurn()
 	std::vector<Tile*> tilesOnFire;
 	std::vector<Tile*> tilesOnSmoke;
 
+	// tiles are kept in one vector, so sorting by address gives the same order as going through the whole map
+	std::sort(_enviTiles.begin(), _enviTiles.end());
+
 	// prepare a list of tiles on fire
-	for (int i = 0; i < _mapsize_x * _mapsize_y * _mapsize_z; ++i)
+	for (std::vector<Tile*>::iterator i = _enviTiles.begin(); i != _enviTiles.end(); ++i)
 	{
-		if (getTile(i)->getFire() > 0)
+		if ((*i)->getFire() > 0)
 		{
-			tilesOnFire.push_back(getTile(i));
+			tilesOnFire.push_back(*i);
 		}
 	}
 
@@ -1783,11 +1779,12 @@ void SavedBattleGame::prepareNewTurn()
 	}
 
 	// prepare a list of tiles on fire/with smoke in them (smoke acts as fire intensity)
-	for (int i = 0; i < _mapsize_x * _mapsize_y * _mapsize_z; ++i)
+	std::sort(_enviTiles.begin(), _enviTiles.end());
+	for (std::vector<Tile*>::iterator i = _enviTiles.begin(); i != _enviTiles.end(); ++i)
 	{
-		if (getTile(i)->getSmoke() > 0)
+		if ((*i)->getSmoke() > 0)
 		{
-			tilesOnSmoke.push_back(getTile(i));
+			tilesOnSmoke.push_back(*i);
 		}
 	}
 
@@ -1846,13 +1843,29 @@ void SavedBattleGame::prepareNewTurn()
 	if (!tilesOnFire.empty() || !tilesOnSmoke.empty())
 	{
 		// do damage to units, average out the smoke, etc.
-		for (int i = 0; i < _mapsize_x * _mapsize_y * _mapsize_z; ++i)
+		std::sort(_enviTiles.begin(), _enviTiles.end());
+		for (std::vector<Tile*>::iterator i = _enviTiles.begin(); i != _enviTiles.end(); ++i)
 		{
-			if (getTile(i)->getSmoke() != 0)
-				getTile(i)->prepareNewTurn();
+			if ((*i)->getSmoke() != 0)
+				(*i)->prepareNewTurn();
 		}
 	}
 
+	// forget tiles where everything burnt out
+	std::vector<Tile*>::iterator last = _enviTiles.begin();
+	for (std::vector<Tile*>::iterator i = _enviTiles.begin(); i != _enviTiles.end(); ++i)
+	{
+		if ((*i)->getFire() == 0 && (*i)->getSmoke() == 0)
+		{
+			(*i)->clearEnviListed();
+		}
+		else
+		{
+			*last++ = *i;
+		}
+	}
+	_enviTiles.erase(last, _enviTiles.end());
+
 	Mod *mod = getBattleState()->getGame()->getMod();
 	for (std::vector<BattleUnit*>::iterator i = getUnits()->begin(); i != getUnits()->end(); ++i)
 	{
@@ -2210,12 +2223,7 @@ void SavedBattleGame::resetTurnCounter()
  */
 void SavedBattleGame::resetTiles()
 {
-	for (int i = 0; i != getMapSizeXYZ(); ++i)
-	{
-		_tiles[i].setDiscovered(false, 0);
-		_tiles[i].setDiscovered(false, 1);
-		_tiles[i].setDiscovered(false, 2);
-	}
+	_tileStorage.setDiscovered(0);
 }
 
 /**
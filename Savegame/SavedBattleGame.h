@@ -53,6 +53,8 @@ private:
 	int _mapsize_x, _mapsize_y, _mapsize_z;
 	std::vector<MapDataSet*> _mapDataSets;
 	std::vector<Tile> _tiles;
+	TileStorage _tileStorage;
+	std::vector<Tile*> _enviTiles;
 	BattleUnit *_selectedUnit, *_lastSelectedUnit;
 	std::vector<Node*> _nodes;
 	std::vector<BattleUnit*> _units;
@@ -175,6 +177,8 @@ public:
 	{
 		return &_tiles[i];
 	}
+	/// Gets the dense arrays with most used values of all tiles.
+	TileStorage *getTileStorage() { return &_tileStorage; }
 	/// Gets the currently selected unit.
 	BattleUnit *getSelectedUnit() const;
 	/// Sets the currently selected unit.
@@ -22,7 +22,9 @@
 #include <set>
 #include <iomanip>
 #include <algorithm>
+#include <iterator>
 #include <yaml-cpp/yaml.h>
+#include "../lodepng.h"
 #include "../version.h"
 #include "../Engine/Logger.h"
 #include "../Mod/Mod.h"
@@ -204,8 +206,17 @@ static bool _isCurrentGameType(const SaveInfo &saveInfo, const std::string &curM
 	return true;
 }
 
+/// File in the user folder caching the brief info of every save.
+static const std::string SAVE_INDEX = "saves.idx";
+/// First line of a compressed save, brief info follows as plain YAML.
+static const std::string COMPRESSED_MAGIC = "#OXCZ deflate";
+/// Line ending brief info of a compressed save, followed by size and zlib data of the full game data.
+static const std::string COMPRESSED_BODY = "#OXCZ body ";
+
 /**
  * Gets all the info of the saves found in the user folder.
+ * The brief info is cached in an index file, so only new or
+ * changed saves have to be read.
  * @param lang Loaded language.
  * @param autoquick Include autosaves and quicksaves.
  * @return List of saves info.
@@ -214,18 +225,57 @@ std::vector<SaveInfo> SavedGame::getList(Language *lang, bool autoquick)
 {
 	std::vector<SaveInfo> info;
 	std::string curMaster = Options::getActiveMaster();
-	std::vector<std::string> saves = CrossPlatform::getFolderContents(Options::getMasterUserFolder(), "sav");
+	std::string folder = Options::getMasterUserFolder();
+	std::vector<std::string> saves = CrossPlatform::getFolderContents(folder, "sav");
 
 	if (autoquick)
 	{
-		std::vector<std::string> asaves = CrossPlatform::getFolderContents(Options::getMasterUserFolder(), "asav");
+		std::vector<std::string> asaves = CrossPlatform::getFolderContents(folder, "asav");
 		saves.insert(saves.begin(), asaves.begin(), asaves.end());
 	}
+
+	std::map<std::string, YAML::Node> index;
+	if (CrossPlatform::fileExists(folder + SAVE_INDEX))
+	{
+		try
+		{
+			YAML::Node doc = YAML::LoadFile(folder + SAVE_INDEX);
+			for (YAML::const_iterator i = doc.begin(); i != doc.end(); ++i)
+			{
+				const YAML::Node &entry = *i;
+				index.insert(std::make_pair(entry["file"].as<std::string>(), entry));
+			}
+		}
+		catch (YAML::Exception &e)
+		{
+			Log(LOG_WARNING) << SAVE_INDEX << ": " << e.what();
+			index.clear();
+		}
+	}
+	bool changed = false;
+
 	for (std::vector<std::string>::iterator i = saves.begin(); i != saves.end(); ++i)
 	{
 		try
 		{
-			SaveInfo saveInfo = getSaveInfo(*i, lang);
+			std::string fullname = folder + *i;
+			Uint64 size = CrossPlatform::getFileSize(fullname);
+			time_t timestamp = CrossPlatform::getDateModified(fullname);
+
+			std::map<std::string, YAML::Node>::iterator entry = index.find(*i);
+			if (entry == index.end() || entry->second["size"].as<Uint64>(0) != size || entry->second["modified"].as<time_t>(0) != timestamp)
+			{
+				YAML::Node node;
+				node["file"] = *i;
+				node["size"] = size;
+				node["modified"] = timestamp;
+				node["brief"] = loadBrief(fullname);
+				index.erase(*i);
+				entry = index.insert(std::make_pair(*i, node)).first;
+				changed = true;
+			}
+
+			SaveInfo saveInfo = getSaveInfo(*i, lang, entry->second["brief"], timestamp);
 			if (!_isCurrentGameType(saveInfo, curMaster))
 			{
 				continue;
@@ -235,15 +285,52 @@ std::vector<SaveInfo> SavedGame::getList(Language *lang, bool autoquick)
 		catch (Exception &e)
 		{
 			Log(LOG_ERROR) << (*i) << ": " << e.what();
+			index.erase(*i);
 			continue;
 		}
 		catch (YAML::Exception &e)
 		{
 			Log(LOG_ERROR) << (*i) << ": " << e.what();
+			index.erase(*i);
 			continue;
 		}
 	}
 
+	// forget deleted saves, keep the ones that weren't listed this time
+	for (std::map<std::string, YAML::Node>::iterator i = index.begin(); i != index.end();)
+	{
+		if (std::find(saves.begin(), saves.end(), i->first) == saves.end() && !CrossPlatform::fileExists(folder + i->first))
+		{
+			index.erase(i++);
+			changed = true;
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	if (changed)
+	{
+		YAML::Emitter out;
+		out << YAML::BeginSeq;
+		for (std::map<std::string, YAML::Node>::const_iterator i = index.begin(); i != index.end(); ++i)
+		{
+			out << i->second;
+		}
+		out << YAML::EndSeq;
+
+		std::ofstream file((folder + SAVE_INDEX).c_str());
+		if (file)
+		{
+			file << out.c_str() << std::endl;
+		}
+		else
+		{
+			Log(LOG_WARNING) << "Failed to save " << SAVE_INDEX;
+		}
+	}
+
 	return info;
 }
 
@@ -251,11 +338,12 @@ std::vector<SaveInfo> SavedGame::getList(Language *lang, bool autoquick)
  * Gets the info of a specific save file.
  * @param file Save filename.
  * @param lang Loaded language.
+ * @param brief Brief info stored at the start of the save.
+ * @param timestamp Date the save was last modified.
  */
-SaveInfo SavedGame::getSaveInfo(const std::string &file, Language *lang)
+SaveInfo SavedGame::getSaveInfo(const std::string &file, Language *lang, const YAML::Node &brief, time_t timestamp)
 {
-	std::string fullname = Options::getMasterUserFolder() + file;
-	YAML::Node doc = YAML::LoadFile(fullname);
+	const YAML::Node &doc = brief;
 	SaveInfo save;
 
 	save.fileName = file;
@@ -288,7 +376,7 @@ SaveInfo SavedGame::getSaveInfo(const std::string &file, Language *lang)
 		save.reserved = false;
 	}
 
-	save.timestamp = CrossPlatform::getDateModified(fullname);
+	save.timestamp = timestamp;
 	std::pair<std::wstring, std::wstring> str = CrossPlatform::timeToString(save.timestamp);
 	save.isoDate = str.first;
 	save.isoTime = str.second;
@@ -317,6 +405,105 @@ SaveInfo SavedGame::getSaveInfo(const std::string &file, Language *lang)
 	return save;
 }
 
+/**
+ * Reads the brief save info, the first YAML document of a save,
+ * without reading or parsing the rest of the file.
+ * @param filename Full path of the save.
+ * @return Brief save info.
+ */
+YAML::Node SavedGame::loadBrief(const std::string &filename)
+{
+	std::ifstream file(filename.c_str());
+	if (!file)
+	{
+		throw Exception(filename + " not found");
+	}
+
+	std::string brief, line;
+	while (std::getline(file, line))
+	{
+		// the next document starts at a "---" marker, a leading one belongs to the brief
+		bool marker = line.compare(0, 3, "---") == 0 && (line.size() == 3 || line[3] == ' ' || line[3] == '\r');
+		if (marker && brief.find_first_not_of(" \r\n") != std::string::npos)
+		{
+			break;
+		}
+		// compressed data starts right after the brief
+		if (line.compare(0, COMPRESSED_BODY.size(), COMPRESSED_BODY) == 0)
+		{
+			break;
+		}
+		brief += line;
+		brief += '\n';
+	}
+	YAML::Node doc = YAML::Load(brief);
+	if (!doc.IsMap())
+	{
+		throw Exception(filename + " is not a vaild save file");
+	}
+	return doc;
+}
+
+/**
+ * Loads all YAML documents of a save, decompressing the full
+ * game data if needed.
+ * @param filename Full path of the save.
+ * @return Brief save info and full game data.
+ */
+std::vector<YAML::Node> SavedGame::loadDocuments(const std::string &filename)
+{
+	std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+	if (!file)
+	{
+		throw Exception(filename + " not found");
+	}
+
+	std::string line;
+	std::getline(file, line);
+	if (line.compare(0, COMPRESSED_MAGIC.size(), COMPRESSED_MAGIC) != 0)
+	{
+		file.close();
+		return YAML::LoadAllFromFile(filename);
+	}
+
+	std::string brief;
+	size_t size = 0;
+	bool found = false;
+	while (std::getline(file, line))
+	{
+		if (line.compare(0, COMPRESSED_BODY.size(), COMPRESSED_BODY) == 0)
+		{
+			std::istringstream ss(line.substr(COMPRESSED_BODY.size()));
+			found = !!(ss >> size);
+			break;
+		}
+		brief += line;
+		brief += '\n';
+	}
+	if (!found)
+	{
+		throw Exception(filename + " is not a vaild save file");
+	}
+
+	std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	std::vector<unsigned char> body;
+	body.reserve(size);
+	unsigned error = lodepng::decompress(body, data);
+	if (error)
+	{
+		throw Exception(filename + ": " + lodepng_error_text(error));
+	}
+	if (body.size() != size)
+	{
+		throw Exception(filename + " is not a vaild save file");
+	}
+
+	std::vector<YAML::Node> docs;
+	docs.push_back(YAML::Load(brief));
+	docs.push_back(YAML::Load(std::string(body.begin(), body.end())));
+	return docs;
+}
+
 /**
  * Loads a saved game's contents from a YAML file.
  * @note Assumes the saved game is blank.
@@ -326,7 +513,7 @@ SaveInfo SavedGame::getSaveInfo(const std::string &file, Language *lang)
 void SavedGame::load(const std::string &filename, Mod *mod)
 {
 	std::string s = Options::getMasterUserFolder() + filename;
-	std::vector<YAML::Node> file = YAML::LoadAllFromFile(s);
+	std::vector<YAML::Node> file = loadDocuments(s);
 	if (file.empty())
 	{
 		throw Exception(filename + " is not a vaild save file");
@@ -615,8 +802,9 @@ void SavedGame::load(const std::string &filename, Mod *mod)
  */
 void SavedGame::save(const std::string &filename) const
 {
+	Uint32 startTime = SDL_GetTicks();
 	std::string s = Options::getMasterUserFolder() + filename;
-	std::ofstream sav(s.c_str());
+	std::ofstream sav(s.c_str(), Options::compressSaves ? std::ios::out | std::ios::binary : std::ios::out);
 	if (!sav)
 	{
 		throw Exception("Failed to save " + filename);
@@ -664,6 +852,7 @@ void SavedGame::save(const std::string &filename) const
 	if (_ironman)
 		brief["ironman"] = _ironman;
 	out << brief;
+	const size_t briefSize = out.size();
 	// Saves the full game data to the save
 	out << YAML::BeginDoc;
 	YAML::Node node;
@@ -772,7 +961,26 @@ void SavedGame::save(const std::string &filename) const
 		node["battleGame"] = _battleGame->save();
 	}
 	out << node;
-	sav << out.c_str();
+	if (Options::compressSaves)
+	{
+		// brief info stays plain text, so the saves list can read it without decompressing
+		std::vector<unsigned char> data;
+		unsigned error = lodepng::compress(data, (const unsigned char*)out.c_str() + briefSize, out.size() - briefSize);
+		if (error)
+		{
+			throw Exception("Failed to save " + filename + ": " + lodepng_error_text(error));
+		}
+		sav << COMPRESSED_MAGIC << '\n';
+		sav.write(out.c_str(), briefSize);
+		sav << '\n' << COMPRESSED_BODY << (out.size() - briefSize) << '\n';
+		sav.write((const char*)&data[0], data.size());
+		Log(LOG_DEBUG) << "Saved " << filename << ": " << data.size() << " bytes compressed from " << out.size() << " in " << (SDL_GetTicks() - startTime) << " ms";
+	}
+	else
+	{
+		sav << out.c_str();
+		Log(LOG_DEBUG) << "Saved " << filename << ": " << out.size() << " bytes in " << (SDL_GetTicks() - startTime) << " ms";
+	}
 	sav.close();
 }
 
@@ -28,6 +28,11 @@
 #include "../Savegame/Craft.h"
 #include "../Mod/RuleManufacture.h"
 
+namespace YAML
+{
+	class Node;
+}
+
 namespace OpenXcom
 {
 
@@ -147,7 +152,9 @@ private:
 	std::set<const RuleItem *> _autosales;
 
 	void getDependableResearchBasic (std::vector<RuleResearch*> & dependables, const RuleResearch *research, const Mod *mod, Base *base) const;
-	static SaveInfo getSaveInfo(const std::string &file, Language *lang);
+	static SaveInfo getSaveInfo(const std::string &file, Language *lang, const YAML::Node &brief, time_t timestamp);
+	static YAML::Node loadBrief(const std::string &filename);
+	static std::vector<YAML::Node> loadDocuments(const std::string &filename);
 public:
 	static const std::string AUTOSAVE_GEOSCAPE, AUTOSAVE_BATTLESCAPE, QUICKSAVE;
 	/// Creates a new saved game.
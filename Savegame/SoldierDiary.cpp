@@ -243,6 +243,63 @@ std::vector<SoldierCommendations*> *SoldierDiary::getSoldierCommendations()
 	return &_commendations;
 }
 
+/**
+ * Gets the soldier's total used by a commendation criterion without noun.
+ * @param type Criterion type.
+ * @param mod Game mod.
+ * @param missionStatistics List of all missions.
+ * @return Total to compare with the criterion thresholds.
+ */
+int SoldierDiary::getCriterionTotal(CommendationCriterion type, Mod *mod, std::vector<MissionStatistics*> *missionStatistics) const
+{
+	switch (type)
+	{
+	case CC_TOTAL_KILLS: return getKillTotal();
+	case CC_TOTAL_MISSIONS: return _missionIdList.size();
+	case CC_TOTAL_WINS: return getWinTotal(missionStatistics);
+	case CC_TOTAL_SCORE: return getScoreTotal(missionStatistics);
+	case CC_TOTAL_STUNS: return getStunTotal();
+	case CC_TOTAL_DAYS_WOUNDED: return _daysWoundedTotal;
+	case CC_TOTAL_BASE_DEFENSE_MISSIONS: return getBaseDefenseMissionTotal(missionStatistics);
+	case CC_TOTAL_TERROR_MISSIONS: return getTerrorMissionTotal(missionStatistics);
+	case CC_TOTAL_NIGHT_MISSIONS: return getNightMissionTotal(missionStatistics);
+	case CC_TOTAL_NIGHT_TERROR_MISSIONS: return getNightTerrorMissionTotal(missionStatistics);
+	case CC_TOTAL_MONTHLY_SERVICE: return _monthsService;
+	case CC_TOTAL_FELL_UNCONCIOUS: return _unconciousTotal;
+	case CC_TOTAL_SHOT_AT_10_TIMES: return _shotAtCounter10in1Mission;
+	case CC_TOTAL_HIT_5_TIMES: return _hitCounter5in1Mission;
+	case CC_TOTAL_FRIENDLY_FIRED: return _totalShotByFriendlyCounter;
+	case CC_TOTAL_LONE_SURVIVOR: return _loneSurvivorTotal;
+	case CC_TOTAL_IRON_MAN: return _ironManTotal;
+	case CC_TOTAL_IMPORTANT_MISSIONS: return getImportantMissionTotal(missionStatistics);
+	case CC_TOTAL_LONG_DISTANCE_HITS: return _longDistanceHitCounterTotal;
+	case CC_TOTAL_LOW_ACCURACY_HITS: return _lowAccuracyHitCounterTotal;
+	case CC_TOTAL_REACTION_FIRE: return getReactionFireKillTotal(mod);
+	case CC_TOTAL_TIMES_WOUNDED: return _timesWoundedTotal;
+	case CC_TOTAL_VALIANT_CRUX: return getValiantCruxTotal(missionStatistics);
+	case CC_IS_DEAD: return _KIA;
+	case CC_TOTAL_TRAP_KILLS: return getTrapKillTotal(mod);
+	case CC_TOTAL_ALIEN_BASE_ASSAULTS: return getAlienBaseAssaultTotal(missionStatistics);
+	case CC_TOTAL_ALL_ALIENS_KILLED: return _allAliensKilledTotal;
+	case CC_TOTAL_ALL_ALIENS_STUNNED: return _allAliensStunnedTotal;
+	case CC_TOTAL_WOUNDS_HEALED: return _woundsHealedTotal;
+	case CC_TOTAL_ALL_UFOS: return _allUFOs;
+	case CC_TOTAL_ALL_MISSION_TYPES: return _allMissionTypes;
+	case CC_TOTAL_STAT_GAIN: return _statGainTotal;
+	case CC_TOTAL_REVIVES: return _revivedUnitTotal;
+	case CC_TOTAL_WHOLE_MEDIKIT: return _wholeMedikitTotal;
+	case CC_TOTAL_BRAVERY_GAIN: return _braveryGainTotal;
+	case CC_BEST_OF_RANK: return _bestOfRank;
+	case CC_BEST_SOLDIER: return (int)_bestSoldier;
+	case CC_IS_MIA: return _MIA;
+	case CC_TOTAL_MARTYR_KILLS: return _martyrKillsTotal;
+	case CC_TOTAL_POST_MORTEM_KILLS: return _postMortemKills;
+	case CC_GLOBE_TROTTER: return (int)_globeTrotter;
+	case CC_TOTAL_SLAVE_KILLS: return _slaveKillsTotal;
+	default: return 0;
+	}
+}
+
 /**
  * Manage the soldier's commendations.
  * Award new ones, if deserved.
@@ -250,13 +307,21 @@ std::vector<SoldierCommendations*> *SoldierDiary::getSoldierCommendations()
  */
 bool SoldierDiary::manageCommendations(Mod *mod, std::vector<MissionStatistics*> *missionStatistics)
 {
-	std::map<std::string, RuleCommendations *> commendationsList = mod->getCommendation();
+	static const std::string battleTypeArray[] = { "BT_NONE", "BT_FIREARM", "BT_AMMO", "BT_MELEE", "BT_GRENADE",
+		"BT_PROXIMITYGRENADE", "BT_MEDIKIT", "BT_SCANNER", "BT_MINDPROBE", "BT_PSIAMP", "BT_FLARE", "BT_CORPSE", "BT_END" };
+	static const std::string damageTypeArray[] = { "DT_NONE", "DT_AP", "DT_IN", "DT_HE", "DT_LASER", "DT_PLASMA",
+		"DT_STUN", "DT_MELEE", "DT_ACID", "DT_SMOKE", "DT_END"};
+
+	const std::map<std::string, RuleCommendations *> &commendationsList = mod->getCommendation();
 	bool awardedCommendation = false;                   // This value is returned if at least one commendation was given.
 	std::map<std::string, int> nextCommendationLevel;   // Noun, threshold.
 	std::vector<std::string> modularCommendations;      // Commendation name.
 	bool awardCommendationBool = false;                 // This value determines if a commendation will be given.
+	// Totals don't change while awarding, calculate each of them only once.
+	int criterionTotal[CC_MAX];
+	bool criterionTotalKnown[CC_MAX] = { };
 	// Loop over all possible commendations
-	for (std::map<std::string, RuleCommendations *>::iterator i = commendationsList.begin(); i != commendationsList.end(); )
+	for (std::map<std::string, RuleCommendations *>::const_iterator i = commendationsList.begin(); i != commendationsList.end(); )
 	{
 		awardCommendationBool = true;
 		nextCommendationLevel.clear();
@@ -271,91 +336,69 @@ bool SoldierDiary::manageCommendations(Mod *mod, std::vector<MissionStatistics*>
 				nextCommendationLevel[(*j)->getNoun()] = (*j)->getDecorationLevelInt() + 1;
 			}
 		}
+		const int nextLevel = nextCommendationLevel["noNoun"];
 		// Go through each possible criteria. Assume the medal is awarded, set to false if not.
 		// As soon as we find a medal criteria that we FAIL TO achieve, then we are not awarded a medal.
-		for (std::map<std::string, std::vector<int> >::const_iterator j = (*i).second->getCriteria()->begin(); j != (*i).second->getCriteria()->end(); ++j)
+		for (std::vector<CommendationCriteria>::const_iterator j = (*i).second->getCompiledCriteria().begin(); j != (*i).second->getCompiledCriteria().end(); ++j)
 		{
+			const CommendationCriterion type = (*j).type;
+			const std::vector<int> &levels = *(*j).levels;
 			// Skip this medal if we have reached its max award level.
-			if ((unsigned int)nextCommendationLevel["noNoun"] >= (*j).second.size())
+			if ((unsigned int)nextLevel >= levels.size())
 			{
 				awardCommendationBool = false;
 				break;
 			}
 			// These criteria have no nouns, so only the nextCommendationLevel["noNoun"] will ever be used.
-			else if( nextCommendationLevel.count("noNoun") == 1 &&
-				  ( ((*j).first == "totalKills" && (unsigned int)getKillTotal() < (unsigned int)(*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalMissions" && _missionIdList.size() < (unsigned int)(*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalWins" && getWinTotal(missionStatistics) < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalScore" && getScoreTotal(missionStatistics) < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalStuns" && getStunTotal() < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalDaysWounded" && _daysWoundedTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalBaseDefenseMissions" && getBaseDefenseMissionTotal(missionStatistics) < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalTerrorMissions" && getTerrorMissionTotal(missionStatistics) < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalNightMissions" && getNightMissionTotal(missionStatistics) < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalNightTerrorMissions" && getNightTerrorMissionTotal(missionStatistics) < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalMonthlyService" && _monthsService < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalFellUnconcious" && _unconciousTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalShotAt10Times" && _shotAtCounter10in1Mission < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalHit5Times" && _hitCounter5in1Mission < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalFriendlyFired" && (_totalShotByFriendlyCounter < (*j).second.at(nextCommendationLevel["noNoun"]) || _KIA || _MIA)) ||
-					((*j).first == "total_lone_survivor" && _loneSurvivorTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalIronMan" && _ironManTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalImportantMissions" && getImportantMissionTotal(missionStatistics) < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalLongDistanceHits" && _longDistanceHitCounterTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalLowAccuracyHits" && _lowAccuracyHitCounterTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalReactionFire" && getReactionFireKillTotal(mod) < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalTimesWounded" && _timesWoundedTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalDaysWounded" && _daysWoundedTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalValientCrux" && getValiantCruxTotal(missionStatistics) < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "isDead" && _KIA < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalTrapKills" && getTrapKillTotal(mod) < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalAlienBaseAssaults" && getAlienBaseAssaultTotal(missionStatistics) < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalAllAliensKilled" && _allAliensKilledTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalAllAliensStunned" && _allAliensStunnedTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalWoundsHealed" && _woundsHealedTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalAllUFOs" && _allUFOs < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalAllMissionTypes" && _allMissionTypes < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalStatGain" && _statGainTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalRevives" && _revivedUnitTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalWholeMedikit" && _wholeMedikitTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalBraveryGain" && _braveryGainTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "bestOfRank" && _bestOfRank < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "bestSoldier" && (int)_bestSoldier < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "isMIA" && _MIA < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalMartyrKills" && _martyrKillsTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalPostMortemKills" && _postMortemKills < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "globeTrotter" && (int)_globeTrotter < (*j).second.at(nextCommendationLevel["noNoun"])) ||
-					((*j).first == "totalSlaveKills" && _slaveKillsTotal < (*j).second.at(nextCommendationLevel["noNoun"])) ) )
-
+			else if (type > CC_UNKNOWN && type < CC_TOTAL_KILLS_WITH_A_WEAPON)
 			{
-				awardCommendationBool = false;
-				break;
+				if (!criterionTotalKnown[type])
+				{
+					criterionTotal[type] = getCriterionTotal(type, mod, missionStatistics);
+					criterionTotalKnown[type] = true;
+				}
+				const int total = criterionTotal[type];
+				const int threshold = levels.at(nextLevel);
+				bool failed;
+				if (type == CC_TOTAL_KILLS || type == CC_TOTAL_MISSIONS)
+					failed = (unsigned int)total < (unsigned int)threshold;
+				else if (type == CC_TOTAL_FRIENDLY_FIRED)
+					failed = total < threshold || _KIA || _MIA;
+				else
+					failed = total < threshold;
+
+				if (failed)
+				{
+					awardCommendationBool = false;
+					break;
+				}
 			}
 			// Medals with the following criteria are unique because they need a noun.
 			// And because they loop over a map<> (this allows for maximum moddability).
-			else if ((*j).first == "totalKillsWithAWeapon" || (*j).first == "totalMissionsInARegion" || (*j).first == "totalKillsByRace" || (*j).first == "totalKillsByRank")
+			else if (type == CC_TOTAL_KILLS_WITH_A_WEAPON || type == CC_TOTAL_MISSIONS_IN_A_REGION || type == CC_TOTAL_KILLS_BY_RACE || type == CC_TOTAL_KILLS_BY_RANK)
 			{
 				std::map<std::string, int> tempTotal;
-				if ((*j).first == "totalKillsWithAWeapon")
+				if (type == CC_TOTAL_KILLS_WITH_A_WEAPON)
 					tempTotal = getWeaponTotal();
-				else if ((*j).first == "totalMissionsInARegion")
+				else if (type == CC_TOTAL_MISSIONS_IN_A_REGION)
 					tempTotal = getRegionTotal(missionStatistics);
-				else if ((*j).first == "totalKillsByRace")
+				else if (type == CC_TOTAL_KILLS_BY_RACE)
 					tempTotal = getAlienRaceTotal();
-				else if ((*j).first == "totalKillsByRank")
+				else if (type == CC_TOTAL_KILLS_BY_RANK)
 					tempTotal = getAlienRankTotal();
 				// Loop over the temporary map.
 				// Match nouns and decoration levels.
 				for(std::map<std::string, int>::const_iterator k = tempTotal.begin(); k != tempTotal.end(); ++k)
 				{
 					int criteria = -1;
-									std::string noun = (*k).first;
+					const std::string &noun = (*k).first;
+					std::map<std::string, int>::const_iterator level = nextCommendationLevel.find(noun);
 					// If there is no matching noun, get the first award criteria.
-									if (nextCommendationLevel.count(noun) == 0)
-						criteria = (*j).second.front();
+					if (level == nextCommendationLevel.end())
+						criteria = levels.front();
 					// Otherwise, get the criteria that reflects the soldier's commendation level.
-									else if ((unsigned int)nextCommendationLevel[noun] != (*j).second.size())
-						criteria = (*j).second.at(nextCommendationLevel[noun]);
+					else if ((unsigned int)level->second != levels.size())
+						criteria = levels.at(level->second);
 
 					// If a criteria was set AND the stat's count exceeds the criteria.
 					if (criteria != -1 && (*k).second >= criteria)
@@ -374,7 +417,7 @@ bool SoldierDiary::manageCommendations(Mod *mod, std::vector<MissionStatistics*>
 					awardCommendationBool = true;
 				}
 			}
-			else if ((*j).first == "killsWithCriteriaCareer" || (*j).first == "killsWithCriteriaMission" || (*j).first == "killsWithCriteriaTurn")
+			else if (type == CC_KILLS_WITH_CRITERIA_CAREER || type == CC_KILLS_WITH_CRITERIA_MISSION || type == CC_KILLS_WITH_CRITERIA_TURN)
 			{
 				// Fetch the kill criteria list.
 				std::vector<std::map<int, std::vector<std::string> > > *_killCriteriaList = (*i).second->getKillCriteria();
@@ -385,8 +428,31 @@ bool SoldierDiary::manageCommendations(Mod *mod, std::vector<MissionStatistics*>
 					// Loop over the AND vectors.
 					for (std::map<int, std::vector<std::string> >::const_iterator andCriteria = orCriteria->begin(); andCriteria != orCriteria->end(); ++andCriteria)
 					{
+						// Resolve battle and damage types of DETAILs once, not for every kill.
+						std::vector<std::pair<int, int> > detailTypes;
+						for (std::vector<std::string>::const_iterator detail = andCriteria->second.begin(); detail != andCriteria->second.end(); ++detail)
+						{
+							int battleType = 0;
+							for (; battleType != 13; ++battleType)
+							{
+								if ((*detail) == battleTypeArray[battleType])
+								{
+									break;
+								}
+							}
+							int damageType = 0;
+							for (; damageType != 11; ++damageType)
+							{
+								if ((*detail) == damageTypeArray[damageType])
+								{
+									break;
+								}
+							}
+							detailTypes.push_back(std::make_pair(battleType, damageType));
+						}
+
 						int count = 0; // How many AND vectors (list of DETAILs) have been successful.
-						if ((*j).first == "killsWithCriteriaTurn" || (*j).first == "killsWithCriteriaMission")
+						if (type == CC_KILLS_WITH_CRITERIA_TURN || type == CC_KILLS_WITH_CRITERIA_MISSION)
 							count++; // Turns and missions start at 1 because of how thisTime and lastTime work.
 						int thisTime = -1; // Time being a turn or a mission.
 						int lastTime = -1;
@@ -394,7 +460,7 @@ bool SoldierDiary::manageCommendations(Mod *mod, std::vector<MissionStatistics*>
 						// Loop over the KILLS.
 						for (std::vector<BattleUnitKills*>::const_iterator singleKill = _killList.begin(); singleKill != _killList.end(); ++singleKill)
 						{
-							if ((*j).first == "killsWithCriteriaMission")
+							if (type == CC_KILLS_WITH_CRITERIA_MISSION)
 							{
 								thisTime = (*singleKill)->mission;
 								if (singleKill != _killList.begin())
@@ -404,7 +470,7 @@ bool SoldierDiary::manageCommendations(Mod *mod, std::vector<MissionStatistics*>
 									++singleKill;
 								}
 							}
-							else if ((*j).first == "killsWithCriteriaTurn")
+							else if (type == CC_KILLS_WITH_CRITERIA_TURN)
 							{
 								thisTime = (*singleKill)->turn;
 								if (singleKill != _killList.begin())
@@ -416,51 +482,33 @@ bool SoldierDiary::manageCommendations(Mod *mod, std::vector<MissionStatistics*>
 							}
 							// Skip kill-groups that we already got an award for.
 							// Skip kills that are inbetween turns.
-							if ( thisTime == lastTime && goToNextTime && (*j).first != "killsWithCriteriaCareer")
+							if ( thisTime == lastTime && goToNextTime && type != CC_KILLS_WITH_CRITERIA_CAREER)
 							{
 								continue;
 							}
-							else if (thisTime != lastTime && (*j).first != "killsWithCriteriaCareer") 
+							else if (thisTime != lastTime && type != CC_KILLS_WITH_CRITERIA_CAREER) 
 							{
 								count = 1; // Reset.
 								goToNextTime = false;
 								continue;
 							}
 							bool foundMatch = true;
+							RuleItem *weapon = mod->getItem((*singleKill)->weaponAmmo);
+							RuleItem *weaponAmmo = mod->getItem((*singleKill)->weaponAmmo);
 							
 							// Loop over the DETAILs of the AND vector.
-							for (std::vector<std::string>::const_iterator detail = andCriteria->second.begin(); detail != andCriteria->second.end(); ++detail)
+							for (size_t detail = 0; detail != andCriteria->second.size(); ++detail)
 							{
-								std::string battleTypeArray[] = { "BT_NONE", "BT_FIREARM", "BT_AMMO", "BT_MELEE", "BT_GRENADE",
-									"BT_PROXIMITYGRENADE", "BT_MEDIKIT", "BT_SCANNER", "BT_MINDPROBE", "BT_PSIAMP", "BT_FLARE", "BT_CORPSE", "BT_END" };
-								int battleType = 0;
-								for (; battleType != 13; ++battleType)
-								{
-									if ((*detail) == battleTypeArray[battleType])
-									{
-										break;
-									}
-								}
-
-								std::string damageTypeArray[] = { "DT_NONE", "DT_AP", "DT_IN", "DT_HE", "DT_LASER", "DT_PLASMA",
-									"DT_STUN", "DT_MELEE", "DT_ACID", "DT_SMOKE", "DT_END"};
-								int damageType = 0;
-								for (; damageType != 11; ++damageType)
-								{
-									if ((*detail) == damageTypeArray[damageType])
-									{
-										break;
-									}
-								}
+								const std::string &name = andCriteria->second[detail];
+								const int battleType = detailTypes[detail].first;
+								const int damageType = detailTypes[detail].second;
 
 								// See if we find no matches with any criteria. If so, break and try the next kill.
-								RuleItem *weapon = mod->getItem((*singleKill)->weaponAmmo);
-								RuleItem *weaponAmmo = mod->getItem((*singleKill)->weaponAmmo);
 								if (weapon == 0 || weaponAmmo == 0 ||
-									((*singleKill)->rank != (*detail) && (*singleKill)->race != (*detail) &&
-									 (*singleKill)->weapon != (*detail) && (*singleKill)->weaponAmmo != (*detail) &&
-									 (*singleKill)->getUnitStatusString() != (*detail) && (*singleKill)->getUnitFactionString() != (*detail) &&
-									 (*singleKill)->getUnitSideString() != (*detail) && (*singleKill)->getUnitBodyPartString() != (*detail) &&
+									((*singleKill)->rank != name && (*singleKill)->race != name &&
+									 (*singleKill)->weapon != name && (*singleKill)->weaponAmmo != name &&
+									 (*singleKill)->getUnitStatusString() != name && (*singleKill)->getUnitFactionString() != name &&
+									 (*singleKill)->getUnitSideString() != name && (*singleKill)->getUnitBodyPartString() != name &&
 									 weaponAmmo->getDamageType()->ResistType != damageType && weapon->getBattleType() != battleType))
 								{
 									foundMatch = false;
@@ -476,7 +524,7 @@ bool SoldierDiary::manageCommendations(Mod *mod, std::vector<MissionStatistics*>
 						}
 						int multiCriteria = (*andCriteria).first;
 						// If one of the AND criteria fail, stop looking.
-						if (multiCriteria == 0 || count / multiCriteria < (*j).second.at(nextCommendationLevel["noNoun"]))
+						if (multiCriteria == 0 || count / multiCriteria < levels.at(nextLevel))
 						{
 							awardCommendationBool = false;
 							break;
@@ -21,6 +21,7 @@
 #include "BattleUnit.h"
 #include "SavedGame.h"
 #include "../Mod/Mod.h"
+#include "../Mod/RuleCommendations.h"
 
 namespace OpenXcom
 {
@@ -79,6 +80,8 @@ private:
 		_woundsHealedTotal, _allUFOs, _allMissionTypes, _statGainTotal, _revivedUnitTotal, _wholeMedikitTotal, _braveryGainTotal, _bestOfRank, _MIA,
 		_martyrKillsTotal, _postMortemKills, _slaveKillsTotal;
 	bool _bestSoldier, _globeTrotter;
+	/// Gets the soldier's total used by a commendation criterion without noun.
+	int getCriterionTotal(CommendationCriterion type, Mod *mod, std::vector<MissionStatistics*> *missionStatistics) const;
 	void manageModularCommendations(std::map<std::string, int> &nextCommendationLevel, std::map<std::string, int> &modularCommendations, std::pair<std::string, int> statTotal, int criteria);
 	void awardCommendation(std::string type, std::string noun = "noNoun");
 public:
@@ -28,7 +28,6 @@
 #include "../Mod/RuleItem.h"
 #include "../Mod/Armor.h"
 #include "SerializationHelper.h"
-#include "../Battlescape/Particle.h"
 
 namespace OpenXcom
 {
@@ -44,11 +43,55 @@ Tile::SerializationKey Tile::serializationKey =
  4 + 2*4 + 2*4 + 1 + 1 + 1 // total bytes to save one tile
 };
 
+/**
+ * Sets number of tiles in the arrays, all values are reset to zero.
+ * @param size Number of tiles.
+ */
+void TileStorage::resize(size_t size)
+{
+	for (int layer = 0; layer < LL_MAX; layer++)
+	{
+		light[layer].assign(size, 0);
+	}
+	smoke.assign(size, 0);
+	fire.assign(size, 0);
+	visible.assign(size, 0);
+	discovered.assign(size, 0);
+	unit.assign(size, 0);
+	for (int type = MT_WALK; type <= MT_SLIDE; type++)
+	{
+		tuCost[type].assign(size * 4, 0);
+	}
+}
+
+/**
+ * Resets light of all tiles at once, same as Tile::resetLightMulti on every tile.
+ * @param layer From with layer start reset.
+ */
+void TileStorage::resetLight(LightLayers layer)
+{
+	for (int l = layer; l < LL_MAX; l++)
+	{
+		std::fill(light[l].begin(), light[l].end(), 0);
+	}
+}
+
+/**
+ * Sets discovered flags of all tiles at once.
+ * @param flags Bits of discovered parts, 7 for all of them.
+ */
+void TileStorage::setDiscovered(Uint8 flags)
+{
+	std::fill(discovered.begin(), discovered.end(), flags);
+}
+
 /**
  * constructor
  * @param pos Position.
+ * @param storage Dense arrays with values of all tiles.
+ * @param index Index of this tile in the arrays.
  */
-Tile::Tile(const Position& pos): _smoke(0), _fire(0), _explosive(0), _explosiveType(0), _pos(pos), _unit(0), _animationOffset(0), _markerColor(0), _visible(false), _preview(-1), _TUMarker(-1), _overlaps(0), _danger(false)
+Tile::Tile(const Position& pos, TileStorage *storage, int index): _explosive(0), _explosiveType(0), _pos(pos), _animationOffset(0), _markerColor(0), _preview(-1), _TUMarker(-1), _overlaps(0), _danger(false), _enviListed(false), _proximityItems(false), _enviTiles(0), _storage(storage), _index(index)
 {
 	for (int i = 0; i < 4; ++i)
 	{
@@ -59,11 +102,16 @@ Tile::Tile(const Position& pos): _smoke(0), _fire(0), _explosive(0), _explosiveT
 	}
 	for (int layer = 0; layer < LL_MAX; layer++)
 	{
-		_light[layer] = 0;
+		_storage->light[layer][_index] = 0;
 	}
-	for (int i = 0; i < 3; ++i)
+	_storage->smoke[_index] = 0;
+	_storage->fire[_index] = 0;
+	_storage->visible[_index] = 0;
+	_storage->discovered[_index] = 0;
+	_storage->unit[_index] = 0;
+	for (int part = 0; part < 4; ++part)
 	{
-		_discovered[i] = false;
+		updateTUCost(part);
 	}
 }
 
@@ -73,11 +121,6 @@ Tile::Tile(const Position& pos): _smoke(0), _fire(0), _explosive(0), _explosiveT
 Tile::~Tile()
 {
 	_inventory.clear();
-	for (std::list<Particle*>::iterator i = _particles.begin(); i != _particles.end(); ++i)
-	{
-		delete *i;
-	}
-	_particles.clear();
 }
 
 /**
@@ -92,26 +135,31 @@ void Tile::load(const YAML::Node &node)
 		_mapDataID[i] = node["mapDataID"][i].as<int>(_mapDataID[i]);
 		_mapDataSetID[i] = node["mapDataSetID"][i].as<int>(_mapDataSetID[i]);
 	}
-	_fire = node["fire"].as<int>(_fire);
-	_smoke = node["smoke"].as<int>(_smoke);
+	_storage->fire[_index] = node["fire"].as<int>(_storage->fire[_index]);
+	_storage->smoke[_index] = node["smoke"].as<int>(_storage->smoke[_index]);
 	if (node["discovered"])
 	{
+		Uint8 &discovered = _storage->discovered[_index];
+		discovered = 0;
 		for (int i = 0; i < 3; i++)
 		{
-			_discovered[i] = node["discovered"][i].as<bool>();
+			discovered |= node["discovered"][i].as<bool>() ? (1 << i) : 0;
 		}
 	}
 	if (node["openDoorWest"])
 	{
 		_currentFrame[1] = 7;
+		updateTUCost(1);
 	}
 	if (node["openDoorNorth"])
 	{
 		_currentFrame[2] = 7;
+		updateTUCost(2);
 	}
-	if (_fire || _smoke)
+	if (_storage->fire[_index] || _storage->smoke[_index])
 	{
 		_animationOffset = std::rand() % 4;
+		markEnvi();
 	}
 }
 
@@ -131,18 +179,19 @@ void Tile::loadBinary(Uint8 *buffer, Tile::SerializationKey& serKey)
 	_mapDataSetID[2] = unserializeInt(&buffer, serKey._mapDataSetID);
 	_mapDataSetID[3] = unserializeInt(&buffer, serKey._mapDataSetID);
 
-	_smoke = unserializeInt(&buffer, serKey._smoke);
-	_fire = unserializeInt(&buffer, serKey._fire);
+	_storage->smoke[_index] = unserializeInt(&buffer, serKey._smoke);
+	_storage->fire[_index] = unserializeInt(&buffer, serKey._fire);
 
 	Uint8 boolFields = unserializeInt(&buffer, serKey.boolFields);
-	_discovered[0] = (boolFields & 1) ? true : false;
-	_discovered[1] = (boolFields & 2) ? true : false;
-	_discovered[2] = (boolFields & 4) ? true : false;
+	_storage->discovered[_index] = boolFields & 7;
 	_currentFrame[1] = (boolFields & 8) ? 7 : 0;
 	_currentFrame[2] = (boolFields & 0x10) ? 7 : 0;
-	if (_fire || _smoke)
+	updateTUCost(1);
+	updateTUCost(2);
+	if (_storage->fire[_index] || _storage->smoke[_index])
 	{
 		_animationOffset = std::rand() % 4;
+		markEnvi();
 	}
 }
 
@@ -160,15 +209,15 @@ YAML::Node Tile::save() const
 		node["mapDataID"].push_back(_mapDataID[i]);
 		node["mapDataSetID"].push_back(_mapDataSetID[i]);
 	}
-	if (_smoke)
-		node["smoke"] = _smoke;
-	if (_fire)
-		node["fire"] = _fire;
-	if (_discovered[0] || _discovered[1] || _discovered[2])
+	if (_storage->smoke[_index])
+		node["smoke"] = _storage->smoke[_index];
+	if (_storage->fire[_index])
+		node["fire"] = _storage->fire[_index];
+	if (_storage->discovered[_index])
 	{
 		for (int i = 0; i < 3; i++)
 		{
-			node["discovered"].push_back(_discovered[i]);
+			node["discovered"].push_back(isDiscovered(i));
 		}
 	}
 	if (isUfoDoorOpen(1))
@@ -197,10 +246,10 @@ void Tile::saveBinary(Uint8** buffer) const
 	serializeInt(buffer, serializationKey._mapDataSetID, _mapDataSetID[2]);
 	serializeInt(buffer, serializationKey._mapDataSetID, _mapDataSetID[3]);
 
-	serializeInt(buffer, serializationKey._smoke, _smoke);
-	serializeInt(buffer, serializationKey._fire, _fire);
+	serializeInt(buffer, serializationKey._smoke, _storage->smoke[_index]);
+	serializeInt(buffer, serializationKey._fire, _storage->fire[_index]);
 
-	Uint8 boolFields = (_discovered[0]?1:0) + (_discovered[1]?2:0) + (_discovered[2]?4:0);
+	Uint8 boolFields = _storage->discovered[_index] & 7;
 	boolFields |= isUfoDoorOpen(1) ? 8 : 0; // west
 	boolFields |= isUfoDoorOpen(2) ? 0x10 : 0; // north?
 	serializeInt(buffer, serializationKey.boolFields, boolFields);
@@ -227,6 +276,7 @@ void Tile::setMapData(MapData *dat, int mapDataID, int mapDataSetID, int part)
 			_currentFrame[part] = RNG::generateEx(7);
 		}
 	}
+	updateTUCost(part);
 
 }
 
@@ -249,7 +299,7 @@ void Tile::getMapData(int *mapDataID, int *mapDataSetID, int part) const
  */
 bool Tile::isVoid() const
 {
-	return _objects[0] == 0 && _objects[1] == 0 && _objects[2] == 0 && _objects[3] == 0 && _smoke == 0 && _inventory.empty();
+	return _objects[0] == 0 && _objects[1] == 0 && _objects[2] == 0 && _objects[3] == 0 && _storage->smoke[_index] == 0 && _inventory.empty();
 }
 
 /**
@@ -260,16 +310,34 @@ bool Tile::isVoid() const
  */
 int Tile::getTUCost(int part, MovementType movementType) const
 {
-	if (_objects[part])
+	if (movementType > MT_SLIDE)
 	{
-		if (_objects[part]->isUFODoor() && _currentFrame[part] > 1)
-			return 0;
-		if (part == O_OBJECT && _objects[part]->getBigWall() >= 4)
-			return 0;
-		return _objects[part]->getTUCost(movementType);
-	}
-	else
 		return 0;
+	}
+	return _storage->tuCost[movementType][_index * 4 + part];
+}
+
+/**
+ * Updates the stored TU costs of a tile part, needs to be
+ * called every time the part or its animation frame changes.
+ * @param part Tile part.
+ */
+void Tile::updateTUCost(int part)
+{
+	for (int type = MT_WALK; type <= MT_SLIDE; type++)
+	{
+		int cost = 0;
+		if (_objects[part])
+		{
+			if (_objects[part]->isUFODoor() && _currentFrame[part] > 1)
+				cost = 0;
+			else if (part == O_OBJECT && _objects[part]->getBigWall() >= 4)
+				cost = 0;
+			else
+				cost = _objects[part]->getTUCost((MovementType)type);
+		}
+		_storage->tuCost[type][_index * 4 + part] = cost;
+	}
 }
 
 /**
@@ -360,7 +428,7 @@ int Tile::openDoor(int part, BattleUnit *unit, BattleActionType reserve)
 	{
 		if (unit && cost.Time && !cost.haveTU())
 			return 4;
-		if (_unit && _unit != unit && _unit->getPosition() != getPosition())
+		if (getUnit() && getUnit() != unit && getUnit()->getPosition() != getPosition())
 			return -1;
 		setMapData(_objects[part]->getDataset()->getObjects()->at(_objects[part]->getAltMCD()), _objects[part]->getAltMCD(), _mapDataSetID[part],
 				   _objects[part]->getDataset()->getObjects()->at(_objects[part]->getAltMCD())->getObjectType());
@@ -372,6 +440,7 @@ int Tile::openDoor(int part, BattleUnit *unit, BattleActionType reserve)
 		if (unit && cost.Time && !cost.haveTU())
 			return 4;
 		_currentFrame[part] = 1; // start opening door
+		updateTUCost(part);
 		return 1;
 	}
 	if (_objects[part]->isUFODoor() && _currentFrame[part] != 7) // ufo door != part 7 - door is still opening
@@ -390,6 +459,7 @@ int Tile::closeUfoDoor()
 		if (isUfoDoorOpen(part))
 		{
 			_currentFrame[part] = 0;
+			updateTUCost(part);
 			retval = 1;
 		}
 	}
@@ -404,13 +474,20 @@ int Tile::closeUfoDoor()
  */
 void Tile::setDiscovered(bool flag, int part)
 {
-	if (_discovered[part] != flag)
+	Uint8 &discovered = _storage->discovered[_index];
+	if (isDiscovered(part) != flag)
 	{
-		_discovered[part] = flag;
+		if (flag)
+		{
+			discovered |= (1 << part);
+		}
+		else
+		{
+			discovered &= ~(1 << part);
+		}
 		if (part == 2 && flag == true)
 		{
-			_discovered[0] = true;
-			_discovered[1] = true;
+			discovered |= 3;
 		}
 	}
 }
@@ -422,7 +499,7 @@ void Tile::setDiscovered(bool flag, int part)
  */
 bool Tile::isDiscovered(int part) const
 {
-	return _discovered[part];
+	return (_storage->discovered[_index] >> part) & 1;
 }
 
 
@@ -432,7 +509,7 @@ bool Tile::isDiscovered(int part) const
  */
 void Tile::resetLight(LightLayers layer)
 {
-	_light[layer] = 0;
+	_storage->light[layer][_index] = 0;
 }
 
 /**
@@ -443,7 +520,7 @@ void Tile::resetLightMulti(LightLayers layer)
 {
 	for (int l = layer; l < LL_MAX; l++)
 	{
-		_light[l] = 0;
+		_storage->light[l][_index] = 0;
 	}
 }
 
@@ -454,8 +531,8 @@ void Tile::resetLightMulti(LightLayers layer)
  */
 void Tile::addLight(int light, LightLayers layer)
 {
-	if (_light[layer] < light)
-		_light[layer] = light;
+	if (_storage->light[layer][_index] < light)
+		_storage->light[layer][_index] = light;
 }
 
 /**
@@ -465,7 +542,7 @@ void Tile::addLight(int light, LightLayers layer)
  */
 int Tile::getLight(LightLayers layer) const
 {
-	return _light[layer];
+	return _storage->light[layer][_index];
 }
 
 int Tile::getLightMulti(LightLayers layer) const
@@ -474,8 +551,8 @@ int Tile::getLightMulti(LightLayers layer) const
 
 	for (int l = layer; l >= 0; --l)
 	{
-		if (_light[l] > light)
-			light = _light[l];
+		if (_storage->light[l][_index] > light)
+			light = _storage->light[l][_index];
 	}
 
 	return light;
@@ -493,8 +570,8 @@ int Tile::getShade() const
 
 	for (int layer = 0; layer < LL_MAX; layer++)
 	{
-		if (_light[layer] > light)
-			light = _light[layer];
+		if (_storage->light[layer][_index] > light)
+			light = _storage->light[layer][_index];
 	}
 
 	return std::max(0, 15 - light);
@@ -652,12 +729,13 @@ void Tile::ignite(int power)
 		}
 		if (RNG::percent(power) && getFuel())
 		{
-			if (_fire == 0)
+			if (_storage->fire[_index] == 0)
 			{
-				_smoke = 15 - std::max(1, std::min((getFlammability() / 10), 12));
+				_storage->smoke[_index] = 15 - std::max(1, std::min((getFlammability() / 10), 12));
 				_overlaps = 1;
-				_fire = getFuel() + 1;
+				_storage->fire[_index] = getFuel() + 1;
 				_animationOffset = RNG::generate(0,3);
+				markEnvi();
 			}
 		}
 	}
@@ -689,20 +767,20 @@ void Tile::animate()
 				newframe = 0;
 			}
 			_currentFrame[i] = newframe;
+			updateTUCost(i);
 		}
 	}
-	for (std::list<Particle*>::iterator i = _particles.begin(); i != _particles.end();)
+	// particles are stored by value, finished ones are dropped in place
+	// so the buffer keeps its capacity for next clouds on this tile
+	size_t alive = 0;
+	for (size_t i = 0; i < _particles.size(); ++i)
 	{
-		if (!(*i)->animate())
+		if (_particles[i].animate())
 		{
-			delete *i;
-			i = _particles.erase(i);
-		}
-		else
-		{
-			++i;
+			_particles[alive++] = _particles[i];
 		}
 	}
+	_particles.erase(_particles.begin() + alive, _particles.end());
 }
 
 /**
@@ -729,7 +807,7 @@ void Tile::setUnit(BattleUnit *unit, Tile *tileBelow)
 	{
 		unit->setTile(this, tileBelow);
 	}
-	_unit = unit;
+	_storage->unit[_index] = unit;
 }
 
 /**
@@ -738,8 +816,12 @@ void Tile::setUnit(BattleUnit *unit, Tile *tileBelow)
  */
 void Tile::setFire(int fire)
 {
-	_fire = fire;
+	_storage->fire[_index] = fire;
 	_animationOffset = RNG::generate(0,3);
+	if (_storage->fire[_index])
+	{
+		markEnvi();
+	}
 }
 
 /**
@@ -748,7 +830,7 @@ void Tile::setFire(int fire)
  */
 int Tile::getFire() const
 {
-	return _fire;
+	return _storage->fire[_index];
 }
 
 /**
@@ -757,18 +839,22 @@ int Tile::getFire() const
  */
 void Tile::addSmoke(int smoke)
 {
-	if (_fire == 0)
+	if (_storage->fire[_index] == 0)
 	{
 		if (_overlaps == 0)
 		{
-			_smoke = std::max(1, std::min(_smoke + smoke, 15));
+			_storage->smoke[_index] = std::max(1, std::min(_storage->smoke[_index] + smoke, 15));
 		}
 		else
 		{
-			_smoke += smoke;
+			_storage->smoke[_index] += smoke;
 		}
 		_animationOffset = RNG::generate(0,3);
 		addOverlap();
+		if (_storage->smoke[_index])
+		{
+			markEnvi();
+		}
 	}
 }
 
@@ -778,8 +864,12 @@ void Tile::addSmoke(int smoke)
  */
 void Tile::setSmoke(int smoke)
 {
-	_smoke = smoke;
+	_storage->smoke[_index] = smoke;
 	_animationOffset = RNG::generate(0,3);
+	if (_storage->smoke[_index])
+	{
+		markEnvi();
+	}
 }
 
 
@@ -789,7 +879,7 @@ void Tile::setSmoke(int smoke)
  */
 int Tile::getSmoke() const
 {
-	return _smoke;
+	return _storage->smoke[_index];
 }
 
 /**
@@ -802,6 +892,42 @@ int Tile::getAnimationOffset() const
 	return _animationOffset;
 }
 
+/**
+ * Sets the list that collects tiles with fire or smoke,
+ * so the battle doesn't need to search the whole map for them.
+ * @param tiles List of tiles, owned by the battle.
+ */
+void Tile::setEnviList(std::vector<Tile*> *tiles)
+{
+	_enviTiles = tiles;
+	_enviListed = false;
+	if (_storage->fire[_index] || _storage->smoke[_index])
+	{
+		markEnvi();
+	}
+}
+
+/**
+ * Adds this tile to the list of tiles with fire or smoke, if it isn't there already.
+ */
+void Tile::markEnvi()
+{
+	if (_enviTiles && !_enviListed)
+	{
+		_enviListed = true;
+		_enviTiles->push_back(this);
+	}
+}
+
+/**
+ * Marks the tile as removed from the list of tiles with fire or smoke.
+ * Called by owner of the list when the fire and smoke are gone.
+ */
+void Tile::clearEnviListed()
+{
+	_enviListed = false;
+}
+
 /**
  * Add an item on the tile.
  * @param item
@@ -812,6 +938,10 @@ void Tile::addItem(BattleItem *item, RuleInventory *ground)
 	item->setSlot(ground);
 	_inventory.push_back(item);
 	item->setTile(this);
+	if (item->getRules()->getBattleType() == BT_PROXIMITYGRENADE)
+	{
+		_proximityItems = true;
+	}
 }
 
 /**
@@ -887,17 +1017,19 @@ static inline void applyEnvi(BattleUnit* unit, int smoke, int fire)
 void Tile::prepareNewTurn()
 {
 	// we've received new smoke in this turn, but we're not on fire, average out the smoke.
-	if ( _overlaps != 0 && _smoke != 0 && _fire == 0)
+	int &smoke = _storage->smoke[_index];
+	const int fire = _storage->fire[_index];
+	if ( _overlaps != 0 && smoke != 0 && fire == 0)
 	{
-		_smoke = std::max(0, std::min((_smoke / _overlaps)- 1, 15));
+		smoke = std::max(0, std::min((smoke / _overlaps)- 1, 15));
 	}
 	// if we still have smoke/fire
-	if (_smoke)
+	if (smoke)
 	{
-		applyEnvi(_unit, _smoke, _fire);
+		applyEnvi(getUnit(), smoke, fire);
 		for (std::vector<BattleItem*>::iterator i = _inventory.begin(); i != _inventory.end(); ++i)
 		{
-			applyEnvi((*i)->getUnit(), _smoke, _fire);
+			applyEnvi((*i)->getUnit(), smoke, fire);
 		}
 	}
 	_overlaps = 0;
@@ -913,6 +1045,33 @@ std::vector<BattleItem *> *Tile::getInventory()
 	return &_inventory;
 }
 
+/**
+ * Can there be proximity grenades on this tile?
+ * @return False if there are definitely none.
+ */
+bool Tile::hasProximityItems() const
+{
+	return _proximityItems;
+}
+
+/**
+ * Rechecks if there are still any proximity grenades on this tile.
+ * Flag is set by addItem and only cleared here, so items removed
+ * directly from the inventory only cost one extra scan.
+ */
+void Tile::updateProximityItems()
+{
+	_proximityItems = false;
+	for (std::vector<BattleItem*>::iterator i = _inventory.begin(); i != _inventory.end(); ++i)
+	{
+		if ((*i)->getRules()->getBattleType() == BT_PROXIMITYGRENADE)
+		{
+			_proximityItems = true;
+			break;
+		}
+	}
+}
+
 
 /**
  * Set the marker color on this tile.
@@ -938,7 +1097,7 @@ int Tile::getMarkerColor() const
  */
 void Tile::setVisible(int visibility)
 {
-	_visible += visibility;
+	_storage->visible[_index] += visibility;
 }
 
 /**
@@ -947,7 +1106,7 @@ void Tile::setVisible(int visibility)
  */
 int Tile::getVisible() const
 {
-	return _visible;
+	return _storage->visible[_index];
 }
 
 /**
@@ -1024,7 +1183,7 @@ bool Tile::getDangerous() const
  * adds a particle to this tile's internal storage buffer.
  * @param particle the particle to add.
  */
-void Tile::addParticle(Particle *particle)
+void Tile::addParticle(const Particle &particle)
 {
 	_particles.push_back(particle);
 }
@@ -1033,7 +1192,7 @@ void Tile::addParticle(Particle *particle)
  * gets a pointer to this tile's particle array.
  * @return a pointer to the internal array of particles.
  */
-std::list<Particle *> *Tile::getParticleCloud()
+std::vector<Particle> *Tile::getParticleCloud()
 {
 	return &_particles;
 }
@@ -23,6 +23,7 @@
 #include "../Mod/MapData.h"
 #include "BattleUnit.h"
 #include "BattleItem.h"
+#include "../Battlescape/Particle.h"
 
 #include <SDL_types.h> // for Uint8
 
@@ -34,10 +35,35 @@ class MapData;
 class BattleUnit;
 class BattleItem;
 class RuleInventory;
-class Particle;
 
 enum LightLayers : Uint8 { LL_AMBIENT, LL_FIRE, LL_ITEMS, LL_UNITS, LL_MAX };
 
+/**
+ * Values of tiles that loops over the whole map (lighting, line of sight,
+ * smoke and fire, pathfinding) use most, kept in dense arrays indexed by
+ * tile index instead of being spread over the big Tile objects.
+ * Owned by the battle, every Tile reads and writes its own element.
+ */
+struct TileStorage
+{
+	std::vector<int> light[LL_MAX];
+	std::vector<int> smoke;
+	std::vector<int> fire;
+	std::vector<int> visible;
+	/// Bits 0-2 are discovered flags of west wall, north wall and content.
+	std::vector<Uint8> discovered;
+	std::vector<BattleUnit*> unit;
+	/// TU cost of walking, flying and sliding, four tile parts per tile.
+	std::vector<int> tuCost[MT_SLIDE + 1];
+
+	/// Sets number of tiles, all values are zero.
+	void resize(size_t size);
+	/// Resets light of all tiles, from given layer up.
+	void resetLight(LightLayers layer);
+	/// Sets discovered flags of all tiles.
+	void setDiscovered(Uint8 flags);
+};
+
 /**
  * Basic element of which a battle map is build.
  * @sa http://www.ufopaedia.org/index.php?title=MAPS
@@ -64,26 +90,30 @@ protected:
 	int _mapDataID[4];
 	int _mapDataSetID[4];
 	int _currentFrame[4];
-	bool _discovered[3];
-	int _light[LL_MAX];
-	int _smoke;
-	int _fire;
 	int _explosive;
 	int _explosiveType;
 	Position _pos;
-	BattleUnit *_unit;
 	std::vector<BattleItem *> _inventory;
 	int _animationOffset;
 	int _markerColor;
-	int _visible;
 	int _preview;
 	int _TUMarker;
 	int _overlaps;
 	bool _danger;
-	std::list<Particle*> _particles;
+	bool _enviListed;
+	bool _proximityItems;
+	std::vector<Tile*> *_enviTiles;
+	std::vector<Particle> _particles;
+	TileStorage *_storage;
+	int _index;
+
+	/// Adds this tile to the list of tiles with fire or smoke.
+	void markEnvi();
+	/// Updates the stored TU costs of a tile part.
+	void updateTUCost(int part);
 public:
 	/// Creates a tile.
-	Tile(const Position& pos);
+	Tile(const Position& pos, TileStorage *storage, int index);
 	/// Cleans up a tile.
 	~Tile();
 	/// Load the tile from yaml
@@ -185,7 +215,7 @@ public:
 	 */
 	BattleUnit *getUnit() const
 	{
-		return _unit;
+		return _storage->unit[_index];
 	}
 	/// Set fire, does not increment overlaps.
 	void setFire(int fire);
@@ -209,6 +239,10 @@ public:
 	void ignite(int power);
 	/// Get fire and smoke animation offset.
 	int getAnimationOffset() const;
+	/// Set the list that collects tiles with fire or smoke.
+	void setEnviList(std::vector<Tile*> *tiles);
+	/// Removes the tile from the list of tiles with fire or smoke.
+	void clearEnviListed();
 	/// Add item
 	void addItem(BattleItem *item, RuleInventory *ground);
 	/// Remove item
@@ -219,6 +253,10 @@ public:
 	void prepareNewTurn();
 	/// Get inventory on this tile.
 	std::vector<BattleItem *> *getInventory();
+	/// Can there be proximity grenades on this tile?
+	bool hasProximityItems() const;
+	/// Rechecks if there are still any proximity grenades on this tile.
+	void updateProximityItems();
 	/// Set the tile marker color.
 	void setMarkerColor(int color);
 	/// Get the tile marker color.
@@ -244,9 +282,9 @@ public:
 	/// check the danger flag on this tile.
 	bool getDangerous() const;
 	/// adds a particle to this tile's array.
-	void addParticle(Particle *particle);
+	void addParticle(const Particle &particle);
 	/// gets a pointer to this tile's particle array.
-	std::list<Particle *> *getParticleCloud();
+	std::vector<Particle> *getParticleCloud();
 
 };
 